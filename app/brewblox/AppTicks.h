@@ -22,8 +22,14 @@
 #include "blox/TicksBlock.h"
 
 #if defined(SPARK)
+#if PLATFORM_ID == 3
+// the gcc build can run on a virtual clock, see SimulationTicks
+#include "wiring/SimulationTicks.h"
+using TicksClass = Ticks<SimulationTicks>;
+#else
 #include "wiring/TicksWiring.h"
 using TicksClass = Ticks<TicksWiring>;
+#endif
 #else
 #include <MockTicks.h>
 using TicksClass = Ticks<MockTicks>;
@@ -20,8 +20,13 @@
 #include "./reset.h"
 #include "AppTicks.h"
 #include "Board.h"
+#include "ChangeNotifier.h"
+#include "FilterBank.h"
 #include "Logger.h"
+#include "OneWireScanner.h"
 #include "OneWireScanningFactory.h"
+#include "OneWireTransactions.h"
+#include "TempSensorOneWireBus.h"
 #include "blox/ActuatorAnalogMockBlock.h"
 #include "blox/ActuatorLogicBlock.h"
 #include "blox/ActuatorOffsetBlock.h"
@@ -136,7 +141,7 @@ makeBrewBloxBox()
         // groups will be at position 1
         cbox::ContainedObject(2, 0x80, std::make_shared<SysInfoBlock>()),
             cbox::ContainedObject(3, 0x80, std::make_shared<TicksBlock<TicksClass>>(ticks)),
-            cbox::ContainedObject(4, 0x80, std::make_shared<OneWireBusBlock>(theOneWire())),
+            cbox::ContainedObject(4, 0x80, std::make_shared<OneWireBusBlock>(theTempSensorOneWireBus(), theOneWireScanner())),
 #if defined(SPARK)
             cbox::ContainedObject(5, 0x80, std::make_shared<WiFiSettingsBlock>()),
             cbox::ContainedObject(6, 0x80, std::make_shared<TouchSettingsBlock>()),
@@ -170,9 +175,9 @@ makeBrewBloxBox()
 
     std::vector<std::unique_ptr<cbox::ScanningFactory>> scanningFactories;
 #if PLATFORM_ID == 3
-    scanningFactories.push_back(std::unique_ptr<cbox::ScanningFactory>(new MockOneWireScanningFactory(objects, theOneWire())));
+    scanningFactories.push_back(std::unique_ptr<cbox::ScanningFactory>(new MockOneWireScanningFactory(objects, theOneWireScanner())));
 #else
-    scanningFactories.push_back(std::unique_ptr<cbox::ScanningFactory>(new OneWireScanningFactory(objects, theOneWire())));
+    scanningFactories.push_back(std::unique_ptr<cbox::ScanningFactory>(new OneWireScanningFactory(objects, theOneWireScanner())));
 #endif
 
     static cbox::Box box(objectFactory, objects, objectStore, connections, std::move(scanningFactories));
@@ -195,10 +200,38 @@ theOneWire()
     return ow;
 }
 
+OneWireTransactions&
+theOneWireTransactions()
+{
+    static OneWireTransactions transactions(theOneWire(), []() { return ticks.micros(); });
+    return transactions;
+}
+
+TempSensorOneWireBus&
+theTempSensorOneWireBus()
+{
+    static TempSensorOneWireBus conversionBus(theOneWireTransactions());
+    return conversionBus;
+}
+
+OneWireScanner&
+theOneWireScanner()
+{
+    static OneWireScanner scanner(theOneWire());
+    return scanner;
+}
+
+ChangeNotifier&
+blocksUpdated()
+{
+    static ChangeNotifier notifier;
+    return notifier;
+}
+
 Logger&
 logger()
 {
-    static auto logger = Logger([](Logger::LogLevel level, const std::string& log) {
+    static auto logger = Logger([](Logger::LogLevel level, const char* log) {
         cbox::DataOut& out = theConnectionPool().logDataOut();
         out.write('<');
         const char debug[] = "DEBUG";
@@ -221,11 +254,10 @@ logger()
             break;
         }
         out.write(':');
-        for (const auto& c : log) {
-            out.write(c);
-        }
+        out.writeBuffer(log, strlen(log));
         out.write('>');
-    });
+    },
+                                []() { return ticks.millis(); });
     return logger;
 }
 
@@ -241,11 +273,31 @@ logEvent(const std::string& event)
     out.write('>');
 }
 
+// time per pass of the main loop for queued OneWire transactions
+constexpr duration_micros_t oneWireBudget = 2000;
+
 void
 updateBrewbloxBox()
 {
     brewbloxBox().update(ticks.millis());
+    // the sensor pairs have added their new values during the update, filter them all in one step
+    FilterBank::defaultBank()->step();
+    // the DS2408 blocks write the channels changed by their actuators with one latch write each
+    blocksUpdated().notify();
+    theOneWireTransactions().process(oneWireBudget);
+}
+
+void
+idleBrewbloxBox()
+{
 #if PLATFORM_ID == 3
+#if defined(SPARK)
+    if (ticks.ticksImpl().simulated()) {
+        // skip the time in which no block needs to be updated
+        ticks.ticksImpl().idleUntil(brewbloxBox().nextUpdateTime(ticks.millis()));
+        return;
+    }
+#endif
     ticks.delayMillis(10); // prevent 100% cpu usage
 #endif
 }
@@ -25,7 +25,11 @@
 namespace cbox {
 class StringStreamConnectionSource;
 }
+class ChangeNotifier;
 class OneWire;
+class OneWireScanner;
+class OneWireTransactions;
+class TempSensorOneWireBus;
 
 #if !defined(SPARK)
 cbox::StringStreamConnectionSource&
@@ -40,9 +44,29 @@ brewbloxBox();
 OneWire&
 theOneWire();
 
+// create a static queue for OneWire transactions on theOneWire(), processed after updating the blocks
+OneWireTransactions&
+theOneWireTransactions();
+
+// create a static object that coordinates the conversions of all temperature sensors on theOneWire()
+TempSensorOneWireBus&
+theTempSensorOneWireBus();
+
+// create a static background scanner for theOneWire(), stepped by the OneWireBus block and read by object discovery
+OneWireScanner&
+theOneWireScanner();
+
+// notified by updateBrewbloxBox() after all blocks are updated, for work that is batched over the whole pass
+ChangeNotifier&
+blocksUpdated();
+
 void
 updateBrewbloxBox();
 
+// wait between two passes of the main loop on gcc, called without holding the TimerInterrupts::Guard
+void
+idleBrewbloxBox();
+
 const char*
 versionCsv();
 
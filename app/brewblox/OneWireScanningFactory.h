@@ -22,6 +22,7 @@
 #include "OneWire.h"
 #include "OneWireAddress.h"
 #include "OneWireDevice.h"
+#include "OneWireScanner.h"
 #include "blox/DS2408Block.h"
 #include "blox/DS2413Block.h"
 #include "blox/TempSensorOneWireBlock.h"
@@ -38,27 +39,33 @@
 class OneWireScanningFactory : public cbox::ScanningFactory {
 private:
     OneWire& bus;
+    OneWireScanner& scanner;
+    size_t nextIndex = 0;
 
 public:
-    OneWireScanningFactory(cbox::ObjectContainer& objects, OneWire& ow)
+    OneWireScanningFactory(cbox::ObjectContainer& objects, OneWireScanner& scanner_)
         : cbox::ScanningFactory(objects)
-        , bus(ow)
+        , bus(scanner_.bus())
+        , scanner(scanner_)
     {
         reset();
     }
 
     virtual ~OneWireScanningFactory() = default;
 
+    // discovery reads the devices found by the background scan and requests a new scan,
+    // devices that are connected later are found on the next discovery
     virtual void reset() override
     {
-        bus.reset_search();
+        nextIndex = 0;
+        scanner.request();
     }
 
     virtual OneWireAddress next()
     {
-        auto newAddr = OneWireAddress();
-        if (bus.search(newAddr.asUint8ptr())) {
-            return newAddr;
+        auto& devices = scanner.devices();
+        if (nextIndex < devices.size()) {
+            return devices[nextIndex++];
         }
         return 0;
     }
@@ -67,19 +74,8 @@ public:
     {
         while (true) {
             if (auto newAddr = next()) {
-                bool found = false;
-                for (auto existing = objectsRef.cbegin(); existing != objectsRef.cend(); ++existing) {
-                    OneWireDevice* ptrIfCorrectType = reinterpret_cast<OneWireDevice*>(existing->object()->implements(cbox::interfaceId<OneWireDevice>()));
-                    if (ptrIfCorrectType == nullptr) {
-                        continue; // not the right type, no match
-                    }
-                    if (ptrIfCorrectType->getDeviceAddress() == newAddr) {
-                        found = true; // object with value already exists
-                        break;
-                    }
-                }
-                if (!found) {
-                    // create new object
+                if (!bus.hasDevice(newAddr)) {
+                    // create new object, which registers its address on the bus
                     uint8_t familyCode = newAddr.asUint8ptr()[0];
                     switch (familyCode) {
                     case DS18B20MODEL: {
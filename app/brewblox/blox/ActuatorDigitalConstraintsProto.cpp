@@ -46,6 +46,11 @@ public:
         return m_mutexConstraint.order();
     }
 
+    virtual bool predictable() const override final
+    {
+        return m_mutexConstraint.predictable();
+    }
+
     auto holdAfterTurnOff()
     {
         return m_mutexConstraint.holdAfterTurnOff();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ActuatorDigitalConstrained.h"
+#include "ActuatorLogicProgram.h"
 #include "BrewBlox.h"
 #include "ProcessValue.h"
 #include "blox/Block.h"
@@ -12,7 +13,6 @@ public:
     DigitalCompare(const blox_ActuatorLogic_DigitalCompare& data, cbox::ObjectContainer& objects)
         : m_lookup(objects, cbox::obj_id_t(data.id))
         , m_op(data.op)
-        , m_result(blox_ActuatorLogic_Result_FALSE)
         , m_rhs(ActuatorDigitalBase::State(data.rhs))
     {
     }
@@ -43,24 +43,24 @@ public:
         dest.op = m_op;
         dest.rhs = blox_DigitalState(m_rhs);
         if (includeNotPersisted) {
-            dest.result = m_result;
+            // compares are only evaluated by the expression when needed, evaluate all of them for the user
+            dest.result = eval();
         }
     }
 
-    void update()
+    // subscribe to changes of the block, returns false if the block does not exist
+    bool subscribe(const std::shared_ptr<ChangeNotifier::Listener>& listener)
     {
-        m_result = eval();
-    }
-
-    auto result() const
-    {
-        return m_result;
+        if (auto actPtr = m_lookup.lock()) {
+            actPtr->changes().subscribe(listener);
+            return true;
+        }
+        return false;
     }
 
 private:
     cbox::CboxPtr<ActuatorDigitalConstrained> m_lookup;
     blox_ActuatorLogic_DigitalCompareOp m_op;
-    blox_ActuatorLogic_Result m_result;
     ActuatorDigitalBase::State m_rhs;
 };
 
@@ -69,7 +69,6 @@ public:
     AnalogCompare(const blox_ActuatorLogic_AnalogCompare& data, cbox::ObjectContainer& objects)
         : m_lookup(objects, cbox::obj_id_t(data.id))
         , m_op(data.op)
-        , m_result(blox_ActuatorLogic_Result_FALSE)
         , m_rhs(cnl::wrap<fp12_t>(data.rhs))
     {
     }
@@ -112,24 +111,24 @@ public:
         dest.op = m_op;
         dest.rhs = cnl::unwrap(m_rhs);
         if (includeNotPersisted) {
-            dest.result = m_result;
+            // compares are only evaluated by the expression when needed, evaluate all of them for the user
+            dest.result = eval();
         }
     }
 
-    void update()
-    {
-        m_result = eval();
-    }
-
-    auto result() const
+    // subscribe to changes of the block, returns false if the block does not exist
+    bool subscribe(const std::shared_ptr<ChangeNotifier::Listener>& listener)
     {
-        return m_result;
+        if (auto pvPtr = m_lookup.lock()) {
+            pvPtr->changes().subscribe(listener);
+            return true;
+        }
+        return false;
     }
 
 private:
     cbox::CboxPtr<ProcessValue<fp12_t>> m_lookup;
     blox_ActuatorLogic_AnalogCompareOp m_op;
-    blox_ActuatorLogic_Result m_result;
     fp12_t m_rhs;
 };
 
@@ -141,13 +140,60 @@ private:
     std::vector<DigitalCompare> digitals;
     std::vector<AnalogCompare> analogs;
     std::string expression;
+    ActuatorLogicProgram program; // expression compiled when it is written
     blox_ActuatorLogic_Result m_result = blox_ActuatorLogic_Result_FALSE;
     uint8_t m_errorPos = 0;
 
+    // The inputs wake up the block when they change, so it is evaluated on the next pass and sleeps otherwise.
+    // The block is still evaluated at the fallback interval, to subscribe to inputs that were created later
+    // and to pick up changes that are not notified.
+    std::shared_ptr<ChangeNotifier::Listener> inputListener;
+    bool subscribed = false;
+    cbox::update_t nextFallbackUpdate = 0;
+    static const cbox::update_t fallbackInterval = 1000;
+
+    // The program skips the compares that cannot change the result, so a deleted input would be ignored.
+    // The inputs are looked up here to subscribe, which also finds the first compare in the program with a missing block.
+    bool inputMissing = false;
+    uint8_t missingPos = 0;
+
+    void subscribeInputs()
+    {
+        std::vector<bool> digitalFound;
+        std::vector<bool> analogFound;
+        digitalFound.reserve(digitals.size());
+        analogFound.reserve(analogs.size());
+        for (auto& d : digitals) {
+            digitalFound.push_back(d.subscribe(inputListener));
+        }
+        for (auto& a : analogs) {
+            analogFound.push_back(a.subscribe(inputListener));
+        }
+        subscribed = true;
+
+        inputMissing = false;
+        if (program.valid()) {
+            for (auto& instr : program.instructions()) {
+                bool found = true;
+                if (instr.op == ActuatorLogicProgram::OpCode::Digital) {
+                    found = digitalFound[instr.arg];
+                } else if (instr.op == ActuatorLogicProgram::OpCode::Analog) {
+                    found = analogFound[instr.arg];
+                }
+                if (!found) {
+                    inputMissing = true;
+                    missingPos = instr.pos;
+                    break;
+                }
+            }
+        }
+    }
+
 public:
     ActuatorLogicBlock(cbox::ObjectContainer& objects)
         : objectsRef(objects)
         , target(objects)
+        , inputListener(std::make_shared<ChangeNotifier::Listener>([this]() { objectsRef.wake(this); }))
     {
     }
     virtual ~ActuatorLogicBlock() = default;
@@ -170,6 +216,8 @@ public:
             }
 
             expression = std::string(newData.expression);
+            program.compile(expression, digitals.size(), analogs.size());
+            subscribed = false;
         }
         return result;
     }
@@ -220,6 +268,10 @@ public:
     virtual cbox::update_t
     update(const cbox::update_t& now) override final
     {
+        if (!subscribed || int32_t(now - nextFallbackUpdate) >= 0) {
+            subscribeInputs();
+            nextFallbackUpdate = now + fallbackInterval;
+        }
         m_result = evaluate();
         if (enabled) {
             if (auto targetPtr = target.lock()) {
@@ -230,7 +282,7 @@ public:
                 }
             }
         }
-        return now + 100; // update every 100ms
+        return nextFallbackUpdate;
     }
 
     virtual void*
@@ -244,103 +296,13 @@ public:
 
     blox_ActuatorLogic_Result evaluate()
     {
-        for (auto& d : digitals) {
-            d.update();
-        }
-
-        for (auto& a : analogs) {
-            a.update();
-        }
-        m_errorPos = 0;
-        if (expression.empty()) {
-            return blox_ActuatorLogic_Result_EMPTY;
-        }
-        auto it = expression.cbegin();
-        auto result = eval(it, 0);
-
-        if (result > blox_ActuatorLogic_Result_TRUE) {
-            m_errorPos = it - expression.cbegin() - 1;
-        }
-        return result;
-    }
-
-private:
-    blox_ActuatorLogic_Result eval(std::string::const_iterator& it, uint8_t level) const
-    {
-        blox_ActuatorLogic_Result res = blox_ActuatorLogic_Result_EMPTY_SUBSTRING;
-        while (it < expression.cend()) {
-            if (res > blox_ActuatorLogic_Result_EMPTY_SUBSTRING) {
-                return res;
-            }
-            auto c = *it;
-            ++it;
-            if ('a' <= c && c <= 'z') {
-                auto compare = digitals.cbegin() + (c - 'a');
-                if (compare >= digitals.cend()) {
-                    return blox_ActuatorLogic_Result_INVALID_DIG_COMPARE_IDX;
-                }
-                res = compare->result();
-            } else if ('A' <= c && c <= 'Z') {
-                auto compare = analogs.cbegin() + (c - 'A');
-                if (compare >= analogs.cend()) {
-                    return blox_ActuatorLogic_Result_INVALID_ANA_COMPARE_IDX;
-                }
-                res = compare->result();
-            } else if (c == '!') {
-                auto rhs = eval(it, level);
-                if (rhs > blox_ActuatorLogic_Result_TRUE) {
-                    return rhs; // error
-                }
-                if (rhs == blox_ActuatorLogic_Result_TRUE) {
-                    return blox_ActuatorLogic_Result_FALSE;
-                }
-                return blox_ActuatorLogic_Result_TRUE;
-            } else if (c == '|') {
-                auto rhs = eval(it, level);
-                if (rhs > blox_ActuatorLogic_Result_TRUE) {
-                    return rhs; // error
-                }
-                if (res == blox_ActuatorLogic_Result_TRUE) {
-                    return res;
-                }
-                return rhs;
-            } else if (c == '&') {
-                auto rhs = eval(it, level);
-                if (rhs > blox_ActuatorLogic_Result_TRUE) {
-                    return rhs; // error
-                }
-                if (res == blox_ActuatorLogic_Result_TRUE) {
-                    return rhs;
-                }
-                return res;
-            } else if (c == '^') {
-                auto rhs = eval(it, level);
-                if (rhs != blox_ActuatorLogic_Result_TRUE && rhs != blox_ActuatorLogic_Result_FALSE) {
-                    return rhs; // error
-                }
-                if (rhs != res) {
-                    return blox_ActuatorLogic_Result_TRUE;
-                }
-                return blox_ActuatorLogic_Result_FALSE;
-            } else if (c == '(') {
-                if (res == blox_ActuatorLogic_Result_EMPTY_SUBSTRING) {
-                    res = eval(it, level + 1);
-                } else {
-                    return blox_ActuatorLogic_Result_UNEXPECTED_OPENING_BRACKET;
-                }
-            } else if (c == ')') {
-                if (level == 0) {
-                    // first check is to not overwrite earlier error
-                    return blox_ActuatorLogic_Result_UNEXPECTED_CLOSING_BRACKET;
-                }
-                return res;
-            } else {
-                return blox_ActuatorLogic_Result_UNEXPECTED_CHARACTER;
-            }
-        }
-        if (level > 0) {
-            return blox_ActuatorLogic_Result_MISSING_CLOSING_BRACKET;
+        if (inputMissing) {
+            m_errorPos = missingPos;
+            return blox_ActuatorLogic_Result_BLOCK_NOT_FOUND;
         }
-        return res;
+        return program.eval(
+            [this](uint8_t i) { return digitals[i].eval(); },
+            [this](uint8_t i) { return analogs[i].eval(); },
+            m_errorPos);
     }
 };
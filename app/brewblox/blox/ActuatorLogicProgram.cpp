@@ -0,0 +1,193 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ActuatorLogicProgram.h"
+
+constexpr uint8_t ActuatorLogicProgram::maxLength;
+
+namespace {
+
+using Instruction = ActuatorLogicProgram::Instruction;
+using OpCode = ActuatorLogicProgram::OpCode;
+
+// recursive descent parser that emits the program while it parses the expression
+class Compiler {
+public:
+    Compiler(const std::string& expression, uint8_t numDigital, uint8_t numAnalog, std::vector<Instruction>& program)
+        : m_expression(expression)
+        , m_numDigital(numDigital)
+        , m_numAnalog(numAnalog)
+        , m_program(program)
+    {
+    }
+
+    // parse until the closing bracket of the group, or the end for level 0.
+    // hasValue is false for an empty group
+    bool parse(uint8_t level, bool& hasValue)
+    {
+        hasValue = false;
+        auto valueStart = m_program.size();
+        while (m_pos < m_expression.size()) {
+            auto c = m_expression[m_pos];
+            if ('a' <= c && c <= 'z') {
+                if (c - 'a' >= m_numDigital) {
+                    return fail(blox_ActuatorLogic_Result_INVALID_DIG_COMPARE_IDX, m_pos);
+                }
+                m_program.resize(valueStart); // a compare replaces the previous value
+                m_program.push_back({OpCode::Digital, uint8_t(c - 'a'), m_pos});
+                hasValue = true;
+                ++m_pos;
+            } else if ('A' <= c && c <= 'Z') {
+                if (c - 'A' >= m_numAnalog) {
+                    return fail(blox_ActuatorLogic_Result_INVALID_ANA_COMPARE_IDX, m_pos);
+                }
+                m_program.resize(valueStart);
+                m_program.push_back({OpCode::Analog, uint8_t(c - 'A'), m_pos});
+                hasValue = true;
+                ++m_pos;
+            } else if (c == '!') {
+                m_program.resize(valueStart);
+                auto opPos = m_pos++;
+                if (!parseRhs(level)) {
+                    return false;
+                }
+                m_program.push_back({OpCode::Not, 0, opPos});
+                hasValue = true;
+                return true;
+            } else if (c == '|' || c == '&' || c == '^') {
+                if (!hasValue) {
+                    return fail(blox_ActuatorLogic_Result_EMPTY_SUBSTRING, m_pos);
+                }
+                auto opPos = m_pos++;
+                auto jump = m_program.size();
+                if (c == '|') {
+                    m_program.push_back({OpCode::JumpIfTrue, 0, opPos});
+                } else if (c == '&') {
+                    m_program.push_back({OpCode::JumpIfFalse, 0, opPos});
+                }
+                if (!parseRhs(level)) {
+                    return false;
+                }
+                if (c == '^') {
+                    m_program.push_back({OpCode::Xor, 0, opPos});
+                } else {
+                    m_program[jump].arg = m_program.size(); // skip the right hand side
+                }
+                return true;
+            } else if (c == '(') {
+                if (hasValue) {
+                    return fail(blox_ActuatorLogic_Result_UNEXPECTED_OPENING_BRACKET, m_pos);
+                }
+                ++m_pos;
+                if (!parse(level + 1, hasValue)) {
+                    return false;
+                }
+            } else if (c == ')') {
+                if (level == 0) {
+                    return fail(blox_ActuatorLogic_Result_UNEXPECTED_CLOSING_BRACKET, m_pos);
+                }
+                ++m_pos;
+                return true;
+            } else {
+                return fail(blox_ActuatorLogic_Result_UNEXPECTED_CHARACTER, m_pos);
+            }
+        }
+        if (level > 0) {
+            return fail(blox_ActuatorLogic_Result_MISSING_CLOSING_BRACKET, m_pos - 1);
+        }
+        return true;
+    }
+
+    blox_ActuatorLogic_Result error() const
+    {
+        return m_error;
+    }
+
+    uint8_t errorPos() const
+    {
+        return m_errorPos;
+    }
+
+    uint8_t pos() const
+    {
+        return m_pos;
+    }
+
+private:
+    // the right hand side of an operator is the rest of the group and cannot be empty
+    bool parseRhs(uint8_t level)
+    {
+        bool hasValue;
+        if (!parse(level, hasValue)) {
+            return false;
+        }
+        if (!hasValue) {
+            return fail(blox_ActuatorLogic_Result_EMPTY_SUBSTRING, m_pos - 1);
+        }
+        return true;
+    }
+
+    bool fail(blox_ActuatorLogic_Result error, uint8_t pos)
+    {
+        m_error = error;
+        m_errorPos = pos;
+        return false;
+    }
+
+    const std::string& m_expression;
+    uint8_t m_numDigital;
+    uint8_t m_numAnalog;
+    std::vector<Instruction>& m_program;
+    uint8_t m_pos = 0;
+    blox_ActuatorLogic_Result m_error = blox_ActuatorLogic_Result_TRUE;
+    uint8_t m_errorPos = 0;
+};
+
+} // end anonymous namespace
+
+void
+ActuatorLogicProgram::compile(const std::string& expression, uint8_t numDigital, uint8_t numAnalog)
+{
+    m_program.clear();
+    m_errorPos = 0;
+    if (expression.empty()) {
+        m_error = blox_ActuatorLogic_Result_EMPTY;
+        return;
+    }
+    if (expression.size() > maxLength) {
+        m_error = blox_ActuatorLogic_Result_UNEXPECTED_CHARACTER;
+        m_errorPos = maxLength;
+        return;
+    }
+
+    Compiler compiler(expression, numDigital, numAnalog, m_program);
+    bool hasValue;
+    if (!compiler.parse(0, hasValue)) {
+        m_error = compiler.error();
+        m_errorPos = compiler.errorPos();
+        m_program.clear();
+        return;
+    }
+    if (!hasValue) {
+        m_error = blox_ActuatorLogic_Result_EMPTY_SUBSTRING;
+        m_errorPos = compiler.pos() - 1;
+        return;
+    }
+    m_error = blox_ActuatorLogic_Result_TRUE;
+}
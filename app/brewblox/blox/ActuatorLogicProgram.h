@@ -0,0 +1,144 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "proto/cpp/ActuatorLogic.pb.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * The expression of an ActuatorLogicBlock, compiled to a postfix program when it is written.
+ *
+ * Lower case letters refer to the digital compares, upper case letters to the analog compares.
+ * An operator takes everything up to the closing bracket of its group as right hand side,
+ * so a|b&c is evaluated as a|(b&c). A ! inverts everything up to the closing bracket.
+ *
+ * Syntax errors and invalid compare indices are found by compile(), with the position of the offending character.
+ * The or and and operators jump over their right hand side when the left hand side decides the result,
+ * so only the compares that are needed for the result are evaluated.
+ */
+class ActuatorLogicProgram {
+public:
+    static constexpr uint8_t maxLength = 64; // length of the expression field in the proto message
+
+    enum class OpCode : uint8_t {
+        Digital,     // push the result of digital compare arg
+        Analog,      // push the result of analog compare arg
+        Not,         // invert the top of the stack
+        Xor,         // pop 2 values, push the exclusive or
+        JumpIfTrue,  // keep the top and jump to arg if it is true, otherwise pop it
+        JumpIfFalse, // keep the top and jump to arg if it is false, otherwise pop it
+    };
+
+    struct Instruction {
+        OpCode op;
+        uint8_t arg;
+        uint8_t pos; // position in the expression, to report errors of the compare
+    };
+
+    ActuatorLogicProgram()
+    {
+        compile(std::string(), 0, 0);
+    }
+
+    // compile the expression for the given number of compares, errors are reported by error() and errorPos()
+    void compile(const std::string& expression, uint8_t numDigital, uint8_t numAnalog);
+
+    bool valid() const
+    {
+        return m_error == blox_ActuatorLogic_Result_TRUE;
+    }
+
+    // EMPTY for an empty expression, the compile error otherwise. TRUE for a valid program
+    blox_ActuatorLogic_Result error() const
+    {
+        return m_error;
+    }
+
+    uint8_t errorPos() const
+    {
+        return m_errorPos;
+    }
+
+    const std::vector<Instruction>& instructions() const
+    {
+        return m_program;
+    }
+
+    /*
+     * Run the program. digital and analog are called with the index of a compare and return its result.
+     * The first compare that returns an error stops the program, errorPos is set to its position.
+     */
+    template <class DigitalCompare, class AnalogCompare>
+    blox_ActuatorLogic_Result eval(DigitalCompare&& digital, AnalogCompare&& analog, uint8_t& errorPos) const
+    {
+        errorPos = m_errorPos;
+        if (!valid()) {
+            return m_error;
+        }
+
+        bool stack[maxLength];
+        uint8_t depth = 0;
+        uint8_t pc = 0;
+        const uint8_t end = m_program.size();
+        while (pc < end) {
+            const Instruction& instr = m_program[pc++];
+            switch (instr.op) {
+            case OpCode::Digital:
+            case OpCode::Analog: {
+                auto res = instr.op == OpCode::Digital ? digital(instr.arg) : analog(instr.arg);
+                if (res > blox_ActuatorLogic_Result_TRUE) {
+                    errorPos = instr.pos;
+                    return res;
+                }
+                stack[depth++] = res == blox_ActuatorLogic_Result_TRUE;
+            } break;
+            case OpCode::Not:
+                stack[depth - 1] = !stack[depth - 1];
+                break;
+            case OpCode::Xor:
+                --depth;
+                stack[depth - 1] = stack[depth - 1] != stack[depth];
+                break;
+            case OpCode::JumpIfTrue:
+                if (stack[depth - 1]) {
+                    pc = instr.arg;
+                } else {
+                    --depth;
+                }
+                break;
+            case OpCode::JumpIfFalse:
+                if (!stack[depth - 1]) {
+                    pc = instr.arg;
+                } else {
+                    --depth;
+                }
+                break;
+            }
+        }
+        return stack[0] ? blox_ActuatorLogic_Result_TRUE : blox_ActuatorLogic_Result_FALSE;
+    }
+
+private:
+    std::vector<Instruction> m_program;
+    blox_ActuatorLogic_Result m_error = blox_ActuatorLogic_Result_EMPTY;
+    uint8_t m_errorPos = 0;
+};
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include "AppTicks.h"
+#include "ChangeNotifier.h"
 #include "DS2408.h"
 #include "IoArrayHelpers.h"
 #include "blox/Block.h"
@@ -27,14 +29,23 @@
 OneWire&
 theOneWire();
 
+ChangeNotifier&
+blocksUpdated();
+
 class DS2408Block : public Block<BrewBloxTypes_BlockType_DS2408> {
 private:
     DS2408 device;
+    std::shared_ptr<ChangeNotifier::Listener> flushListener;
 
 public:
     DS2408Block()
         : device(theOneWire())
+        , flushListener(std::make_shared<ChangeNotifier::Listener>([this]() { device.flushWrites(); }))
     {
+        // The actuators and valves on this device stage their channel writes during the pass.
+        // They are written together after all blocks are updated.
+        device.deferWrites(true);
+        blocksUpdated().subscribe(flushListener);
     }
 
     virtual cbox::CboxError streamFrom(cbox::DataIn& in) override final
@@ -86,8 +97,12 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
-        device.update();
-        return update_1s(now);
+        if (device.polling().due(now)) {
+            auto start = ticks.micros();
+            device.update();
+            device.polling().polled(now, device.connected(), ticks.micros() - start);
+        }
+        return device.polling().nextCheck(now);
     }
 
     virtual void* implements(const cbox::obj_type_t& iface) override final
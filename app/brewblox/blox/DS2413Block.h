@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "AppTicks.h"
 #include "DS2413.h"
 #include "IoArrayHelpers.h"
 #include "blox/Block.h"
@@ -74,8 +75,12 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
-        device.update();
-        return update_1s(now);
+        if (device.polling().due(now)) {
+            auto start = ticks.micros();
+            bool success = device.update();
+            device.polling().polled(now, success, ticks.micros() - start);
+        }
+        return device.polling().nextCheck(now);
     }
 
     virtual void* implements(const cbox::obj_type_t& iface) override final
@@ -82,7 +82,7 @@ public:
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
         actuator.update();
-        return constrained.update(now);
+        return now + constrained.update(now);
     }
 
     virtual void* implements(const cbox::obj_type_t& iface) override final
@@ -2,6 +2,8 @@
 
 #include "OneWire.h"
 #include "OneWireAddress.h"
+#include "OneWireScanner.h"
+#include "TempSensorOneWireBus.h"
 #include <limits.h>
 
 #include "blox/Block.h"
@@ -12,6 +14,8 @@
 class OneWireBusBlock : public Block<BrewBloxTypes_BlockType_OneWireBus> {
 private:
     OneWire& bus;
+    OneWireScanner& scanner; // scans the bus in the background, a few search steps per update
+    TempSensorOneWireBus* conversionBus = nullptr;
 
     mutable _blox_OneWireBus_Command command; // declared mutable so const streamTo functions can reset it
 
@@ -20,15 +24,18 @@ private:
     static const uint8_t SEARCH = 2; // pass family as data, 00 for all
 
 protected:
-    // stream result of a bus search, with arg pointing to the onewire bus
+    // stream the devices found by the background scan, with arg pointing to the bus block
     static bool streamAdresses(pb_ostream_t* stream, const pb_field_t* field, void* const* arg)
     {
-        OneWireAddress address;
-        OneWire* busPtr = reinterpret_cast<OneWire*>(*arg);
-        if (busPtr == nullptr) {
+        auto blockPtr = reinterpret_cast<const OneWireBusBlock*>(*arg);
+        if (blockPtr == nullptr) {
             return false;
         }
-        while (busPtr->search(address.asUint8ptr())) {
+        uint8_t family = blockPtr->command.data;
+        for (auto& address : blockPtr->scanner.devices()) {
+            if (family && address.asUint8ptr()[0] != family) {
+                continue;
+            }
             if (!pb_encode_tag_for_field(stream, field)) {
                 return false;
             }
@@ -41,13 +48,21 @@ protected:
     }
 
 public:
-    OneWireBusBlock(OneWire& ow)
-        : bus(ow)
+    OneWireBusBlock(OneWireScanner& scanner_)
+        : bus(scanner_.bus())
+        , scanner(scanner_)
         , command({NO_OP, 0})
     {
         bus.init();
     }
 
+    // the bus block also drives the shared temperature conversions of all sensors on the bus
+    OneWireBusBlock(TempSensorOneWireBus& conversions, OneWireScanner& scanner_)
+        : OneWireBusBlock(scanner_)
+    {
+        conversionBus = &conversions;
+    }
+
     OneWire& oneWire() { return bus; }
 
     /**
@@ -59,13 +74,15 @@ public:
      * - cmd 00: no-op always 00 (success)
      * - cmd 01: reset bus (00 on success, FF on failure)
      * - cmd 02: search bus: a sequence of 0 or more 8-byte addresses, MSB first that were found on the bus
+     *   The addresses are the devices found by the background scan, which is repeated every 10 seconds.
+     *   The command also starts a new scan, the devices it finds are listed when they are found.
      */
     virtual cbox::CboxError streamTo(cbox::DataOut& out) const override final
     {
         blox_OneWireBus message = blox_OneWireBus_init_zero;
         message.command = command;
         message.address.funcs.encode = nullptr;
-        message.address.arg = &bus;
+        message.address.arg = const_cast<OneWireBusBlock*>(this);
         switch (command.opcode) {
         case NO_OP:
             break;
@@ -73,17 +90,15 @@ public:
             bus.reset();
             break;
         case SEARCH:
-            bus.reset_search();
-            if (command.data) {
-                bus.target_search(command.data);
-            }
+            scanner.request();
             message.address.funcs.encode = &streamAdresses;
             break;
         }
+        auto res = streamProtoTo(out, &message, blox_OneWireBus_fields, std::numeric_limits<size_t>::max());
         // commands are one-shot - once the command is done clear it.
         command.opcode = NO_OP;
         command.data = 0;
-        return streamProtoTo(out, &message, blox_OneWireBus_fields, std::numeric_limits<size_t>::max());
+        return res;
     }
 
     /**
@@ -115,7 +130,13 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
-        // No updates for now. Alternatively, a periodic bus scan for new devices?
-        return update_never(now);
+        auto next = scanner.update(now);
+        if (conversionBus) {
+            auto nextConversion = conversionBus->update(now);
+            if (int32_t(nextConversion - next) < 0) {
+                next = nextConversion;
+            }
+        }
+        return next;
     }
 };
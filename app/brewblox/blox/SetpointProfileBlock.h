@@ -95,7 +95,14 @@ public:
 
     virtual cbox::CboxError streamPersistedTo(cbox::DataOut& out) const override final
     {
-        return streamTo(out);
+        blox_SetpointProfile message = blox_SetpointProfile_init_zero;
+        message.points.funcs.encode = &streamPointsOut;
+        message.points.arg = const_cast<std::vector<Point>*>(&profile.points());
+        message.enabled = profile.enabled();
+        message.start = profile.startTime();
+        message.targetId = target.getId();
+
+        return streamProtoTo(out, &message, blox_SetpointProfile_fields, std::numeric_limits<size_t>::max() - 1);
     }
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
@@ -1,13 +1,14 @@
 #pragma once
 
 #include "TempSensorOneWire.h"
+#include "TempSensorOneWireBus.h"
 #include "Temperature.h"
 #include "blox/Block.h"
 #include "blox/FieldTags.h"
 #include "proto/cpp/TempSensorOneWire.pb.h"
 
-OneWire&
-theOneWire();
+TempSensorOneWireBus&
+theTempSensorOneWireBus();
 
 class TempSensorOneWireBlock : public Block<BrewBloxTypes_BlockType_TempSensorOneWire> {
 private:
@@ -15,7 +16,7 @@ private:
 
 public:
     TempSensorOneWireBlock()
-        : sensor(theOneWire())
+        : sensor(theTempSensorOneWireBus())
     {
     }
 
@@ -59,6 +60,7 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
+        // the conversions and scratchpad reads are done by the OneWireBusBlock for all sensors at once
         sensor.update();
         return update_1s(now);
     }
@@ -8,6 +8,9 @@ CSRC += $(call target_files,lib/src,*.c)
 CPPSRC += $(call target_files,lib/src,*.cpp)
 ifeq ($(PLATFORM_ID),3)
 CPPEXCLUDES += lib/src/spark/TimerInterrupts.cpp
+else
+CPPEXCLUDES += lib/src/gcc/TimerInterrupts.cpp
+CPPEXCLUDES += lib/src/gcc/OneWireSimulator.cpp
 endif
 
 ifeq ($(PLATFORM_ID),3)
@@ -21,6 +21,8 @@
 #include "Board.h"
 #include "BrewBlox.h"
 #include "Buzzer.h"
+#include "FilterBank.h"
+#include "Logger.h"
 #include "TimerInterrupts.h"
 #include "blox/stringify.h"
 #include "cbox/Box.h"
@@ -43,6 +45,7 @@ STARTUP(System.enableFeature(FEATURE_RETAINED_MEMORY));
 
 #if PLATFORM_ID == PLATFORM_GCC
 #include <csignal>
+#include <cstdlib>
 void
 signal_handler(int signal)
 {
@@ -108,6 +111,9 @@ setup()
     std::signal(SIGTERM, signal_handler);
     // pin map is not initialized properly in gcc build before setup runs
     boardInit();
+    if (ticks.ticksImpl().simulated()) {
+        std::srand(ticks.ticksImpl().seed());
+    }
 #endif
     Buzzer.beep(2, 50);
 
@@ -132,6 +138,7 @@ setup()
 
     do {
         displayTick();
+        ticks.delayMillis(1);
     } while (ticks.millis() < 2000);
 
     enablePheripheral5V(true);
@@ -144,6 +151,7 @@ setup()
     HAL_Delay_Milliseconds(1);
     StartupScreen::setProgress(40);
     StartupScreen::setStep("Init BrewBlox framework");
+    FilterBank::defaultBank()->stepOnAdd(false); // stepped once per pass by updateBrewbloxBox()
     brewbloxBox();
 
     HAL_Delay_Milliseconds(1);
@@ -161,11 +169,16 @@ setup()
 
     while (ticks.millis() < 5000) {
         displayTick();
-        HAL_Delay_Milliseconds(1);
+        ticks.delayMillis(1);
     };
 
     WidgetsScreen::activate();
-#if PLATFORM_ID != PLATFORM_GCC
+#if PLATFORM_ID == PLATFORM_GCC
+    // the simulation clock runs the timer tasks itself
+    if (!ticks.ticksImpl().simulated()) {
+        TimerInterrupts::init();
+    }
+#else
     TimerInterrupts::init();
 #endif
 
@@ -176,11 +189,17 @@ setup()
 void
 loop()
 {
+#if PLATFORM_ID == PLATFORM_GCC
+    // the timer thread runs its tasks during the delay at the end of the loop, not while blocks are accessed
+    TimerInterrupts::Guard timerGuard;
+#endif
+
     ticks.switchTaskTimer(TicksClass::TaskId::Communication);
     if (!listeningModeEnabled()) {
         manageConnections(ticks.millis());
         brewbloxBox().hexCommunicate();
     }
+    logger().drain(); // write log records that were added during the last pass
 
     ticks.switchTaskTimer(TicksClass::TaskId::BlocksUpdate);
     updateBrewbloxBox();
@@ -190,7 +209,11 @@ loop()
 
     ticks.switchTaskTimer(TicksClass::TaskId::System);
     watchdogCheckin();
-    HAL_Delay_Milliseconds(1);
+#if PLATFORM_ID == PLATFORM_GCC
+    timerGuard.unlock();
+#endif
+    idleBrewbloxBox();
+    ticks.delayMillis(1);
 }
 
 void
@@ -29,6 +29,7 @@
 #include "proto/test/cpp/DigitalActuator_test.pb.h"
 #include "proto/test/cpp/SetpointSensorPair_test.pb.h"
 #include "proto/test/cpp/TempSensorMock_test.pb.h"
+#include <algorithm>
 #include <sstream>
 
 SCENARIO("Test", "[maklogicblock]")
@@ -319,6 +320,18 @@ SCENARIO("Test", "[maklogicblock]")
             result = setLogic(message);
             CHECK(result.result() == blox::ActuatorLogic_Result_BLOCK_NOT_FOUND);
             CHECK(result.errorpos() == 0);
+
+            // the missing block is reported when the expression would not need to evaluate it
+            setAct(101, blox::DigitalState::Active);
+            message.set_expression("a|b");
+            result = setLogic(message);
+            CHECK(result.result() == blox::ActuatorLogic_Result_BLOCK_NOT_FOUND);
+            CHECK(result.errorpos() == 2);
+
+            auto target = brewbloxBox().makeCboxPtr<DigitalActuatorBlock>(105);
+            REQUIRE(target.lock());
+            testBox.update(1000);
+            CHECK(target.lock()->getConstrained().state() == ActuatorDigitalBase::State::Inactive);
         }
 
         AND_WHEN("Analog comparisons are used")
@@ -368,4 +381,46 @@ SCENARIO("Test", "[maklogicblock]")
             CHECK(result.result() == blox::ActuatorLogic_Result_FALSE);
         }
     }
+
+    WHEN("An input of the logic block changes")
+    {
+        auto message = blox::ActuatorLogic();
+        {
+            auto d = message.add_digital();
+            d->set_id(101);
+            d->set_rhs(blox::DigitalState::Active);
+            d->set_op(blox::ActuatorLogic_DigitalCompareOp_DESIRED_IS);
+        }
+        message.set_expression("a");
+        setLogic(message);
+
+        auto input = brewbloxBox().makeCboxPtr<DigitalActuatorBlock>(101);
+        auto target = brewbloxBox().makeCboxPtr<DigitalActuatorBlock>(105);
+        REQUIRE(input.lock());
+        REQUIRE(target.lock());
+
+        cbox::update_t now = 1000;
+        testBox.update(now);
+        REQUIRE(target.lock()->getConstrained().state() == ActuatorDigitalBase::State::Inactive);
+
+        THEN("The target follows the input on the next pass, instead of the next poll of the logic block")
+        {
+            uint32_t maxPasses = 0;
+            auto state = ActuatorDigitalBase::State::Inactive;
+            for (int toggle = 0; toggle < 10; toggle++) {
+                now += 37; // toggle between the fallback updates of the logic block
+                testBox.update(now);
+                state = state == ActuatorDigitalBase::State::Active ? ActuatorDigitalBase::State::Inactive : ActuatorDigitalBase::State::Active;
+                input.lock()->getConstrained().desiredState(state, now);
+
+                uint32_t passes = 0;
+                while (target.lock()->getConstrained().state() != state && passes < 200) {
+                    testBox.update(++now);
+                    ++passes;
+                }
+                maxPasses = std::max(maxPasses, passes);
+            }
+            CHECK(maxPasses == 1);
+        }
+    }
 }
@@ -0,0 +1,320 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "blox/ActuatorLogicProgram.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Result = blox_ActuatorLogic_Result;
+
+// the string evaluator that was used before expressions were compiled, all compares are evaluated up front
+class ReferenceEvaluator {
+public:
+    ReferenceEvaluator(const std::string& expression, const std::vector<Result>& digitals, const std::vector<Result>& analogs)
+        : expression(expression)
+        , digitals(digitals)
+        , analogs(analogs)
+    {
+    }
+
+    Result evaluate()
+    {
+        auto it = expression.cbegin();
+        return eval(it, 0);
+    }
+
+private:
+    Result eval(std::string::const_iterator& it, uint8_t level) const
+    {
+        Result res = blox_ActuatorLogic_Result_EMPTY_SUBSTRING;
+        while (it < expression.cend()) {
+            if (res > blox_ActuatorLogic_Result_EMPTY_SUBSTRING) {
+                return res;
+            }
+            auto c = *it;
+            ++it;
+            if ('a' <= c && c <= 'z') {
+                res = digitals[c - 'a'];
+            } else if ('A' <= c && c <= 'Z') {
+                res = analogs[c - 'A'];
+            } else if (c == '!') {
+                auto rhs = eval(it, level);
+                if (rhs > blox_ActuatorLogic_Result_TRUE) {
+                    return rhs;
+                }
+                return rhs == blox_ActuatorLogic_Result_TRUE ? blox_ActuatorLogic_Result_FALSE : blox_ActuatorLogic_Result_TRUE;
+            } else if (c == '|') {
+                auto rhs = eval(it, level);
+                if (rhs > blox_ActuatorLogic_Result_TRUE) {
+                    return rhs;
+                }
+                return res == blox_ActuatorLogic_Result_TRUE ? res : rhs;
+            } else if (c == '&') {
+                auto rhs = eval(it, level);
+                if (rhs > blox_ActuatorLogic_Result_TRUE) {
+                    return rhs;
+                }
+                return res == blox_ActuatorLogic_Result_TRUE ? rhs : res;
+            } else if (c == '^') {
+                auto rhs = eval(it, level);
+                if (rhs > blox_ActuatorLogic_Result_TRUE) {
+                    return rhs;
+                }
+                return rhs != res ? blox_ActuatorLogic_Result_TRUE : blox_ActuatorLogic_Result_FALSE;
+            } else if (c == '(') {
+                res = eval(it, level + 1);
+            } else if (c == ')') {
+                return res;
+            }
+        }
+        return res;
+    }
+
+    const std::string& expression;
+    const std::vector<Result>& digitals;
+    const std::vector<Result>& analogs;
+};
+
+// generates valid expressions with the given number of compares
+class ExpressionGenerator {
+public:
+    ExpressionGenerator(uint8_t numDigital, uint8_t numAnalog)
+        : numDigital(numDigital)
+        , numAnalog(numAnalog)
+    {
+    }
+
+    std::string operator()(size_t length)
+    {
+        std::string expr;
+        while (expr.size() + 3 < length) {
+            std::string next = operand(length - expr.size() - 2);
+            if (!expr.empty()) {
+                next = std::string(1, "|&^"[rng() % 3]) + next;
+            }
+            if (expr.size() + next.size() + 1 >= length) {
+                break;
+            }
+            expr += next;
+        }
+        if (expr.empty()) {
+            expr = operand(1);
+        }
+        return expr;
+    }
+
+private:
+    std::string operand(size_t maxLength)
+    {
+        auto choice = rng() % 8;
+        if (choice == 0 && maxLength > 8) {
+            return "(" + compare() + std::string(1, "|&^"[rng() % 3]) + compare() + ")";
+        }
+        if (choice == 1 && maxLength > 8) {
+            return "!(" + compare() + std::string(1, "|&^"[rng() % 3]) + compare() + ")";
+        }
+        return compare();
+    }
+
+    std::string compare()
+    {
+        if (rng() % 2) {
+            return std::string(1, 'a' + rng() % numDigital);
+        }
+        return std::string(1, 'A' + rng() % numAnalog);
+    }
+
+    uint8_t numDigital;
+    uint8_t numAnalog;
+    std::mt19937 rng{1234};
+};
+
+} // end anonymous namespace
+
+SCENARIO("Actuator logic expressions are compiled to a program", "[actuatorlogic]")
+{
+    std::vector<Result> digitals(4, blox_ActuatorLogic_Result_FALSE);
+    std::vector<Result> analogs(4, blox_ActuatorLogic_Result_FALSE);
+    uint32_t evaluated = 0;
+    auto digital = [&](uint8_t i) { ++evaluated; return digitals[i]; };
+    auto analog = [&](uint8_t i) { ++evaluated; return analogs[i]; };
+
+    ActuatorLogicProgram program;
+    uint8_t errorPos = 0;
+
+    WHEN("The expression is empty")
+    {
+        program.compile("", 4, 4);
+        CHECK(program.error() == blox_ActuatorLogic_Result_EMPTY);
+        CHECK(program.eval(digital, analog, errorPos) == blox_ActuatorLogic_Result_EMPTY);
+    }
+
+    WHEN("The expression has a syntax error, it is reported by the compiler with its position")
+    {
+        auto compileError = [&](const std::string& expr) {
+            program.compile(expr, 4, 4);
+            CHECK_FALSE(program.valid());
+            CHECK(program.eval(digital, analog, errorPos) == program.error());
+            CHECK(errorPos == program.errorPos());
+            return std::make_pair(program.error(), program.errorPos());
+        };
+
+        CHECK(compileError("e&c") == std::make_pair(blox_ActuatorLogic_Result_INVALID_DIG_COMPARE_IDX, uint8_t(0)));
+        CHECK(compileError("a|E") == std::make_pair(blox_ActuatorLogic_Result_INVALID_ANA_COMPARE_IDX, uint8_t(2)));
+        CHECK(compileError("a(|b&c)") == std::make_pair(blox_ActuatorLogic_Result_UNEXPECTED_OPENING_BRACKET, uint8_t(1)));
+        CHECK(compileError("a|(b&c") == std::make_pair(blox_ActuatorLogic_Result_MISSING_CLOSING_BRACKET, uint8_t(5)));
+        CHECK(compileError("a|(b&c))") == std::make_pair(blox_ActuatorLogic_Result_UNEXPECTED_CLOSING_BRACKET, uint8_t(7)));
+        CHECK(compileError("a|(b&.)") == std::make_pair(blox_ActuatorLogic_Result_UNEXPECTED_CHARACTER, uint8_t(5)));
+        CHECK(compileError("a|(b&)") == std::make_pair(blox_ActuatorLogic_Result_EMPTY_SUBSTRING, uint8_t(5)));
+        CHECK(compileError("a|") == std::make_pair(blox_ActuatorLogic_Result_EMPTY_SUBSTRING, uint8_t(1)));
+        CHECK(compileError("&a") == std::make_pair(blox_ActuatorLogic_Result_EMPTY_SUBSTRING, uint8_t(0)));
+        CHECK(compileError("()") == std::make_pair(blox_ActuatorLogic_Result_EMPTY_SUBSTRING, uint8_t(1)));
+        CHECK(evaluated == 0);
+    }
+
+    WHEN("A compare returns an error, evaluation stops with the position of the compare")
+    {
+        program.compile("a&(b|C)", 4, 4);
+        REQUIRE(program.valid());
+        digitals[0] = blox_ActuatorLogic_Result_TRUE;
+        analogs[2] = blox_ActuatorLogic_Result_BLOCK_NOT_FOUND;
+        CHECK(program.eval(digital, analog, errorPos) == blox_ActuatorLogic_Result_BLOCK_NOT_FOUND);
+        CHECK(errorPos == 5);
+
+        AND_WHEN("The compare is not needed for the result")
+        {
+            digitals[1] = blox_ActuatorLogic_Result_TRUE;
+            CHECK(program.eval(digital, analog, errorPos) == blox_ActuatorLogic_Result_TRUE);
+            CHECK(errorPos == 0);
+        }
+    }
+
+    WHEN("The left hand side of an or is true, or the left hand side of an and is false")
+    {
+        digitals[0] = blox_ActuatorLogic_Result_TRUE;
+
+        THEN("The right hand side is not evaluated")
+        {
+            program.compile("a|(b&c&d)", 4, 4);
+            CHECK(program.eval(digital, analog, errorPos) == blox_ActuatorLogic_Result_TRUE);
+            CHECK(evaluated == 1);
+
+            evaluated = 0;
+            program.compile("B&(a|c|d)", 4, 4);
+            CHECK(program.eval(digital, analog, errorPos) == blox_ActuatorLogic_Result_FALSE);
+            CHECK(evaluated == 1);
+
+            evaluated = 0;
+            program.compile("!(b|a|c)^D", 4, 4);
+            CHECK(program.eval(digital, analog, errorPos) == blox_ActuatorLogic_Result_FALSE);
+            CHECK(evaluated == 3);
+        }
+    }
+
+    WHEN("Random expressions are evaluated for all combinations of compare results")
+    {
+        ExpressionGenerator generate(4, 4);
+        for (int n = 0; n < 200; n++) {
+            auto expr = generate(4 + n % 40);
+            program.compile(expr, 4, 4);
+            REQUIRE(program.valid());
+            CAPTURE(expr);
+            for (uint16_t bits = 0; bits < 256; bits++) {
+                for (uint8_t i = 0; i < 4; i++) {
+                    digitals[i] = (bits >> i) & 1 ? blox_ActuatorLogic_Result_TRUE : blox_ActuatorLogic_Result_FALSE;
+                    analogs[i] = (bits >> (i + 4)) & 1 ? blox_ActuatorLogic_Result_TRUE : blox_ActuatorLogic_Result_FALSE;
+                }
+                ReferenceEvaluator reference(expr, digitals, analogs);
+                REQUIRE(program.eval(digital, analog, errorPos) == reference.evaluate());
+            }
+        }
+    }
+}
+
+SCENARIO("Benchmark actuator logic evaluation with 16+16 compares", "[actuatorlogic][.benchmark]")
+{
+    constexpr uint8_t numCompares = 16;
+    constexpr int iterations = 100000;
+
+    std::vector<Result> digitals(numCompares, blox_ActuatorLogic_Result_FALSE);
+    std::vector<Result> analogs(numCompares, blox_ActuatorLogic_Result_FALSE);
+    for (uint8_t i = 0; i < numCompares; i++) {
+        digitals[i] = i % 3 ? blox_ActuatorLogic_Result_FALSE : blox_ActuatorLogic_Result_TRUE;
+        analogs[i] = i % 2 ? blox_ActuatorLogic_Result_FALSE : blox_ActuatorLogic_Result_TRUE;
+    }
+
+    ExpressionGenerator generate(numCompares, numCompares);
+    std::vector<std::string> expressions;
+    for (int i = 0; i < 16; i++) {
+        expressions.push_back(generate(ActuatorLogicProgram::maxLength));
+        REQUIRE(expressions.back().size() > ActuatorLogicProgram::maxLength - 8);
+    }
+
+    uint32_t evaluated = 0;
+    auto digital = [&](uint8_t i) { ++evaluated; return digitals[i]; };
+    auto analog = [&](uint8_t i) { ++evaluated; return analogs[i]; };
+
+    // before, every update evaluated all compares and parsed the expression string
+    uint32_t referenceTrue = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        const auto& expr = expressions[i % expressions.size()];
+        for (uint8_t c = 0; c < numCompares; c++) {
+            digital(c);
+            analog(c);
+        }
+        ReferenceEvaluator reference(expr, digitals, analogs);
+        referenceTrue += reference.evaluate() == blox_ActuatorLogic_Result_TRUE;
+    }
+    auto referenceTime = std::chrono::steady_clock::now() - start;
+    auto referenceEvaluated = evaluated;
+
+    std::vector<ActuatorLogicProgram> programs(expressions.size());
+    for (size_t i = 0; i < expressions.size(); i++) {
+        programs[i].compile(expressions[i], numCompares, numCompares);
+        REQUIRE(programs[i].valid());
+    }
+
+    evaluated = 0;
+    uint32_t programTrue = 0;
+    uint8_t errorPos = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        programTrue += programs[i % programs.size()].eval(digital, analog, errorPos) == blox_ActuatorLogic_Result_TRUE;
+    }
+    auto programTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Actuator logic with 16+16 compares and 64 character expressions:" << std::endl
+              << "  string evaluator: "
+              << std::chrono::duration<double, std::nano>(referenceTime).count() / iterations << " ns, "
+              << double(referenceEvaluated) / iterations << " compares per evaluation" << std::endl
+              << "  compiled program: "
+              << std::chrono::duration<double, std::nano>(programTime).count() / iterations << " ns, "
+              << double(evaluated) / iterations << " compares per evaluation" << std::endl;
+
+    CHECK(programTrue == referenceTrue);
+    CHECK(evaluated < referenceEvaluated);
+}
@@ -217,5 +217,54 @@ SCENARIO("A SetpointProfile block")
                                                 "drivenTargetId: 101 "
                                                 "start: 20000");
         }
+
+        WHEN("The block is persisted and loaded again")
+        {
+            uint8_t persisted[100] = {0};
+            BufferDataOut persistedOut(persisted, sizeof(persisted));
+            CHECK(profilePtr->streamPersistedTo(persistedOut) == CboxError::OK);
+
+            uint8_t streamed[100] = {0};
+            BufferDataOut streamedOut(streamed, sizeof(streamed));
+            CHECK(profilePtr->streamTo(streamedOut) == CboxError::OK);
+
+            auto checkPoints = [&profilePtr]() {
+                const auto& points = profilePtr->get().points();
+                REQUIRE(points.size() == 2);
+                CHECK(points[0].time == 10);
+                CHECK(points[0].temp == temp_t(20));
+                CHECK(points[1].time == 20);
+                CHECK(points[1].temp == temp_t(21));
+            };
+
+            THEN("The persisted data is decoded by the regular message definition, without losing the points")
+            {
+                auto decoded = blox::SetpointProfile();
+                REQUIRE(decoded.ParseFromArray(persisted, persistedOut.bytesWritten() - 1)); // without the zero terminator
+                CHECK(decoded.ShortDebugString() == "points { time: 10 temperature: 81920 } "
+                                                    "points { time: 20 temperature: 86016 } "
+                                                    "enabled: true "
+                                                    "targetId: 101 "
+                                                    "start: 20000");
+            }
+
+            AND_THEN("The points and settings are restored from the persisted data")
+            {
+                profilePtr->get().removeAllPoints();
+                BufferDataIn in(persisted, persistedOut.bytesWritten());
+                CHECK(profilePtr->streamFrom(in) == CboxError::OK);
+                checkPoints();
+                CHECK(profilePtr->get().startTime() == 20'000);
+                CHECK(profilePtr->get().enabled() == true);
+            }
+
+            AND_THEN("The points are also restored from the streamed data")
+            {
+                profilePtr->get().removeAllPoints();
+                BufferDataIn in(streamed, streamedOut.bytesWritten());
+                CHECK(profilePtr->streamFrom(in) == CboxError::OK);
+                checkPoints();
+            }
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#!/bin/bash
+MY_DIR=$(dirname $(readlink -f $0))
+
+function status()
+{
+if [[ "$1" -eq 0 ]]; then
+  echo "✓ SUCCESS"
+else
+  echo "✗ FAILED"
+fi
+}
+
+pushd "$MY_DIR/../lib/bench" > /dev/null
+echo "Building control loop benchmarks"
+make $MAKE_ARGS -s runner
+(( result = $? ))
+status $result
+(( exit_status = exit_status || result ))
+
+build/lib_bench_runner build/control-loop-bench.json
+(( result = $? ))
+status $result
+(( exit_status = exit_status || result ))
+
+popd > /dev/null
+
+exit $exit_status
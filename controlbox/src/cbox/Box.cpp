@@ -100,7 +100,7 @@ Box::readObject(DataIn& in, EncodedDataOut& out)
     out.write(asUint8(status));
     if (status == CboxError::OK) {
         // stream object as id, groups, typeId, data
-        status = cobj->streamTo(out);
+        status = streamCache.streamTo(*cobj, out);
         if (status != CboxError::OK) {
             out.writeError(status);
             out.invalidateCrc();
@@ -125,6 +125,8 @@ Box::writeObject(DataIn& in, EncodedDataOut& out)
 
     // stream new settings to object
     if (cobj) {
+        // writing an object can change the output of the objects that depend on it
+        streamCache.invalidate();
         status = cobj->streamFrom(in);
     }
 
@@ -242,6 +244,7 @@ Box::createObject(DataIn& in, EncodedDataOut& out)
     }
     ContainedObject* ptrCobj = nullptr;
     if (status == CboxError::OK) {
+        streamCache.invalidate();
         // add object to container. Id is returned because id from stream can be 0 to let the box assign it
         id = objects.add(std::move(newObj), groups, id, false);
         ptrCobj = objects.fetchContained(id);
@@ -299,6 +302,7 @@ Box::deleteObject(DataIn& in, EncodedDataOut& out)
     }
 
     if (status == CboxError::OK) {
+        streamCache.invalidate();
         status = objects.remove(id);
         storage.disposeObject(storageId);
     }
@@ -326,7 +330,7 @@ Box::listActiveObjects(DataIn& in, EncodedDataOut& out)
     out.write(asUint8(CboxError::OK));
     for (auto it = objects.cbegin(); it < objects.cend(); it++) {
         out.writeListSeparator();
-        it->streamTo(out);
+        streamCache.streamTo(*it, out);
     }
 }
 
@@ -480,6 +484,7 @@ Box::loadObjectsFromStorage()
         return status;
     };
     // now apply the loader above to all objects in storage
+    streamCache.invalidate();
     storage.retrieveObjects(objectLoader);
 
     // add deprecated object placeholders at the end
@@ -557,6 +562,7 @@ Box::clearObjects(DataIn& in, EncodedDataOut& out)
     }
 
     // remove all user objects from vector
+    streamCache.invalidate();
     objects.clear();
 
     out.write(asUint8(CboxError::OK));
@@ -582,6 +588,7 @@ Box::discoverNewObjects(DataIn& in, EncodedDataOut& out)
 
     out.write(asUint8(CboxError::OK));
 
+    streamCache.invalidate();
     for (auto& scanner : scanners) {
         scanner->reset();
         auto newId = obj_id_t(0);
@@ -691,6 +698,7 @@ void
 Box::setActiveGroupsAndUpdateObjects(const uint8_t newGroups)
 {
     activeGroups = newGroups | 0x80; // system group cannot be disabled
+    streamCache.invalidate();
     for (auto cit = objects.userbegin(); cit != objects.cend(); cit++) {
         obj_id_t objId = cit->id();
         uint8_t objGroups = cit->groups();
@@ -764,6 +772,7 @@ Box::reloadStoredObject(const obj_id_t& id)
         return CboxError::INVALID_OBJECT_ID;
     }
 
+    streamCache.invalidate();
     bool handlerCalled = false;
     auto streamHandler = [&cobj, &handlerCalled](RegionDataIn& objInStorage) -> CboxError {
         handlerCalled = true;
@@ -28,6 +28,7 @@
 #include "Object.h"
 #include "ObjectContainer.h"
 #include "ObjectFactory.h"
+#include "ObjectStreamCache.h"
 #include "ScanningFactory.h"
 #include <memory>
 
@@ -46,6 +47,9 @@ private:
     std::vector<std::unique_ptr<ScanningFactory>> scanners;
     uint8_t activeGroups = 0x81; // system group and first user group
     update_t lastUpdateTime = 0;
+    // Serialized objects are cached until the next update, so repeated reads within one tick are cheap.
+    // Output of an object can change without its own update (ticks, targets of other blocks), so all entries are dropped.
+    ObjectStreamCache streamCache;
 
     // command handlers
     void noop(DataIn& in, EncodedDataOut& out);
@@ -100,15 +104,28 @@ public:
     void update(const update_t& now)
     {
         lastUpdateTime = now;
+        streamCache.invalidate();
         objects.update(now);
     }
 
     void forcedUpdate(const update_t& now)
     {
         lastUpdateTime = now;
+        streamCache.invalidate();
         objects.forcedUpdate(now);
     }
 
+    // earliest time at which an object wants to be updated, now if an update is overdue
+    update_t nextUpdateTime(const update_t& now) const
+    {
+        return objects.nextUpdateTime(now);
+    }
+
+    ObjectStreamCache& objectStreamCache()
+    {
+        return streamCache;
+    }
+
     void loadObjectsFromStorage();
 
     inline const obj_id_t userStartId() const
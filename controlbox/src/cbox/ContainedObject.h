@@ -37,6 +37,8 @@ public:
         , _groups(std::move(groups))
         , _obj(std::move(obj))
         , _nextUpdateTime(0)
+        , _generation(0)
+        , _woken(false)
     {
     }
 
@@ -45,6 +47,8 @@ private:
     uint8_t _groups;              // active in these groups
     std::shared_ptr<Object> _obj; // pointer to runtime object
     update_t _nextUpdateTime;     // next time update should be called on _obj
+    uint32_t _generation;         // incremented each time the object is updated or written
+    bool _woken;                  // update on the next pass, regardless of the next update time
 
 public:
     const obj_id_t& id() const
@@ -62,23 +66,55 @@ public:
         return _obj;
     }
 
+    /**
+     * The generation changes each time the object could have changed its state: on update, write or deactivation.
+     * It can be used to check whether previously streamed output of the object is still valid.
+     */
+    const uint32_t& generation() const
+    {
+        return _generation;
+    }
+
+    const update_t& nextUpdateTime() const
+    {
+        return _nextUpdateTime;
+    }
+
+    /**
+     * Request an update on the next pass, for example because an input of the object has changed.
+     */
+    void wake()
+    {
+        _woken = true;
+    }
+
+    bool woken() const
+    {
+        return _woken;
+    }
+
     void deactivate()
     {
         obj_type_t oldType = _obj->typeId();
         _obj = std::make_shared<InactiveObject>(oldType);
+        ++_generation;
     }
 
     void update(const update_t& now)
     {
         const update_t overflowGuard = std::numeric_limits<update_t>::max() / 2;
-        if (overflowGuard - now + _nextUpdateTime <= overflowGuard) {
+        if (_woken || overflowGuard - now + _nextUpdateTime <= overflowGuard) {
+            _woken = false;
             _nextUpdateTime = _obj->update(now);
+            ++_generation;
         }
     }
 
     void forcedUpdate(const uint32_t& now)
     {
+        _woken = false;
         _nextUpdateTime = _obj->update(now);
+        ++_generation;
     }
 
     CboxError streamTo(DataOut& out) const
@@ -109,6 +145,7 @@ public:
         }
 
         if (expectedType == _obj->typeId()) {
+            ++_generation;
             if (_groups & 0x80) {
                 // system object, always keep system group flag
                 _groups = newGroups | 0x80;
@@ -21,8 +21,10 @@
 
 #include "ContainedObject.h"
 #include "Object.h"
+#include <algorithm>
 #include <functional>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace cbox {
@@ -215,6 +217,35 @@ public:
             cobj.forcedUpdate(now);
         }
     }
+
+    // update the object on the next pass, objects use this to wake up when their inputs change
+    void wake(const Object* obj)
+    {
+        for (auto& cobj : objects) {
+            if (cobj.object().get() == obj) {
+                cobj.wake();
+                return;
+            }
+        }
+    }
+
+    // earliest time at which an object wants to be updated, now if an update is overdue
+    update_t nextUpdateTime(const update_t& now) const
+    {
+        const update_t overflowGuard = std::numeric_limits<update_t>::max() / 2;
+        update_t wait = overflowGuard;
+        for (const auto& cobj : objects) {
+            if (cobj.woken()) {
+                return now;
+            }
+            update_t objWait = cobj.nextUpdateTime() - now;
+            if (objWait > overflowGuard) {
+                return now;
+            }
+            wait = std::min(wait, objWait);
+        }
+        return now + wait;
+    }
 };
 
 } // end namespace cbox
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019 BrewPi B.V. / Elco Jacobs
+ *
+ * This file is part of ControlBox
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CboxError.h"
+#include "ContainedObject.h"
+#include "DataStream.h"
+#include "ObjectIds.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifndef CBOX_STREAM_CACHE_SIZE
+#define CBOX_STREAM_CACHE_SIZE 512
+#endif
+
+namespace cbox {
+
+/**
+ * Caches the streamed output of contained objects for the duration of one update tick.
+ * When multiple clients read the same object between two updates, the object is only serialized once.
+ *
+ * Entries are keyed on the object id and the update generation of the contained object.
+ * An entry with an older generation is evicted when its object is looked up.
+ * All entries are dropped when the box starts a new update tick or when an object is changed by a command.
+ *
+ * The cache is a single arena of a fixed number of bytes. Each entry is stored as a small header followed by the data.
+ * When the arena is full, objects are streamed directly without being cached.
+ */
+class ObjectStreamCache {
+private:
+    struct EntryHeader {
+        uint32_t generation;
+        obj_id_t id;
+        stream_size_t size;
+    };
+
+    /**
+     * Writes to the output stream and copies all written bytes to the arena.
+     * When the arena is full, copying stops and the entry is flagged as incomplete.
+     */
+    class CapturingDataOut final : public DataOut {
+    private:
+        DataOut& out;
+        uint8_t* dest;
+        stream_size_t capacity;
+        stream_size_t pos = 0;
+        bool overflow = false;
+
+    public:
+        CapturingDataOut(DataOut& _out, uint8_t* _dest, stream_size_t _capacity)
+            : out(_out)
+            , dest(_dest)
+            , capacity(_capacity)
+        {
+        }
+        virtual ~CapturingDataOut() = default;
+
+        virtual bool write(uint8_t data) override final
+        {
+            if (pos < capacity) {
+                dest[pos++] = data;
+            } else {
+                overflow = true;
+            }
+            return out.write(data);
+        }
+
+        stream_size_t captured() const
+        {
+            return pos;
+        }
+
+        bool complete() const
+        {
+            return !overflow;
+        }
+    };
+
+    std::vector<uint8_t> arena;
+    stream_size_t used = 0;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+
+    /**
+     * Finds the entry of the object. An entry of the object with a different generation is stale and is removed.
+     */
+    const uint8_t* find(const obj_id_t& id, uint32_t generation, stream_size_t& size)
+    {
+        stream_size_t pos = 0;
+        while (pos < used) {
+            EntryHeader header;
+            memcpy(&header, &arena[pos], sizeof(header));
+            stream_size_t entrySize = sizeof(header) + header.size;
+            if (header.id == id) {
+                if (header.generation == generation) {
+                    size = header.size;
+                    return &arena[pos + sizeof(header)];
+                }
+                // evict: move the entries after it to close the gap
+                memmove(&arena[pos], &arena[pos + entrySize], used - pos - entrySize);
+                used -= entrySize;
+                return nullptr; // an object has at most one entry
+            }
+            pos += entrySize;
+        }
+        return nullptr;
+    }
+
+public:
+    explicit ObjectStreamCache(stream_size_t budget = CBOX_STREAM_CACHE_SIZE)
+        : arena(budget)
+    {
+    }
+    ~ObjectStreamCache() = default;
+
+    /**
+     * Changes the number of bytes the cache can use. A budget of 0 disables caching.
+     */
+    void setBudget(stream_size_t budget)
+    {
+        invalidate();
+        arena.resize(budget);
+        arena.shrink_to_fit();
+    }
+
+    stream_size_t budget() const
+    {
+        return stream_size_t(arena.size());
+    }
+
+    stream_size_t bytesUsed() const
+    {
+        return used;
+    }
+
+    /**
+     * Drops all cached entries. Call on each update tick and when objects are modified.
+     */
+    void invalidate()
+    {
+        used = 0;
+    }
+
+    uint32_t hits() const
+    {
+        return _hits;
+    }
+
+    uint32_t misses() const
+    {
+        return _misses;
+    }
+
+    void resetCounters()
+    {
+        _hits = 0;
+        _misses = 0;
+    }
+
+    /**
+     * Streams the contained object to out. Cached bytes are copied if available.
+     * Otherwise, the object is streamed and its output is added to the cache if it fits.
+     */
+    CboxError streamTo(const ContainedObject& cobj, DataOut& out)
+    {
+        stream_size_t size = 0;
+        if (auto cached = find(cobj.id(), cobj.generation(), size)) {
+            ++_hits;
+            if (!out.writeBuffer(cached, size)) {
+                return CboxError::OUTPUT_STREAM_WRITE_ERROR; // LCOV_EXCL_LINE
+            }
+            return CboxError::OK;
+        }
+
+        ++_misses;
+        stream_size_t available = budget() - used;
+        if (available <= sizeof(EntryHeader)) {
+            return cobj.streamTo(out);
+        }
+
+        uint8_t* entryStart = arena.data() + used;
+        CapturingDataOut capture(out, entryStart + sizeof(EntryHeader), available - sizeof(EntryHeader));
+        auto status = cobj.streamTo(capture);
+        if (status == CboxError::OK && capture.complete()) {
+            EntryHeader header{cobj.generation(), cobj.id(), capture.captured()};
+            memcpy(entryStart, &header, sizeof(header));
+            used += sizeof(header) + capture.captured();
+        }
+        return status;
+    }
+};
+
+} // end namespace cbox
@@ -132,6 +132,91 @@ SCENARIO("A controlbox Box")
         }
     }
 
+    WHEN("An object is read multiple times within the same update tick, the streamed data is cached")
+    {
+        box.update(0);
+        box.objectStreamCache().resetCounters();
+
+        auto readObject2 = [&]() {
+            clearStreams();
+            *in << "0000010200"; // read object 2
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("0000010200")
+                     << "|" << addCrc("00"        // no error
+                                      "0200"      // object id 2
+                                      "80"        // groups 0x80
+                                      "E803"      // object type 1000
+                                      "11111111") // object data
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        };
+
+        readObject2();
+        readObject2();
+        readObject2();
+
+        THEN("The object is only serialized on the first read")
+        {
+            CHECK(box.objectStreamCache().misses() == 1);
+            CHECK(box.objectStreamCache().hits() == 2);
+        }
+
+        AND_WHEN("The box is updated, the cache is invalidated")
+        {
+            box.update(1000);
+            readObject2();
+            CHECK(box.objectStreamCache().misses() == 2);
+            CHECK(box.objectStreamCache().hits() == 2);
+        }
+
+        AND_WHEN("The object is updated, its stale entry is replaced on the next read")
+        {
+            auto bytesUsed = box.objectStreamCache().bytesUsed();
+            box.forcedUpdate(1000);
+            readObject2();
+            CHECK(box.objectStreamCache().misses() == 2);
+            CHECK(box.objectStreamCache().hits() == 2);
+            CHECK(box.objectStreamCache().bytesUsed() == bytesUsed);
+
+            readObject2();
+            CHECK(box.objectStreamCache().hits() == 3);
+        }
+
+        AND_WHEN("An object is written, the cached data is not used for the next read")
+        {
+            clearStreams();
+            *in << "000002020080E80333333333"; // write object 2, set groups to 80 and value to 33333333
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            clearStreams();
+            *in << "0000010200"; // read object 2
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("0000010200")
+                     << "|" << addCrc("00"        // no error
+                                      "0200"      // object id 2
+                                      "80"        // groups 0x80
+                                      "E803"      // object type 1000
+                                      "33333333") // new object data
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+
+        AND_WHEN("The cache budget is set to zero, caching is disabled")
+        {
+            box.objectStreamCache().setBudget(0);
+            box.objectStreamCache().resetCounters();
+            readObject2();
+            readObject2();
+            CHECK(box.objectStreamCache().hits() == 0);
+            CHECK(box.objectStreamCache().bytesUsed() == 0);
+        }
+    }
+
     WHEN("A connection sends a create object command, it is processed by the Box")
     {
         *in << "000003"    // create object
@@ -804,6 +889,13 @@ SCENARIO("A controlbox Box")
             CHECK(counter2->count() == 1 + 5);
         }
 
+        THEN("The next update time is the earliest time an object wants to be updated")
+        {
+            CHECK(box.nextUpdateTime(10001) == 11000);
+            CHECK(box.nextUpdateTime(11000) == 11000);
+            CHECK(box.nextUpdateTime(11500) == 11500); // overdue
+        }
+
         box.update(10500); // update just before write
         clearStreams();
         *in << "000002" // write counter object
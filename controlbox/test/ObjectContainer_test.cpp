@@ -208,3 +208,40 @@ SCENARIO("A container with system objects passed in the initializer list")
         CHECK(obj_id_t(100) == objects.add(std::make_unique<LongIntObject>(0x33333333), 0xFF)); // will get start ID (100)
     }
 }
+
+SCENARIO("Objects can be woken up before their next update time")
+{
+    ObjectContainer container;
+    auto counter = std::make_shared<UpdateCounter>();
+    auto other = std::make_shared<UpdateCounter>();
+    container.add(counter, 0xFF);
+    container.add(other, 0xFF);
+
+    container.update(0);
+    CHECK(counter->count() == 1);
+    CHECK(container.nextUpdateTime(1) == 1000);
+
+    WHEN("An object is woken up")
+    {
+        container.wake(counter.get());
+
+        THEN("The next update time is now")
+        {
+            CHECK(container.nextUpdateTime(1) == 1);
+        }
+
+        THEN("Only that object is updated on the next pass")
+        {
+            container.update(1);
+            CHECK(counter->count() == 2);
+            CHECK(other->count() == 1);
+
+            AND_THEN("It sleeps until its requested update time again")
+            {
+                container.update(2);
+                CHECK(counter->count() == 2);
+                CHECK(container.nextUpdateTime(2) == 1000);
+            }
+        }
+    }
+}
@@ -0,0 +1,406 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ControlLoopBench.h"
+#include "ActuatorDigital.h"
+#include "ActuatorDigitalConstrained.h"
+#include "ActuatorOffset.h"
+#include "ActuatorPwm.h"
+#include "MockIoArray.h"
+#include "Pid.h"
+#include "SetpointSensorPair.h"
+#include "TempSensorMock.h"
+#include "ThermalPlant.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+
+namespace {
+
+constexpr duration_millis_t tickInterval = 100;     // PWM, digital actuators and plants are updated every tick
+constexpr duration_millis_t controlInterval = 1000; // sensor pairs and PIDs are updated every second, like their blocks
+constexpr duration_millis_t hour = 3600000;
+
+// Feeds the state of a digital actuator to a thermal plant as 0% or 100%, so the plant sees the PWM ripple
+class DigitalPower final : public ActuatorAnalog {
+private:
+    const ActuatorDigitalConstrained& m_target;
+
+public:
+    explicit DigitalPower(const ActuatorDigitalConstrained& target)
+        : m_target(target)
+    {
+    }
+    ~DigitalPower() = default;
+
+    virtual void setting(const value_t&) override final
+    {
+    }
+    virtual value_t setting() const override final
+    {
+        return value();
+    }
+    virtual value_t value() const override final
+    {
+        return m_target.state() == ActuatorDigitalBase::State::Active ? value_t{100} : value_t{0};
+    }
+    virtual bool valueValid() const override final
+    {
+        return true;
+    }
+    virtual bool settingValid() const override final
+    {
+        return true;
+    }
+    virtual void settingValid(bool) override final
+    {
+    }
+};
+
+// A PWM driven digital output on a mock IO array, with its constraints
+struct PwmOutput {
+    ActuatorDigital digital;
+    std::shared_ptr<ActuatorDigitalConstrained> constrained;
+    std::shared_ptr<ActuatorPwm> pwm;
+    std::shared_ptr<DigitalPower> power;
+
+    PwmOutput(const std::shared_ptr<MockIoArray>& io, uint8_t channel, duration_millis_t period)
+        : digital([io]() { return io; }, channel)
+        , constrained(std::make_shared<ActuatorDigitalConstrained>(digital))
+        , pwm(std::make_shared<ActuatorPwm>([this]() { return constrained; }, period))
+        , power(std::make_shared<DigitalPower>(*constrained))
+    {
+    }
+
+    PwmOutput(const PwmOutput&) = delete;
+    PwmOutput& operator=(const PwmOutput&) = delete;
+
+    void update(ticks_millis_t now)
+    {
+        constrained->update(now);
+        pwm->update(now);
+    }
+
+    LoopRecorder::State state() const
+    {
+        return constrained->state();
+    }
+};
+
+double
+toDouble(const fp12_t& v)
+{
+    return double(cnl::unwrap(v)) / 4096;
+}
+
+} // end anonymous namespace
+
+LoopRecorder::LoopRecorder(std::string scenario, double band, std::vector<std::function<State()>>&& actuators)
+    : m_band(band)
+    , m_actuators(std::move(actuators))
+{
+    m_metrics.scenario = std::move(scenario);
+    for (const auto& a : m_actuators) {
+        m_lastStates.push_back(a());
+    }
+}
+
+void
+LoopRecorder::sample(ticks_millis_t now, double setpoint, double value)
+{
+    if (m_segments.empty()) {
+        m_segments.push_back(Segment{now, setpoint, 0, 0, now});
+        m_lastSample = now;
+    } else if (m_segments.back().setpoint != setpoint) {
+        double direction = setpoint > m_segments.back().setpoint ? 1 : -1;
+        m_segments.push_back(Segment{now, setpoint, direction, 0, now});
+    }
+
+    auto& segment = m_segments.back();
+    double error = value - setpoint;
+    double dt = double(now - m_lastSample) / hour;
+    m_lastSample = now;
+
+    m_metrics.iae += std::abs(error) * dt;
+    m_metrics.ise += error * error * dt;
+    segment.overshoot = std::max(segment.overshoot, segment.direction * error);
+    if (std::abs(error) > m_band) {
+        segment.lastOutsideBand = now;
+    }
+
+    for (size_t i = 0; i < m_actuators.size(); ++i) {
+        auto state = m_actuators[i]();
+        if (state != m_lastStates[i]) {
+            ++m_toggles;
+            m_lastStates[i] = state;
+        }
+    }
+}
+
+LoopMetrics
+LoopRecorder::finish()
+{
+    if (!m_segments.empty()) {
+        m_metrics.hours = double(m_lastSample - m_segments.front().start) / hour;
+    }
+    for (const auto& segment : m_segments) {
+        m_metrics.overshoot = std::max(m_metrics.overshoot, segment.overshoot);
+        m_metrics.settlingTime = std::max(m_metrics.settlingTime, double(segment.lastOutsideBand - segment.start) / 1000);
+    }
+    if (m_metrics.hours > 0) {
+        m_metrics.togglesPerHour = m_toggles / m_metrics.hours;
+    }
+    if (m_updates > 0) {
+        m_metrics.nsPerUpdate = double(m_cpuTime.count()) / m_updates;
+    }
+    return m_metrics;
+}
+
+// A fermenter with a heating belt is heated 4 degrees by a single PID
+LoopMetrics
+benchFermenterStep()
+{
+    auto io = std::make_shared<MockIoArray>();
+    auto sensor = std::make_shared<TempSensorMock>(20);
+    auto pair = std::make_shared<SetpointSensorPair>([sensor]() { return sensor; });
+    pair->setting(20);
+    pair->settingValid(true);
+
+    PwmOutput heater(io, 1, 60000);
+    auto pid = Pid([pair]() { return pair; }, [&heater]() { return heater.pwm; });
+    pid.kp(20);
+    pid.ti(7200);
+    pid.td(1800);
+    pid.enabled(true);
+
+    ThermalPlant plant([sensor]() { return sensor; }, 20, tickInterval);
+    plant.inputs({{[&heater]() { return heater.power; }, 4}});
+    plant.ambient(20);
+    plant.lossRate(0.2);
+    plant.deadTime(300000);
+
+    LoopRecorder recorder("fermenter-step", 0.2, {[&heater]() { return heater.state(); }});
+    for (ticks_millis_t now = 0; now <= 24 * hour; now += tickInterval) {
+        if (now == hour) {
+            pair->setting(24);
+        }
+        plant.update(now);
+        recorder.timeUpdate([&]() {
+            if (now % controlInterval == 0) {
+                pair->update();
+                pid.update();
+            }
+            heater.update(now);
+        });
+        recorder.sample(now, toDouble(pair->setting()), toDouble(plant.temperature()));
+    }
+    return recorder.finish();
+}
+
+// HERMS mash: the mash PID sets the HLT setpoint as an offset from the mash setpoint, the HLT PID drives the element.
+// The mash is heated by the HLT through the HERMS coil, modeled as loss to an 'ambient' that is the HLT temperature.
+LoopMetrics
+benchHermsMash()
+{
+    auto io = std::make_shared<MockIoArray>();
+    auto hltSensor = std::make_shared<TempSensorMock>(64);
+    auto mashSensor = std::make_shared<TempSensorMock>(64);
+    auto hltPair = std::make_shared<SetpointSensorPair>([hltSensor]() { return hltSensor; });
+    auto mashPair = std::make_shared<SetpointSensorPair>([mashSensor]() { return mashSensor; });
+    hltPair->setting(64);
+    hltPair->settingValid(true);
+    mashPair->setting(64);
+    mashPair->settingValid(true);
+
+    PwmOutput element(io, 1, 4000);
+    auto hltPid = Pid([hltPair]() { return hltPair; }, [&element]() { return element.pwm; });
+    hltPid.kp(40);
+    hltPid.ti(600);
+    hltPid.td(60);
+    hltPid.enabled(true);
+
+    auto offset = std::make_shared<ActuatorOffset>([hltPair]() { return hltPair; }, [mashPair]() { return mashPair; });
+    auto mashPid = Pid([mashPair]() { return mashPair; }, [offset]() { return offset; });
+    mashPid.kp(5);
+    mashPid.ti(1800);
+    mashPid.td(0);
+    mashPid.enabled(true);
+
+    ThermalPlant hlt([hltSensor]() { return hltSensor; }, 64, tickInterval);
+    hlt.inputs({{[&element]() { return element.power; }, 60}});
+    hlt.ambient(20);
+    hlt.lossRate(0.1);
+    hlt.deadTime(20000);
+
+    ThermalPlant mash([mashSensor]() { return mashSensor; }, 64, tickInterval);
+    mash.lossRate(1.5);
+    mash.deadTime(60000);
+
+    LoopRecorder recorder("herms-mash", 0.5, {[&element]() { return element.state(); }});
+    for (ticks_millis_t now = 0; now <= 2 * hour; now += tickInterval) {
+        if (now == 0) {
+            mashPair->setting(66);
+        } else if (now == hour) {
+            mashPair->setting(72);
+        } else if (now == hour + hour / 2) {
+            mashPair->setting(78);
+        }
+        mash.ambient(hlt.temperature());
+        hlt.update(now);
+        mash.update(now);
+        recorder.timeUpdate([&]() {
+            if (now % controlInterval == 0) {
+                hltPair->update();
+                mashPair->update();
+                mashPid.update();
+                offset->update();
+                hltPid.update();
+            }
+            element.update(now);
+        });
+        recorder.sample(now, toDouble(mashPair->setting()), toDouble(mash.temperature()));
+    }
+    return recorder.finish();
+}
+
+// Boil kettle: once the setpoint is at the boil point, the PID keeps the element at least at boilMinOutput
+LoopMetrics
+benchBoil()
+{
+    auto io = std::make_shared<MockIoArray>();
+    auto sensor = std::make_shared<TempSensorMock>(60);
+    auto pair = std::make_shared<SetpointSensorPair>([sensor]() { return sensor; });
+    pair->setting(100);
+    pair->settingValid(true);
+
+    PwmOutput element(io, 1, 4000);
+    auto pid = Pid([pair]() { return pair; }, [&element]() { return element.pwm; });
+    pid.kp(50);
+    pid.ti(0);
+    pid.td(0);
+    pid.boilMinOutput(60);
+    pid.enabled(true);
+
+    ThermalPlant kettle([sensor]() { return sensor; }, 60, tickInterval);
+    kettle.inputs({{[&element]() { return element.power; }, 50}});
+    kettle.ambient(20);
+    kettle.lossRate(0.3);
+    kettle.maxTemperature(100);
+    kettle.deadTime(10000);
+
+    LoopRecorder recorder("boil", 0.5, {[&element]() { return element.state(); }});
+    for (ticks_millis_t now = 0; now <= 2 * hour; now += tickInterval) {
+        kettle.update(now);
+        recorder.timeUpdate([&]() {
+            if (now % controlInterval == 0) {
+                pair->update();
+                pid.update();
+            }
+            element.update(now);
+        });
+        recorder.sample(now, toDouble(pair->setting()), toDouble(kettle.temperature()));
+    }
+    return recorder.finish();
+}
+
+// A fermenter with a heater and a compressor cooler that share a mutex. The cooler has minimum on and off times.
+LoopMetrics
+benchMutexedHeaterCooler()
+{
+    auto io = std::make_shared<MockIoArray>();
+    auto sensor = std::make_shared<TempSensorMock>(20);
+    auto pair = std::make_shared<SetpointSensorPair>([sensor]() { return sensor; });
+    pair->setting(20);
+    pair->settingValid(true);
+
+    auto mutex = std::make_shared<MutexTarget>();
+    PwmOutput heater(io, 1, 60000);
+    PwmOutput cooler(io, 2, 1800000);
+    heater.constrained->addConstraint(std::make_unique<ADConstraints::Mutex<3>>([mutex]() { return mutex; }, 900000, true));
+    cooler.constrained->addConstraint(std::make_unique<ADConstraints::MinOffTime<1>>(300000));
+    cooler.constrained->addConstraint(std::make_unique<ADConstraints::MinOnTime<2>>(180000));
+    cooler.constrained->addConstraint(std::make_unique<ADConstraints::Mutex<3>>([mutex]() { return mutex; }, 900000, true));
+
+    auto heatPid = Pid([pair]() { return pair; }, [&heater]() { return heater.pwm; });
+    heatPid.kp(20);
+    heatPid.ti(7200);
+    heatPid.td(1800);
+    heatPid.enabled(true);
+
+    auto coolPid = Pid([pair]() { return pair; }, [&cooler]() { return cooler.pwm; });
+    coolPid.kp(-20);
+    coolPid.ti(7200);
+    coolPid.td(1800);
+    coolPid.enabled(true);
+
+    ThermalPlant plant([sensor]() { return sensor; }, 20, tickInterval);
+    plant.inputs({
+        {[&heater]() { return heater.power; }, 4},
+        {[&cooler]() { return cooler.power; }, -6},
+    });
+    plant.ambient(24);
+    plant.lossRate(0.3);
+    plant.deadTime(600000);
+
+    LoopRecorder recorder("mutexed-heater-cooler", 0.3, {
+                                                            [&heater]() { return heater.state(); },
+                                                            [&cooler]() { return cooler.state(); },
+                                                        });
+    for (ticks_millis_t now = 0; now <= 36 * hour; now += tickInterval) {
+        if (now == 12 * hour) {
+            pair->setting(18);
+        } else if (now == 24 * hour) {
+            pair->setting(21);
+        }
+        plant.update(now);
+        recorder.timeUpdate([&]() {
+            if (now % controlInterval == 0) {
+                pair->update();
+                heatPid.update();
+                coolPid.update();
+            }
+            heater.update(now);
+            cooler.update(now);
+        });
+        recorder.sample(now, toDouble(pair->setting()), toDouble(plant.temperature()));
+    }
+    return recorder.finish();
+}
+
+void
+writeJson(std::ostream& out, const std::vector<LoopMetrics>& results)
+{
+    out << std::setprecision(6) << "{\n  \"scenarios\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& m = results[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\n"
+            << "      \"name\": \"" << m.scenario << "\",\n"
+            << "      \"hours\": " << m.hours << ",\n"
+            << "      \"iae\": " << m.iae << ",\n"
+            << "      \"ise\": " << m.ise << ",\n"
+            << "      \"overshoot\": " << m.overshoot << ",\n"
+            << "      \"settling_time_s\": " << m.settlingTime << ",\n"
+            << "      \"toggles_per_hour\": " << m.togglesPerHour << ",\n"
+            << "      \"ns_per_update\": " << m.nsPerUpdate << "\n"
+            << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
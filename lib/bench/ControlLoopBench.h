@@ -0,0 +1,102 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ActuatorDigitalBase.h"
+#include "TicksTypes.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Scores of a control loop over one simulated scenario
+struct LoopMetrics {
+    std::string scenario;
+    double hours = 0;          // simulated duration
+    double iae = 0;            // integrated absolute error, degree hours
+    double ise = 0;            // integrated squared error, degree^2 hours
+    double overshoot = 0;      // largest overshoot after a setpoint change, degrees
+    double settlingTime = 0;   // longest time after a setpoint change until the error stays within the band, seconds
+    double togglesPerHour = 0; // state changes of all digital actuators
+    double nsPerUpdate = 0;    // CPU time of one control loop update, excluding the simulated plant
+};
+
+/*
+ * Records the setpoint, the process value and the actuator states of a scenario and calculates the metrics.
+ * Each setpoint change starts a new segment, for which overshoot and settling time are determined.
+ */
+class LoopRecorder {
+public:
+    using State = ActuatorDigitalBase::State;
+
+private:
+    struct Segment {
+        ticks_millis_t start;
+        double setpoint;
+        double direction; // 1 for a step up, -1 for a step down, 0 for the initial setpoint
+        double overshoot;
+        ticks_millis_t lastOutsideBand;
+    };
+
+    LoopMetrics m_metrics;
+    double m_band;
+    std::vector<std::function<State()>> m_actuators;
+    std::vector<State> m_lastStates;
+    uint32_t m_toggles = 0;
+    std::vector<Segment> m_segments;
+    ticks_millis_t m_lastSample = 0;
+    std::chrono::nanoseconds m_cpuTime{0};
+    uint32_t m_updates = 0;
+
+public:
+    LoopRecorder(std::string scenario, double band, std::vector<std::function<State()>>&& actuators);
+
+    // add a sample of the setpoint and the value, should be called at a fixed interval
+    void sample(ticks_millis_t now, double setpoint, double value);
+
+    // time a control loop update
+    template <typename F>
+    void timeUpdate(F&& update)
+    {
+        auto start = std::chrono::steady_clock::now();
+        update();
+        m_cpuTime += std::chrono::steady_clock::now() - start;
+        ++m_updates;
+    }
+
+    LoopMetrics finish();
+};
+
+LoopMetrics
+benchFermenterStep();
+
+LoopMetrics
+benchHermsMash();
+
+LoopMetrics
+benchBoil();
+
+LoopMetrics
+benchMutexedHeaterCooler();
+
+void
+writeJson(std::ostream& out, const std::vector<LoopMetrics>& results);
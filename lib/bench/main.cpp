@@ -0,0 +1,80 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Runs control loop scenarios against simulated plants and reports how well they are controlled.
+ * Usage: lib_bench_runner [output.json]
+ * The results are printed as a table and written as JSON, by default to build/control-loop-bench.json.
+ */
+
+#include "ControlLoopBench.h"
+#include "Logger.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+Logger&
+logger()
+{
+    static auto logger = Logger([](Logger::LogLevel, const char* log) {
+        std::cerr << "LOG: " << log << std::endl;
+    });
+    return logger;
+}
+
+int
+main(int argc, char* argv[])
+{
+    const char* outputPath = argc > 1 ? argv[1] : "build/control-loop-bench.json";
+
+    std::vector<LoopMetrics> results;
+    results.push_back(benchFermenterStep());
+    results.push_back(benchHermsMash());
+    results.push_back(benchBoil());
+    results.push_back(benchMutexedHeaterCooler());
+
+    std::cout << std::left << std::setw(24) << "scenario"
+              << std::right << std::setw(8) << "hours"
+              << std::setw(10) << "IAE"
+              << std::setw(10) << "ISE"
+              << std::setw(11) << "overshoot"
+              << std::setw(12) << "settling s"
+              << std::setw(12) << "toggles/h"
+              << std::setw(12) << "ns/update" << std::endl;
+    for (const auto& m : results) {
+        std::cout << std::left << std::setw(24) << m.scenario
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(8) << m.hours
+                  << std::setw(10) << m.iae
+                  << std::setw(10) << m.ise
+                  << std::setw(11) << m.overshoot
+                  << std::setw(12) << std::setprecision(0) << m.settlingTime
+                  << std::setw(12) << std::setprecision(1) << m.togglesPerHour
+                  << std::setw(12) << std::setprecision(0) << m.nsPerUpdate << std::endl;
+    }
+
+    std::ofstream out(outputPath);
+    if (!out) {
+        std::cerr << "Could not write results to " << outputPath << std::endl;
+        return 1;
+    }
+    writeJson(out, results);
+    std::cout << "Results written to " << outputPath << std::endl;
+    return 0;
+}
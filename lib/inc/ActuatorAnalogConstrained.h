@@ -145,9 +145,14 @@ public:
 
     void update()
     {
+        auto oldValue = actuator.value();
+        auto oldValid = actuator.valueValid();
         if (actuator.settingValid()) {
             setting(m_desiredSetting); // re-apply constraints
         }
+        if (actuator.value() != oldValue || actuator.valueValid() != oldValid) {
+            m_changes.notify();
+        }
     }
 
     virtual value_t
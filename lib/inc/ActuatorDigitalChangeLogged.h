@@ -21,17 +21,17 @@
 
 #include "ActuatorDigitalBase.h"
 #include "TicksTypes.h"
-#include <algorithm>
 #include <array>
 #include <cstdint>
 /*
  * An ActuatorDigitalBase wrapper that logs the most recent changes
+ *
+ * The changes are kept in a ring buffer, newest first. The durations used by PWM and the last start and end time of
+ * each state are updated when a change is logged, so the queries by PWM and constraints don't need to scan the history.
  */
 
-// uneven length makes last entry equal to first for toggling (PWM) behavior
-const uint8_t historyLength = 5;
-
-class ActuatorDigitalChangeLogged {
+template <uint8_t length>
+class ActuatorDigitalChangeLog {
 public:
     using State = ActuatorDigitalBase::State;
 
@@ -40,20 +40,135 @@ public:
         ticks_millis_t startTime;
     };
 
+    struct StartEndTime {
+        ticks_millis_t start;
+        ticks_millis_t end;
+    };
+
+    struct ActiveDurations {
+        ticks_millis_t currentActive;
+        ticks_millis_t currentPeriod;
+        ticks_millis_t previousActive;
+        ticks_millis_t previousPeriod;
+    };
+
+    static_assert(length >= 2, "history should hold at least the current and previous state");
+
 private:
+    static constexpr uint8_t numStates = 3;
+    static constexpr uint8_t noSlot = 0xFF;
+    static constexpr uint8_t numGroups = 3;
+
     ActuatorDigitalBase& actuator;
-    std::array<StateChange, historyLength> history;
+    std::array<StateChange, length> history;
+    uint8_t head = 0;                        // slot of the newest change
+    std::array<uint8_t, numStates> lastSlot; // slot of the newest change to each state
+
+    // The periods are bounded by the changes to Active. Kept for the three newest, newest first.
+    std::array<uint8_t, numGroups> activeSlot;
+    // Summed durations of the other changes newer than activeSlot[0], between [0] and [1] and between [1] and [2].
+    // Only closed durations are included, the time since the newest change is added when the durations are requested.
+    std::array<ticks_millis_t, numGroups> otherDurations;
+
+    // the n-th newest change
+    const StateChange& entry(uint8_t n) const
+    {
+        return history[(head + n) % length];
+    }
+
+    // time until the next newer change, 0 for the newest change
+    ticks_millis_t closedDuration(uint8_t slot) const
+    {
+        if (slot == noSlot || slot == head) {
+            return 0;
+        }
+        return history[(slot + length - 1) % length].startTime - history[slot].startTime;
+    }
+
+    // number of changes to Active newer than a change, which is the group that its duration is summed in
+    uint8_t activeCount() const
+    {
+        uint8_t count = 0;
+        while (count < numGroups && activeSlot[count] != noSlot) {
+            ++count;
+        }
+        return count;
+    }
+
+    void indexStates()
+    {
+        lastSlot.fill(noSlot);
+        activeSlot.fill(noSlot);
+        otherDurations.fill(0);
+        uint8_t group = 0;
+        for (uint8_t n = 0; n < length; ++n) {
+            auto slot = uint8_t((head + n) % length);
+            auto s = history[slot].newState;
+            if (s < numStates && lastSlot[s] == noSlot) {
+                lastSlot[s] = slot;
+            }
+            if (group >= numGroups) {
+                continue;
+            }
+            if (s == State::Active) {
+                activeSlot[group++] = slot;
+            } else {
+                otherDurations[group] += closedDuration(slot);
+            }
+        }
+    }
+
+    // Adds a change in constant time: only the oldest change, the previous newest change and the new change affect
+    // the durations.
+    void push(const StateChange& change)
+    {
+        auto slot = uint8_t((head + length - 1) % length);
+        // the oldest change is overwritten
+        auto& evicted = history[slot];
+        if (evicted.newState < numStates && lastSlot[evicted.newState] == slot) {
+            lastSlot[evicted.newState] = noSlot;
+        }
+        auto count = activeCount();
+        if (evicted.newState == State::Active) {
+            if (count > 0 && activeSlot[count - 1] == slot) {
+                activeSlot[count - 1] = noSlot;
+            }
+        } else if (count < numGroups) {
+            otherDurations[count] -= closedDuration(slot);
+        }
+
+        // the previous newest change gets its duration
+        const auto& front = history[head];
+        if (front.newState != State::Active) {
+            otherDurations[0] += change.startTime - front.startTime;
+        }
+
+        head = slot;
+        evicted = change;
+        if (change.newState < numStates) {
+            lastSlot[change.newState] = head;
+        }
+        if (change.newState == State::Active) {
+            // start of a new period, the oldest group is dropped
+            for (uint8_t g = numGroups - 1; g > 0; --g) {
+                activeSlot[g] = activeSlot[g - 1];
+                otherDurations[g] = otherDurations[g - 1];
+            }
+            activeSlot[0] = head;
+            otherDurations[0] = 0;
+        }
+    }
 
 protected:
     ticks_millis_t lastUpdateTime = 0;
 
 public:
-    ActuatorDigitalChangeLogged(ActuatorDigitalBase& act)
+    ActuatorDigitalChangeLog(ActuatorDigitalBase& act)
         : actuator(act)
     {
         resetHistory();
     }
-    ~ActuatorDigitalChangeLogged() = default;
+    ~ActuatorDigitalChangeLog() = default;
 
     void state(const State& val, const ticks_millis_t& now)
     {
@@ -76,97 +191,65 @@ public:
         return actuator.state();
     }
 
+    // state of the newest logged change
+    State loggedState() const
+    {
+        return entry(0).newState;
+    }
+
     void update(const ticks_millis_t& now)
     {
-        if (state() != history.front().newState) {
-            std::rotate(history.rbegin(), history.rbegin() + 1, history.rend());
-            history[0] = {state(), now};
+        if (state() != entry(0).newState) {
+            push({state(), now});
         }
         lastUpdateTime = now;
     }
 
-    auto getLastStartEndTime(const State& state, const ticks_millis_t& now) const
+    StartEndTime getLastStartEndTime(const State& state, const ticks_millis_t& now) const
     {
-        struct {
-            ticks_millis_t start;
-            ticks_millis_t end;
-        } result;
+        // the newest change to the state ends now when it is still active, otherwise as far in the past as possible
+        auto openEnd = (actuator.state() == state) ? now : now + 1;
 
-        result.start = now + 1;
-        result.end = (actuator.state() == state) ? now : now + 1;
-
-        ticks_millis_t end = result.end;
-        for (const auto& h : history) {
-            if (h.newState == state) {
-                result.start = h.startTime;
-                result.end = end;
-                break;
-            }
-            end = h.startTime;
+        auto slot = state < numStates ? lastSlot[state] : noSlot;
+        if (slot == noSlot) {
+            return {now + 1, openEnd};
         }
-        return result;
+        if (slot == head) {
+            return {history[slot].startTime, openEnd};
+        }
+        return {history[slot].startTime, history[(slot + length - 1) % length].startTime};
     }
 
-    auto activeDurations(const ticks_millis_t& now)
-    {
-        struct {
-            ticks_millis_t currentActive;
-            ticks_millis_t currentPeriod;
-            ticks_millis_t previousActive;
-            ticks_millis_t previousPeriod;
-        } result;
-
-        result.currentActive = 0;
-        result.currentPeriod = 0;
-        result.previousActive = 0;
-        result.previousPeriod = 0;
-        auto end = now;
-        auto start = ticks_millis_t(0);
-        //auto minStartTime = now - maxHistory;
-        uint8_t activePeriods = 0;
-
-        auto h = history.cbegin();
-        for (; h < history.cend(); ++h) {
-            start = h->startTime;
-            auto duration = end - start;
-            end = start;
-            if (h->newState == State::Active) {
-                ++activePeriods;
-                if (activePeriods == 1) {
-                    result.currentActive = duration;
-                    result.currentPeriod += duration;
-                } else if (activePeriods == 2) {
-                    result.previousActive = duration;
-                    result.previousPeriod += duration;
-                } else {
-                    break;
-                }
-            } else {
-                if (history.front().newState == State::Inactive) {
-                    if (activePeriods == 0) {
-                        result.currentPeriod += duration;
-                    } else if (activePeriods <= 1) {
-                        result.previousPeriod += duration;
-                    } else {
-                        break;
-                    }
-                } else {
-                    if (activePeriods <= 1) {
-                        result.currentPeriod += duration;
-                    } else {
-                        result.previousPeriod += duration;
-                    }
-                }
-            }
+    ActiveDurations activeDurations(const ticks_millis_t& now) const
+    {
+        ActiveDurations result;
+        result.currentActive = closedDuration(activeSlot[0]);
+        result.previousActive = closedDuration(activeSlot[1]);
+        if (entry(0).newState == State::Inactive) {
+            // the current period is the newest active time and the inactive time after it
+            result.currentPeriod = otherDurations[0] + result.currentActive;
+            result.previousPeriod = otherDurations[1] + result.previousActive;
+        } else {
+            // the current period is the newest active time and the inactive time before it
+            result.currentPeriod = otherDurations[0] + result.currentActive + otherDurations[1];
+            result.previousPeriod = result.previousActive + otherDurations[2];
         }
 
+        const auto& front = entry(0);
+        auto sinceChange = now - front.startTime;
+        result.currentPeriod += sinceChange;
+        if (front.newState == State::Active) {
+            result.currentActive += sinceChange;
+        }
         return result;
     }
 
     void resetHistory()
     {
         history.fill(StateChange{State::Unknown, ticks_millis_t(-1)});
+        head = 0;
         history[0] = {actuator.state(), 0};
+        indexStates();
         lastUpdateTime = 0;
     }
 
@@ -175,3 +258,17 @@ public:
         return actuator.supportsFastIo();
     }
 };
+
+template <uint8_t length>
+constexpr uint8_t ActuatorDigitalChangeLog<length>::numStates;
+
+template <uint8_t length>
+constexpr uint8_t ActuatorDigitalChangeLog<length>::noSlot;
+
+template <uint8_t length>
+constexpr uint8_t ActuatorDigitalChangeLog<length>::numGroups;
+
+// uneven length makes last entry equal to first for toggling (PWM) behavior
+const uint8_t historyLength = 5;
+
+using ActuatorDigitalChangeLogged = ActuatorDigitalChangeLog<historyLength>;
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "ActuatorDigitalChangeLogged.h"
+#include "ChangeNotifier.h"
 #include "TicksTypes.h"
 #include <algorithm>
 #include <functional>
@@ -42,6 +43,14 @@ public:
 
     virtual uint8_t order() const = 0;
 
+    // A predictable constraint that blocks a transition keeps blocking it until the wait it returned has passed,
+    // as long as the desired and actual state don't change. Its result can be cached until then.
+    // Constraints that depend on other actuators can be unblocked earlier and should return false.
+    virtual bool predictable() const
+    {
+        return true;
+    }
+
     void timeRemaining(duration_millis_t v)
     {
         m_timeRemaining = v;
@@ -71,6 +80,20 @@ private:
     std::vector<std::unique_ptr<Constraint>> constraints;
     State m_desiredState = State::Inactive;
 
+    // Earliest time the desired state can be allowed, when it is blocked by a predictable constraint.
+    // Until then, the constraints are not evaluated again for the same desired and actual state.
+    Constraint* m_blockedBy = nullptr;
+    ticks_millis_t m_allowedAt = 0;
+    State m_blockedDesired = State::Unknown;
+    State m_blockedActual = State::Unknown;
+
+    duration_millis_t pollInterval() const
+    {
+        return supportsFastIo() ? 0 : slowIoPollInterval();
+    }
+
+    ChangeNotifier m_changes;
+
 public:
     ActuatorDigitalConstrained(ActuatorDigitalBase& act)
         : ActuatorDigitalChangeLogged(act)
@@ -96,6 +119,7 @@ public:
         if (constraints.size() < 8) {
             constraints.push_back(std::move(newConstraint));
         }
+        m_blockedBy = nullptr;
         std::sort(constraints.begin(), constraints.end(),
                   [](const std::unique_ptr<Constraint>& a, const std::unique_ptr<Constraint>& b) { return a->order() < b->order(); });
     }
@@ -105,19 +129,36 @@ public:
     {
         auto oldConstraints = std::move(constraints);
         constraints = std::vector<std::unique_ptr<Constraint>>();
+        m_blockedBy = nullptr;
         return oldConstraints;
     }
 
     void resetHistory()
     {
         ActuatorDigitalChangeLogged::resetHistory();
+        m_blockedBy = nullptr;
     }
 
     duration_millis_t checkConstraints(const State& val, const ticks_millis_t& now)
     {
+        if (m_blockedBy && val == m_blockedDesired && state() == m_blockedActual) {
+            auto wait = int32_t(m_allowedAt - now);
+            if (wait > 0) {
+                m_blockedBy->timeRemaining(wait);
+                return wait;
+            }
+        }
+        m_blockedBy = nullptr;
+
         for (auto& c : constraints) {
             auto remaining = c->allowed(val, now, *this);
             if (remaining > 0) {
+                if (c->predictable()) {
+                    m_blockedBy = c.get();
+                    m_allowedAt = now + remaining;
+                    m_blockedDesired = val;
+                    m_blockedActual = state();
+                }
                 return remaining;
             }
         }
@@ -127,10 +168,16 @@ public:
     duration_millis_t desiredState(const State& val, const ticks_millis_t& now)
     {
         lastUpdateTime = now; // always update fallback time for state setter without time
+        bool changed = val != m_desiredState;
         m_desiredState = val;
         auto timeRemaining = checkConstraints(val, now);
         if (timeRemaining == 0) {
+            auto oldState = loggedState();
             ActuatorDigitalChangeLogged::state(val, now);
+            changed = changed || loggedState() != oldState;
+        }
+        if (changed) {
+            m_changes.notify();
         }
         return timeRemaining;
     }
@@ -145,11 +192,28 @@ public:
         return ActuatorDigitalChangeLogged::state();
     }
 
+    // minimum update interval while polling an unpredictable constraint, when each update does bus I/O
+    static constexpr duration_millis_t slowIoPollInterval()
+    {
+        return 100;
+    }
+
+    // Re-apply the desired state and return the time until the next update is needed.
+    // When a transition is blocked by a predictable constraint, this is the time it can be allowed.
+    // Unpredictable constraints, like a mutex, are evaluated on every update,
+    // or every slowIoPollInterval() for actuators on a bus.
+    // Otherwise, update at least once per second.
     duration_millis_t update(const ticks_millis_t& now)
     {
-        // re-apply constraints for new update time
         auto remaining = desiredState(m_desiredState, now);
-        // update at least once per second
+        if (remaining == 0) {
+            bool predictable = std::all_of(constraints.cbegin(), constraints.cend(),
+                                           [](const std::unique_ptr<Constraint>& c) { return c->predictable(); });
+            return predictable ? 1000 : pollInterval();
+        }
+        if (!m_blockedBy) {
+            return pollInterval();
+        }
         return (remaining < 1000) ? remaining : 1000;
     }
 
@@ -164,6 +228,12 @@ public:
     {
         return constraints;
     }
+
+    // listeners are notified when the desired or the actual state changes
+    ChangeNotifier& changes()
+    {
+        return m_changes;
+    }
 };
 
 class MutexTarget {
@@ -464,6 +534,12 @@ public:
         return bool(m_lock);
     }
 
+    // the mutex can be released earlier by the other actuator
+    virtual bool predictable() const override final
+    {
+        return false;
+    }
+
     virtual uint8_t
     id() const override final
     {
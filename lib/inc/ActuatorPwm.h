@@ -58,10 +58,12 @@ private:
     // separate flag for manually disabling the pwm actuator
     bool m_enabled = true;
 
-#if PLATFORM_ID != PLATFORM_GCC
+    // target of the timer task, resolved in the main loop. Not owned, so a deleted target block is not kept alive by the timer
+    std::weak_ptr<ActuatorDigitalConstrained> m_fastTarget;
     uint8_t timerFuncId = 0;
     duration_millis_t m_fastPwmElapsed = 0;
-#endif
+
+    static void timerTaskHandler(void* pwm);
 
 public:
     /** Constructor.
@@ -115,16 +117,12 @@ public:
      */
     update_t slowPwmUpdate(const update_t& now);
 
-#if PLATFORM_ID != PLATFORM_GCC
-    update_t fastUpdate(const update_t& now);
-
     /**
     When the period is less than 1000ms, switch to timer interrupt based tasks
     */
     void timerTask();
 
     void manageTimerTask();
-#endif
 
     /** returns the PWM period
      * @return PWM period in seconds
@@ -153,8 +151,6 @@ public:
             settingValid(false);
         }
         m_enabled = v;
-#if PLATFORM_ID != PLATFORM_GCC
         manageTimerTask();
-#endif
     }
 };
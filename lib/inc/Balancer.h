@@ -21,7 +21,9 @@
 
 #include "ActuatorAnalog.h"
 #include "ActuatorAnalogConstrained.h"
+#include "FixedPoint.h"
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <vector>
 
@@ -33,7 +35,11 @@ class Balanced;
 class BalancerImpl {
 public:
     using value_t = ActuatorAnalog::value_t;
-    BalancerImpl() = default;
+    using total_t = safe_elastic_fixed_point<16, 12>; // sum of requests, does not saturate for all requesters at 100
+    BalancerImpl()
+    {
+        m_index.fill(noEntry);
+    }
     virtual ~BalancerImpl() = default;
 
     struct Request {
@@ -42,10 +48,32 @@ public:
         value_t granted;
     };
 
+    static constexpr uint8_t maxRequesters = 254; // ids 1-254
+
     const value_t available = 100;
 
+private:
+    static constexpr uint8_t noEntry = 0xFF;
+
+    // requests in order of registration, indexed by requester id through m_index
     std::vector<Request> requesters;
+    std::array<uint8_t, 256> m_index; // position in requesters for each possible id
+    total_t m_requestedTotal = 0;
+    bool m_changed = false; // requests changed since the last update
+
+    Request* find(const uint8_t& requester_id)
+    {
+        auto idx = m_index[requester_id];
+        return idx == noEntry ? nullptr : &requesters[idx];
+    }
+
+    const Request* find(const uint8_t& requester_id) const
+    {
+        auto idx = m_index[requester_id];
+        return idx == noEntry ? nullptr : &requesters[idx];
+    }
 
+public:
     uint8_t registerEntry();
 
     void unregisterEntry(const uint8_t& requester_id);
@@ -54,6 +82,7 @@ public:
 
     value_t granted(const uint8_t& requester_id) const;
 
+    // recalculate the granted values, when the requests have changed
     void update();
 
     const std::vector<Request>& clients() const
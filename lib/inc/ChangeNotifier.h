@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/*
+ * Notifies subscribed listeners that a value has changed, so they don't have to poll it.
+ *
+ * Listeners are held by weak pointer: a listener that is destroyed is removed on the next notification,
+ * without having to unsubscribe. Subscribing the same listener again has no effect.
+ */
+class ChangeNotifier {
+public:
+    using Listener = std::function<void()>;
+
+    void subscribe(const std::shared_ptr<Listener>& listener)
+    {
+        auto subscribed = std::find_if(m_listeners.cbegin(), m_listeners.cend(), [&listener](const std::weak_ptr<Listener>& l) {
+            return l.lock() == listener;
+        });
+        if (subscribed == m_listeners.cend()) {
+            m_listeners.push_back(listener);
+        }
+    }
+
+    void notify()
+    {
+        // iterate by index, a listener can subscribe while it is notified
+        for (size_t i = 0; i < m_listeners.size();) {
+            if (auto listener = m_listeners[i].lock()) {
+                (*listener)();
+                ++i;
+            } else {
+                m_listeners.erase(m_listeners.begin() + i);
+            }
+        }
+    }
+
+    size_t listeners() const
+    {
+        return m_listeners.size();
+    }
+
+private:
+    std::vector<std::weak_ptr<Listener>> m_listeners;
+};
@@ -24,6 +24,7 @@
 
 #include "IoArray.h"
 #include "OneWireDevice.h"
+#include "OneWirePolling.h"
 
 #define DS2408_FAMILY_ID 0x29
 
@@ -49,6 +50,9 @@ private:
 
     } m_regCache;
 
+    bool m_deferWrites = false;
+    OneWirePolling m_polling; // when update() is called, demanded by the channel reads and writes
+
     static const uint8_t READ_PIO_REG = 0xF0;
     static const uint8_t ACCESS_READ = 0xF5;
     static const uint8_t ACCESS_WRITE = 0x5A;
@@ -110,7 +114,8 @@ private:
     }
 
     /**
-     * Set all output latches to correct state based on channel config
+     * Set all output latches to correct state based on channel config.
+     * The write is skipped when the device is known to have these latches already.
      * @return true on success
      */
     bool updateLatches()
@@ -120,6 +125,10 @@ private:
             newLatches = setBit(newLatches, i, channels[i].config != ChannelConfig::ACTIVE_HIGH);
         }
 
+        if (connected() && newLatches == m_regCache.latch) {
+            return true;
+        }
+
         bool success = accessWrite(newLatches);
         if (success) {
             m_regCache.latch = newLatches;
@@ -137,6 +146,7 @@ private:
 
     /**
      * Writes the state of all PIOs in one operation.
+     * The write is verified with the PIO state the device sends after the confirmation: pins with an enabled latch must be low.
      * @param latches pio data - a bit field with new values for the output latch
      * @param maxTries the maximum number of attempts before giving up.
      * @return true on success
@@ -151,9 +161,20 @@ private:
 public:
     void update() const;
 
+    OneWirePolling& polling()
+    {
+        return m_polling;
+    }
+
+    const OneWirePolling& polling() const
+    {
+        return m_polling;
+    }
+
     // generic ArrayIo interface
     virtual bool senseChannelImpl(uint8_t channel, State& result) const override final
     {
+        m_polling.demand();
         if (connected() && validChannel(channel)) {
             bool pioState = getBit(m_regCache.pio, channel - 1);
             if (pioState == false) {
@@ -170,6 +191,7 @@ public:
     virtual bool writeChannelImpl(uint8_t channel, const ChannelConfig&) override final
     {
         // second argument is not used, already set by caller and used in updateLatches
+        m_polling.demand();
         if (connected() && validChannel(channel)) {
             updateLatches();
             return true;
@@ -177,6 +199,52 @@ public:
         return false;
     }
 
+    // all staged channels are written with a single latch write
+    virtual bool writeChannelsImpl(uint32_t) override final
+    {
+        m_polling.demand();
+        if (connected()) {
+            return updateLatches();
+        }
+        return false;
+    }
+
+    /**
+     * While writes are deferred, channel writes are held until flushWrites().
+     * The channels that several actuators change in one pass of the main loop are then written with a single latch write.
+     */
+    void deferWrites(bool defer)
+    {
+        if (defer == m_deferWrites) {
+            return;
+        }
+        m_deferWrites = defer;
+        if (defer) {
+            beginWrites();
+        } else {
+            commitWrites();
+        }
+    }
+
+    bool deferWrites() const
+    {
+        return m_deferWrites;
+    }
+
+    /**
+     * Write the deferred channels to the device and keep deferring new writes.
+     * @return false if writing the channels failed
+     */
+    bool flushWrites()
+    {
+        if (!m_deferWrites) {
+            return true;
+        }
+        bool success = commitWrites();
+        beginWrites();
+        return success;
+    }
+
     virtual bool supportsFastIo() const override final
     {
         return false;
@@ -23,6 +23,7 @@
 #include "IoArray.h"
 #include "Logger.h"
 #include "OneWireDevice.h"
+#include "OneWirePolling.h"
 #include <inttypes.h>
 
 #define DS2413_FAMILY_ID 0x3A
@@ -44,6 +45,7 @@ private:
     };
 
     mutable uint8_t m_cachedState; // last value of read
+    OneWirePolling m_polling;      // when update() is called, demanded by the channel reads and writes
     static const uint8_t ACCESS_READ = 0xF5;
     static const uint8_t ACCESS_WRITE = 0x5A;
     static const uint8_t ACK_SUCCESS = 0xAA;
@@ -110,6 +112,16 @@ public:
      * Return cached state. Upper nibble is equal to lower nibble if valid
      */
 
+    OneWirePolling& polling()
+    {
+        return m_polling;
+    }
+
+    const OneWirePolling& polling() const
+    {
+        return m_polling;
+    }
+
     uint8_t latches() const
     {
         bool A = 0;
@@ -187,6 +199,7 @@ private:
     // generic ArrayIO interface
     virtual bool senseChannelImpl(uint8_t channel, State& result) const override final
     {
+        m_polling.demand();
         if (connected() && validChannel(channel)) {
             bool isPulledDown;
             bool success = sense(Pio(channel), isPulledDown);
@@ -202,6 +215,7 @@ private:
 
     virtual bool writeChannelImpl(uint8_t channel, const ChannelConfig& config) override final
     {
+        m_polling.demand();
         if (connected() && validChannel(channel)) {
             bool latchEnabled = config == ChannelConfig::ACTIVE_HIGH;
             return writeLatchBit(Pio(channel), latchEnabled);
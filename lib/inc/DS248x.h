@@ -78,6 +78,15 @@ public:
     virtual void write_bit(uint8_t bit) override final;
     virtual uint8_t read_bit() override final;
 
+    // split phase operations: the DS248x executes them while the main loop continues
+    virtual bool busy() override final;
+    virtual void startReset() override final;
+    virtual bool presence() override final;
+    virtual void startWrite(uint8_t b) override final;
+    virtual void startRead() override final;
+    virtual uint8_t readResult() override final;
+    virtual bool failed() override final;
+
     // DS248X specific functions below
 
     void resetMaster();
@@ -106,6 +115,8 @@ public:
 private:
     uint8_t mAddress;
     uint8_t mTimeout;
+    uint8_t mStatus = 0;     // status read by the last busy() call
+    bool mI2cError = false; // the last read from the DS248x got no data
     uint8_t readByte();
     void setReadPtr(uint8_t readPtr);
 
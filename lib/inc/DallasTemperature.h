@@ -214,6 +214,7 @@ public:
     int16_t getTemp(const uint8_t* address) { return getTempRaw(address); }
 
     int16_t getTempRaw(const uint8_t* deviceAddress); // changed return type from uint32 to int16 (Elco, BrewPi)
+    int16_t getTempRaw(const uint8_t* deviceAddress, const uint8_t* scratchPad); // from a scratchpad that is already read
 
 #if REQUIRESTEMPCONVERSION
     // returns temperature in degrees C
@@ -348,7 +349,7 @@ private:
     OneWire* _wire;
 
     // reads scratchpad and returns the raw temperature
-    int16_t calculateTemperature(const uint8_t*, uint8_t*);
+    int16_t calculateTemperature(const uint8_t*, const uint8_t*);
 
 #if REQUIRESWAITFORCONVERSION
     int16_t millisToWaitForConversion(uint8_t);
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "ChangeNotifier.h"
+#include "IirFilter.h"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/*
+ * A bank of filter chains with the configuration of FpFilterChain, for many channels.
+ *
+ * The stages are a constant table, so the bank has no per stage data on the heap.
+ * Channels are allocated in chunks of a fixed size. Adding a chunk does not move the existing channels,
+ * so the heap only grows by one chunk at a time.
+ *
+ * The history of a channel in each stage is a ring buffer with its own head. A step moves the heads of the channels
+ * that receive a value in a stage, the history of the other channels is not touched.
+ *
+ * Values added to a channel are pending until the next step. A step only advances the channels with a pending value,
+ * so each channel gives exactly the same results as a FilterChain with the same configuration.
+ * The bank is stepped by its owner, once per pass after all channels have added their value.
+ * Reading a channel through FpFilterBankChannel steps the bank first when the channel has a pending value,
+ * so a value is never read one pass late. A bank without an owner can step on each add instead.
+ */
+class FilterBank {
+public:
+    using channel_t = uint16_t;
+    static constexpr channel_t chunkSize = 4;
+
+    struct Stage {
+        uint8_t param;    // index of the filter definition
+        uint8_t interval; // number of inputs per output of the stage
+    };
+
+    static constexpr uint8_t numStages = 6;
+    static constexpr Stage stages[numStages] = {{0, 2}, {2, 2}, {2, 2}, {2, 3}, {2, 3}, {2, 4}};
+
+    // number of chain inputs per output of a stage
+    static constexpr uint32_t period(uint8_t stage)
+    {
+        uint32_t p = 1;
+        for (uint8_t s = 0; s <= stage && s < numStages; ++s) {
+            p *= stages[s].interval;
+        }
+        return p;
+    }
+
+private:
+    static constexpr uint8_t taps = FILTER_ORDER + 1;
+
+    struct Chunk {
+        // history per stage and channel: a ring buffer of taps values, the newest value is at the head of the channel
+        int64_t xv[numStages][chunkSize][taps];
+        int64_t yv[numStages][chunkSize][taps];
+        uint8_t head[numStages][chunkSize];
+
+        // per channel
+        int64_t input[chunkSize]; // pending value, then the input for the next stage during a step. 0 when not active
+        int32_t stepThreshold[chunkSize];
+        uint32_t counter[chunkSize];
+        uint8_t active[chunkSize]; // channel receives a new value in the stage that is processed
+        uint8_t pending[chunkSize];
+        uint8_t used[chunkSize];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    channel_t numUsed = 0;
+    channel_t numPending = 0;
+    bool m_stepOnAdd = false;
+    ChangeNotifier m_stepped;
+
+    Chunk& chunk(channel_t channel)
+    {
+        return *chunks[channel / chunkSize];
+    }
+    const Chunk& chunk(channel_t channel) const
+    {
+        return *chunks[channel / chunkSize];
+    }
+    static uint8_t lane(channel_t channel)
+    {
+        return channel % chunkSize;
+    }
+
+    static const IirFilter::FilterParams& params(uint8_t stage)
+    {
+        return IirFilter::FilterDefinition(stages[stage].param);
+    }
+
+    static uint8_t slot(const Chunk& c, uint8_t stage, uint8_t lane, uint8_t age)
+    {
+        uint8_t slot = c.head[stage][lane] + age;
+        return slot >= taps ? slot - taps : slot;
+    }
+    static int64_t x(const Chunk& c, uint8_t stage, uint8_t lane, uint8_t age)
+    {
+        return c.xv[stage][lane][slot(c, stage, lane, age)];
+    }
+    static int64_t y(const Chunk& c, uint8_t stage, uint8_t lane, uint8_t age)
+    {
+        return c.yv[stage][lane][slot(c, stage, lane, age)];
+    }
+
+    // process one stage for the active channels of a chunk, returns the number of channels that continue to the next stage
+    channel_t stepStage(Chunk& c, uint8_t stage, uint8_t inputFractionBits);
+    static void resetHistory(Chunk& c, uint8_t stage, uint8_t lane, int64_t value);
+
+public:
+    FilterBank() = default;
+    ~FilterBank() = default;
+
+    // Bank shared by all sensor pairs.
+    // It steps on each add until an owner disables that and steps it once per pass.
+    static std::shared_ptr<FilterBank> defaultBank();
+
+    channel_t addChannel(const int32_t& stepThreshold = std::numeric_limits<int32_t>::max());
+    void removeChannel(channel_t channel);
+    channel_t channels() const // number of channels in use
+    {
+        return numUsed;
+    }
+    channel_t capacity() const
+    {
+        return channel_t(chunks.size() * chunkSize);
+    }
+
+    // Set the value for the next step. When the channel already has a pending value, the bank is stepped first.
+    void add(channel_t channel, const int32_t& val);
+    // Process all pending values
+    void step();
+    bool isPending(channel_t channel) const
+    {
+        return chunk(channel).pending[lane(channel)];
+    }
+
+    // step the bank on each add, for a bank that has no owner to step it
+    void stepOnAdd(bool v)
+    {
+        m_stepOnAdd = v;
+    }
+    bool stepOnAdd() const
+    {
+        return m_stepOnAdd;
+    }
+
+    // notified after each step that processed values
+    ChangeNotifier& stepped()
+    {
+        return m_stepped;
+    }
+
+    // Reset and the step threshold have the same behavior as in FilterChain.
+    // A pending value of the channel is processed first, with the old state.
+    void reset(channel_t channel, const int32_t& value);
+    void setStepThreshold(channel_t channel, const int32_t& threshold);
+
+    // The functions below have the same behavior as in FilterChain. They do not step the bank.
+    int32_t getStepThreshold(channel_t channel) const;
+    int32_t read(channel_t channel, uint8_t filterNr) const;
+    int64_t readWithNFractionBits(channel_t channel, uint8_t filterNr, uint8_t bits) const;
+    int32_t readLastInput(channel_t channel) const;
+    IirFilter::DerivativeResult readDerivative(channel_t channel, uint8_t filterNr) const;
+    uint32_t getCount(channel_t channel) const;
+
+    uint32_t sampleInterval(uint8_t filterNr) const;
+    uint32_t sampleInterval() const;
+    uint8_t intervalToFilterNr(uint32_t maxInterval) const;
+    uint8_t fractionBits(uint8_t filterNr) const;
+    uint8_t length() const
+    {
+        return numStages;
+    }
+};
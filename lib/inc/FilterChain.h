@@ -19,6 +19,7 @@
 
 #pragma once
 #include "IirFilter.h"
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <memory>
@@ -40,6 +41,7 @@ public:
     ~FilterChain() = default;
 
     void add(const int32_t& val);
+    void add(const int32_t* vals, size_t count); // same result as adding the values one by one
     void setParams(const std::vector<uint8_t>& params, const std::vector<uint8_t>& intervals, const int32_t& stepThreshold);
     void setStepThreshold(const int32_t& threshold); // set the step detection threshold
     int32_t getStepThreshold() const;                // get the step detection threshold of last filter
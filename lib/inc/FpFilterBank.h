@@ -0,0 +1,169 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "FilterBank.h"
+#include "FixedPoint.h"
+#include <memory>
+
+/*
+ * Handle to a channel in a FilterBank, with the same interface as FpFilterChain.
+ * The channel is allocated on construction and released on destruction.
+ * When the channel has a pending value, reading it steps the bank first, so readers never get the value of the
+ * previous pass. All pending channels are processed in that step, the owner's step at the end of the pass
+ * only processes the channels that were not read.
+ */
+template <typename T>
+class FpFilterBankChannel {
+private:
+    std::shared_ptr<FilterBank> bank;
+    FilterBank::channel_t channel;
+    uint8_t readIdx; // 0 for no filtering, 1 - 6 for each filter stage
+
+    void stepIfPending() const
+    {
+        if (bank->isPending(channel)) {
+            bank->step();
+        }
+    }
+
+public:
+    using value_type = T;
+
+    FpFilterBankChannel(std::shared_ptr<FilterBank> _bank, uint8_t idx)
+        : bank(std::move(_bank))
+        , channel(bank->addChannel())
+        , readIdx(idx)
+    {
+    }
+
+    FpFilterBankChannel(const FpFilterBankChannel&) = delete;
+    FpFilterBankChannel& operator=(const FpFilterBankChannel&) = delete;
+
+    FpFilterBankChannel(FpFilterBankChannel&& other)
+        : bank(std::move(other.bank))
+        , channel(other.channel)
+        , readIdx(other.readIdx)
+    {
+    }
+
+    ~FpFilterBankChannel()
+    {
+        if (bank) {
+            bank->removeChannel(channel);
+        }
+    }
+
+    void add(const value_type& val)
+    {
+        bank->add(channel, cnl::unwrap(val));
+    }
+
+    void setReadIdx(uint8_t idx)
+    {
+        readIdx = idx;
+    }
+
+    uint8_t getReadIdx() const
+    {
+        return readIdx;
+    }
+
+    void setStepThreshold(const value_type& stepThreshold)
+    {
+        bank->setStepThreshold(channel, cnl::unwrap(stepThreshold));
+    }
+
+    value_type getStepThreshold() const
+    {
+        return cnl::wrap<value_type>(bank->getStepThreshold(channel));
+    }
+
+    value_type read() const
+    {
+        if (readIdx == 0) {
+            return readLastInput();
+        }
+        return read(readIdx - 1);
+    }
+
+    value_type read(uint8_t filterNr) const
+    {
+        stepIfPending();
+        return cnl::wrap<value_type>(bank->read(channel, filterNr));
+    }
+
+    value_type readLastInput() const
+    {
+        stepIfPending();
+        return cnl::wrap<value_type>(bank->readLastInput(channel));
+    }
+
+    uint8_t length() const
+    {
+        return bank->length();
+    }
+
+    // the value added last has not been processed by the bank yet
+    bool isPending() const
+    {
+        return bank->isPending(channel);
+    }
+
+    // notified after each step of the bank
+    ChangeNotifier& stepped() const
+    {
+        return bank->stepped();
+    }
+
+    // get the derivative from the bank with max precision and convert to the requested FP precision
+    template <typename U>
+    U readDerivative(uint8_t idx) const
+    {
+        stepIfPending();
+        auto derivative = bank->readDerivative(channel, idx);
+        uint8_t destFractionBits = cnl::_impl::fractional_digits<U>();
+        uint8_t filterFactionBits = cnl::_impl::fractional_digits<T>() + derivative.fractionBits;
+        int64_t result;
+        if (destFractionBits >= filterFactionBits) {
+            result = derivative.result * (int64_t(1) << (destFractionBits - filterFactionBits));
+        } else {
+            result = derivative.result >> (filterFactionBits - destFractionBits);
+        }
+        return cnl::wrap<U>(result);
+    }
+
+    template <typename U>
+    U readDerivative() const
+    {
+        return readDerivative<U>(readIdx > 0 ? readIdx - 1 : 0);
+    }
+
+    template <typename U>
+    U readDerivativeForInterval(uint32_t maxInterval) const
+    {
+        // select filter in chain with an update interval to have the optimal amount of filtering for the period requested
+        return readDerivative<U>(bank->intervalToFilterNr(maxInterval));
+    }
+
+    void reset(const value_type& value)
+    {
+        bank->reset(channel, cnl::unwrap(value));
+    }
+};
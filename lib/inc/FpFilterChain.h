@@ -20,6 +20,7 @@
 #pragma once
 #include "FilterChain.h"
 #include "FixedPoint.h"
+#include <algorithm>
 #include <type_traits>
 
 template <typename T>
@@ -48,6 +49,22 @@ public:
     }
     void add(const int32_t& val);
 
+    // same result as adding the values one by one
+    void add(const value_type* vals, size_t count)
+    {
+        constexpr size_t blockSize = 16;
+        int32_t block[blockSize];
+        while (count > 0) {
+            size_t n = std::min(count, blockSize);
+            for (size_t i = 0; i < n; ++i) {
+                block[i] = cnl::unwrap(vals[i]);
+            }
+            chain.add(block, n);
+            vals += n;
+            count -= n;
+        }
+    }
+
     void setReadIdx(uint8_t idx)
     {
         readIdx = idx;
@@ -6,7 +6,7 @@
 #define FILTER_ORDER 6
 
 class IirFilter {
-private:
+public:
     struct FilterParams {
         // params can be stored as int32_t, because they will be promoted when multiplied with _xv and _yv
         int32_t b[FILTER_ORDER + 1]; // multiplied with _xv
@@ -16,12 +16,29 @@ private:
         int32_t maxDerivative;       // max derivative on a step response of 1<<shift
     };
 
+private:
+    // computes a new output from the input and output history, with the coefficients of one filter compiled in
+    using Kernel = int64_t (*)(const int64_t* xv, const int64_t* yv, uint8_t head);
+
+    // xv and yv are ring buffers: the newest value is at index head, older values follow it and wrap around
     int64_t xv[FILTER_ORDER + 1];
     int64_t yv[FILTER_ORDER + 1];
+    FilterParams const* paramsPtr;
+    Kernel kernel;
+    uint8_t head;
     uint8_t paramsIdx;
     int32_t fastStepThreshold;
 
-    FilterParams const& params() const;
+    FilterParams const& params() const
+    {
+        return *paramsPtr;
+    }
+    uint8_t historyIndex(uint8_t age) const
+    {
+        uint8_t i = head + age;
+        return i > FILTER_ORDER ? i - (FILTER_ORDER + 1) : i;
+    }
+    void selectParams(const uint8_t idx);
     int64_t shift(const int64_t val) const;
     int64_t unshift(const int64_t val) const;
     int64_t shift(const int64_t val, uint8_t shift) const;
@@ -47,7 +64,7 @@ public:
     }
     int32_t readLastInput() const
     {
-        return unshift(xv[0]);
+        return unshift(xv[head]);
     }
 
     struct DerivativeResult {
@@ -57,7 +74,7 @@ public:
 
     DerivativeResult readDerivative() const // returns unshifted derivative
     {
-        return {yv[0] - yv[1], fractionBits()};
+        return {yv[head] - yv[historyIndex(1)], fractionBits()};
     }
 
     int32_t unityStepDerivative() const
@@ -77,12 +77,34 @@ public:
         // first channel on external interface is 1, because 0 is unconfigured
         if (validChannel(channel)) {
             channels[channel - 1].config = config;
-            writeChannelImpl(channel, config);
+            if (m_stagingDepth > 0) {
+                m_stagedChannels |= uint32_t(1) << (channel - 1);
+            } else {
+                writeChannelImpl(channel, config);
+            }
             return true;
         }
         return false;
     }
 
+    // Channel writes after beginWrites() are staged and written to the hardware together by commitWrites().
+    // Calls can be nested, the outermost commitWrites() performs the write.
+    void beginWrites()
+    {
+        ++m_stagingDepth;
+    }
+
+    // returns false if writing the staged channels failed
+    bool commitWrites()
+    {
+        if (m_stagingDepth == 0 || --m_stagingDepth > 0) {
+            return true;
+        }
+        auto staged = m_stagedChannels;
+        m_stagedChannels = 0;
+        return staged == 0 || writeChannelsImpl(staged);
+    }
+
     bool claimChannel(uint8_t channel, const ChannelConfig& config)
     {
         ChannelConfig existingConfig;
@@ -123,10 +145,27 @@ protected:
     virtual bool senseChannelImpl(uint8_t channel, State& result) const = 0;
     virtual bool writeChannelImpl(uint8_t channel, const ChannelConfig& config) = 0;
 
+    // Write the staged channels, bit 0 of the mask is channel 1.
+    // The default writes them one by one, devices that can write all channels at once override it.
+    virtual bool writeChannelsImpl(uint32_t channelMask)
+    {
+        bool success = true;
+        for (uint8_t i = 0; i < size(); ++i) {
+            if (channelMask & (uint32_t(1) << i)) {
+                success = writeChannelImpl(i + 1, channels[i].config) && success;
+            }
+        }
+        return success;
+    }
+
     struct Channel {
         ChannelConfig config;
         State state;
     };
 
     mutable std::vector<Channel> channels;
+
+private:
+    uint8_t m_stagingDepth = 0;
+    uint32_t m_stagedChannels = 0;
 };
\ No newline at end of file
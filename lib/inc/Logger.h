@@ -19,12 +19,18 @@
 
 #pragma once
 
+#include "TicksTypes.h"
 #include "string_operators.h"
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE 16
+#endif
+
 class Logger {
 public:
     enum LogLevel : uint8_t {
@@ -34,24 +40,93 @@ public:
         ERROR
     };
 
-    using LogWriteFunction = std::function<void(const LogLevel& logLevel, const std::string&)>;
+    // codes for structured log records. The message text for each code is only looked up when the record is drained
+    enum class LogCode : uint8_t {
+        LOG_BUFFER_OVERFLOW,
+        DS2413_CONNECTED,
+        DS2413_DISCONNECTED,
+        DS2408_CONNECTED,
+        DS2408_DISCONNECTED,
+        TEMP_SENSOR_CONNECTED,
+        TEMP_SENSOR_DISCONNECTED,
+    };
+
+    struct LogRecord {
+        ticks_millis_t timestamp;
+        uint64_t arg;
+        LogLevel level;
+        LogCode code;
+    };
+
+    using LogWriteFunction = std::function<void(const LogLevel& logLevel, const char* msg)>;
+    using TimeFunction = ticks_millis_t (*)();
     using StringBuffer = std::unique_ptr<std::string, std::function<void(std::string*)>>;
 
-    explicit Logger(LogWriteFunction&& logFunction)
+    explicit Logger(LogWriteFunction&& logFunction, TimeFunction timeFunction = nullptr)
         : m_logWriteFunction(logFunction)
+        , m_timeFunction(timeFunction)
     {
     }
 
+    /**
+     * Free format log message, written immediately. This allocates a string on the heap.
+     * Don't use it in code that runs on each update, use a structured record instead.
+     */
     StringBuffer operator()(LogLevel e, const char* initStr)
     {
         return StringBuffer(new std::string(initStr), [e, this](std::string* st) {
-            m_logWriteFunction(e, *st);
+            m_logWriteFunction(e, st->c_str());
             delete st;
         });
     }
 
+    /**
+     * Adds a binary log record to the ring buffer. Does not allocate or write to any output.
+     * When the buffer is full, the record is dropped and counted.
+     */
+    void log(LogLevel level, LogCode code, uint64_t arg = 0)
+    {
+        if (m_count == m_records.size()) {
+            ++m_dropped;
+            return;
+        }
+        auto& record = m_records[(m_head + m_count) % m_records.size()];
+        record.timestamp = m_timeFunction ? m_timeFunction() : 0;
+        record.arg = arg;
+        record.level = level;
+        record.code = code;
+        ++m_count;
+    }
+
+    /**
+     * Formats all pending records and passes them to the log write function.
+     * Call this from the communication task, not from update code.
+     */
+    void drain();
+
+    size_t pending() const
+    {
+        return m_count;
+    }
+
+    // total number of records dropped because the buffer was full
+    uint32_t dropped() const
+    {
+        return m_dropped;
+    }
+
+    static size_t format(const LogRecord& record, char* buf, size_t len);
+
 private:
     LogWriteFunction m_logWriteFunction;
+    TimeFunction m_timeFunction;
+    std::array<LogRecord, LOG_BUFFER_SIZE> m_records;
+    uint8_t m_head = 0;
+    uint8_t m_count = 0;
+    uint32_t m_dropped = 0;
+    uint32_t m_droppedReported = 0;
+
+    static_assert(LOG_BUFFER_SIZE > 0 && LOG_BUFFER_SIZE < 256, "log buffer indices are stored as uint8_t");
 };
 
 extern Logger&
@@ -61,3 +136,8 @@ logger();
 #define CL_LOG_INFO(initStr) *logger()(Logger::INFO, initStr)
 #define CL_LOG_WARN(initStr) *logger()(Logger::WARN, initStr)
 #define CL_LOG_ERROR(initStr) *logger()(Logger::ERROR, initStr)
+
+#define CL_LOG_RECORD_DEBUG(code, arg) logger().log(Logger::DEBUG, Logger::LogCode::code, arg)
+#define CL_LOG_RECORD_INFO(code, arg) logger().log(Logger::INFO, Logger::LogCode::code, arg)
+#define CL_LOG_RECORD_WARN(code, arg) logger().log(Logger::WARN, Logger::LogCode::code, arg)
+#define CL_LOG_RECORD_ERROR(code, arg) logger().log(Logger::ERROR, Logger::LogCode::code, arg)
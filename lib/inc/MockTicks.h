@@ -31,6 +31,7 @@ public:
     MockTicks(duration_millis_t autoIncrement = 0)
         : _increment(autoIncrement)
         , _ticks(0)
+        , _utc_boot_time(0)
     {
     }
 
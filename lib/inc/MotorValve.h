@@ -102,6 +102,8 @@ public:
         }
         // ACTIVE HIGH means latch pull down enabled, so the input to the H-bridge is inverted.
         // We keep the motor enabled just in case. The valve itself has an internal shutoff.
+        // Both channels are written to the device at once.
+        devPtr->beginWrites();
         if (v == ValveState::Opening || v == ValveState::Open) {
             devPtr->writeChannelConfig(m_startChannel + chanOpeningHigh, DS2408::ChannelConfig::ACTIVE_LOW);
             devPtr->writeChannelConfig(m_startChannel + chanClosingHigh, DS2408::ChannelConfig::ACTIVE_HIGH);
@@ -112,6 +114,7 @@ public:
             devPtr->writeChannelConfig(m_startChannel + chanOpeningHigh, DS2408::ChannelConfig::ACTIVE_HIGH);
             devPtr->writeChannelConfig(m_startChannel + chanClosingHigh, DS2408::ChannelConfig::ACTIVE_HIGH);
         }
+        devPtr->commitWrites();
     }
 
     ValveState getValveState(const std::shared_ptr<DS2408>& devPtr) const
@@ -203,6 +206,7 @@ public:
     void claimChannel()
     {
         if (auto devPtr = m_target()) {
+            devPtr->beginWrites(); // claim and release channels with a single write
             if (m_startChannel != 0) {
                 for (uint8_t i = 0; i < 4; ++i) {
                     devPtr->releaseChannel(m_startChannel + i);
@@ -224,6 +228,7 @@ public:
             } else {
                 m_desiredChannel = 0;
             }
+            devPtr->commitWrites();
         }
     }
 
@@ -46,7 +46,11 @@
 #define ONEWIRE_PARASITE_SUPPORT 1
 #endif
 
+#include "OneWireAddress.h"
 #include "OneWireLowLevelInterface.h"
+#include <unordered_set>
+
+class OneWireTransactions;
 
 // pass low level driver as template
 class OneWire {
@@ -72,6 +76,21 @@ private:
     uint8_t LastDeviceFlag;
     OneWireLowLevelInterface& driver;
 #endif
+    // queued transactions that run on this bus, synchronous access waits for the one in progress
+    OneWireTransactions* m_transactions = nullptr;
+    friend class OneWireTransactions;
+
+    // incremented on each reset, so a search that spans several calls can detect that the bus was used in between
+    uint32_t m_resets = 0;
+
+    // set by a search that spans several calls while devices are in the search, the transactions wait for it
+    bool m_held = false;
+
+    // addresses of the OneWireDevice objects on this bus, kept up to date by OneWireDevice
+    std::unordered_multiset<uint64_t> m_deviceAddresses;
+    friend class OneWireDevice;
+
+    void finishTransactions();
 
 public:
     // wrappers for low level functions
@@ -99,12 +118,42 @@ public:
     {
         return driver.read_bit();
     }
+    uint8_t search_triplet(uint8_t* search_direction, uint8_t* id_bit, uint8_t* cmp_id_bit)
+    {
+        return driver.search_triplet(search_direction, id_bit, cmp_id_bit);
+    }
 
     bool reset()
     {
+        finishTransactions();
+        ++m_resets;
         return driver.reset();
     }
 
+    uint32_t resets() const
+    {
+        return m_resets;
+    }
+
+    void hold(bool held)
+    {
+        m_held = held;
+    }
+
+    bool held() const
+    {
+        return m_held;
+    }
+
+    // a queued transaction has reset the bus and is not completed yet
+    bool transactionInProgress() const;
+
+    // an object exists for the device at the address, in O(1) instead of checking all objects
+    bool hasDevice(const OneWireAddress& address) const
+    {
+        return m_deviceAddresses.count(uint64_t(address)) != 0;
+    }
+
     // high level functions
 
     // Issue a 1-Wire rom select command, you do the reset first.
@@ -22,12 +22,18 @@
 #include "OneWire.h"
 #include "OneWireAddress.h"
 
+/*
+ * Base class of the device drivers. The address of each device object is registered on its bus,
+ * so a scan can check in O(1) whether an object exists for a device it finds.
+ */
 class OneWireDevice {
 public:
     OneWireDevice(OneWire& oneWire_, const OneWireAddress& address_);
+    OneWireDevice(const OneWireDevice& other);
+    OneWireDevice& operator=(const OneWireDevice&) = delete;
 
 protected:
-    ~OneWireDevice() = default;
+    ~OneWireDevice();
 
 public:
     OneWireAddress getDeviceAddress() const;
@@ -44,4 +50,8 @@ protected:
     OneWireAddress address;
 
     mutable bool m_connected = false;
+
+private:
+    void registerAddress();
+    void unregisterAddress();
 };
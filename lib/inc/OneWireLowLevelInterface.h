@@ -62,4 +62,51 @@ public:
 
     // Perform a triple operation which will perform 2 read bits and 1 write bit
     virtual uint8_t search_triplet(uint8_t*, uint8_t*, uint8_t*) = 0;
+
+    // Split phase operations, used by OneWireTransactions to access the bus without waiting.
+    // A driver that executes bus operations in the background returns true from busy() until the last one is done.
+    // The next operation or result should only be requested when busy() returns false.
+    // The defaults call the blocking functions above, so the driver is never busy.
+    virtual bool busy()
+    {
+        return false;
+    }
+
+    virtual void startReset()
+    {
+        lastPresence = reset();
+    }
+
+    // presence pulse detected by the last reset
+    virtual bool presence()
+    {
+        return lastPresence;
+    }
+
+    virtual void startWrite(uint8_t v)
+    {
+        write(v);
+    }
+
+    virtual void startRead()
+    {
+        lastRead = read();
+    }
+
+    // byte received by the last read
+    virtual uint8_t readResult()
+    {
+        return lastRead;
+    }
+
+    // The driver could not be reached during the last split phase call, for example because of an I2C error.
+    // busy() returns false in that case, the operation has failed.
+    virtual bool failed()
+    {
+        return false;
+    }
+
+private:
+    bool lastPresence = false;
+    uint8_t lastRead = 0xFF;
 };
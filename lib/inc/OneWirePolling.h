@@ -0,0 +1,143 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "TicksTypes.h"
+#include <algorithm>
+#include <cstdint>
+
+/*
+ * Polling policy of a OneWire device, so the bus spends its time on the devices that need it.
+ *
+ * A device is polled at its configured interval. In on demand mode, it is only polled at that interval while
+ * a consumer uses the value and at the idle interval otherwise. After a failed poll the interval is doubled,
+ * up to the maximum backoff, so a disconnected device does not keep occupying the bus.
+ * The first successful poll restores the configured interval.
+ *
+ * The achieved time between samples and the bus time per poll are tracked as moving averages.
+ */
+class OneWirePolling {
+public:
+    enum class Mode : uint8_t {
+        Interval, // poll at the configured interval
+        OnDemand, // poll at the configured interval while the value is used
+    };
+
+    static constexpr duration_millis_t defaultInterval = 1000;
+    static constexpr duration_millis_t idleInterval = 60000;
+    static constexpr duration_millis_t maxBackoff = 60000;
+
+    explicit OneWirePolling(duration_millis_t interval = defaultInterval, Mode mode = Mode::Interval)
+        : m_interval(interval)
+        , m_mode(mode)
+    {
+    }
+
+    duration_millis_t interval() const
+    {
+        return m_interval;
+    }
+
+    void interval(duration_millis_t v)
+    {
+        m_interval = v;
+    }
+
+    Mode mode() const
+    {
+        return m_mode;
+    }
+
+    void mode(Mode v)
+    {
+        m_mode = v;
+    }
+
+    // called when the value is used, so the next sample is taken at the configured interval
+    void demand() const
+    {
+        m_demanded = true;
+    }
+
+    // interval until the next poll, including backoff
+    duration_millis_t currentInterval() const;
+
+    ticks_millis_t next() const
+    {
+        return m_lastPoll + currentInterval();
+    }
+
+    bool due(const ticks_millis_t& now) const
+    {
+        return m_polls == 0 || int32_t(now - next()) >= 0;
+    }
+
+    // When to check due() again. While idle, this is the configured interval, so a new demand is not kept
+    // waiting for the idle interval.
+    ticks_millis_t nextCheck(const ticks_millis_t& now) const
+    {
+        if (due(now)) {
+            return now;
+        }
+        return now + std::min(duration_millis_t(next() - now), m_interval);
+    }
+
+    // record the result of a poll and the time the bus was occupied by it
+    void polled(const ticks_millis_t& now, bool success, duration_micros_t busTime);
+
+    // average time between successful samples, 0 until two samples are taken
+    duration_millis_t sampleInterval() const
+    {
+        return m_sampleInterval;
+    }
+
+    // average bus time per poll
+    duration_micros_t busTime() const
+    {
+        return m_busTime;
+    }
+
+    // average bus time per second spent on this device
+    duration_micros_t busLoad() const;
+
+    uint32_t samples() const
+    {
+        return m_samples;
+    }
+
+    // number of failed polls since the last successful one
+    uint8_t failures() const
+    {
+        return m_failures;
+    }
+
+private:
+    duration_millis_t m_interval;
+    Mode m_mode;
+    mutable bool m_demanded = false;
+    uint8_t m_failures = 0;
+    uint32_t m_polls = 0;
+    uint32_t m_samples = 0;
+    ticks_millis_t m_lastPoll = 0;
+    ticks_millis_t m_lastSample = 0;
+    duration_millis_t m_pollInterval = 0;
+    duration_millis_t m_sampleInterval = 0;
+    duration_micros_t m_busTime = 0;
+};
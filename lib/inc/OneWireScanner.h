@@ -0,0 +1,87 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireAddress.h"
+#include "OneWireSearch.h"
+#include "TicksTypes.h"
+#include <cstdint>
+#include <vector>
+
+class OneWire;
+
+/*
+ * Scans the bus in the background with a OneWireSearch, a few search steps per update.
+ *
+ * A scan starts periodically and when one is requested. A device is added to the list as soon as it is found,
+ * so readers of the list get new devices before the scan completes. When the scan completes, the devices
+ * that it did not find are removed.
+ */
+class OneWireScanner {
+public:
+    static constexpr uint16_t stepsPerUpdate = 8; // about 2 ms of bus time with a DS2482
+    static constexpr duration_millis_t scanInterval = 10000;
+
+    explicit OneWireScanner(OneWire& bus)
+        : m_bus(bus)
+        , m_search(bus)
+    {
+    }
+
+    OneWire& bus()
+    {
+        return m_bus;
+    }
+
+    // start a scan on the next update, or when the scan in progress completes
+    void request()
+    {
+        m_requested = true;
+    }
+
+    // Perform a few search steps when a scan is due or in progress. Returns the time of the next update.
+    ticks_millis_t update(const ticks_millis_t& now);
+
+    // devices found by the last completed scan and the scan in progress
+    const std::vector<OneWireAddress>& devices() const
+    {
+        return m_devices;
+    }
+
+    bool scanning() const
+    {
+        return m_scanning;
+    }
+
+    uint32_t completedScans() const
+    {
+        return m_completedScans;
+    }
+
+private:
+    OneWire& m_bus;
+    OneWireSearch m_search;
+    std::vector<OneWireAddress> m_devices;
+    std::vector<OneWireAddress> m_scanned; // found by the scan in progress
+    ticks_millis_t m_nextScan = 0;
+    uint32_t m_completedScans = 0;
+    bool m_scanning = false;
+    bool m_requested = true;
+};
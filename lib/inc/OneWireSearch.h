@@ -0,0 +1,95 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireAddress.h"
+#include <cstdint>
+
+class OneWire;
+
+/*
+ * ROM search that can be spread over many calls, so a bus scan does not block the main loop.
+ *
+ * Each call to step() performs a limited number of search steps: the reset with the Search ROM command,
+ * or a triplet (read a bit and its complement, write the direction) for one address bit.
+ * Finding one device takes 65 steps.
+ *
+ * While a device is searched, the search holds the bus so queued OneWireTransactions wait for it.
+ * A device search only starts between two transactions.
+ * When the bus is reset by someone else between two calls, the devices leave the search.
+ * The search then restarts the current device from its reset, the devices found before are not searched again.
+ */
+class OneWireSearch {
+public:
+    explicit OneWireSearch(OneWire& bus)
+        : m_bus(bus)
+    {
+    }
+    OneWireSearch(const OneWireSearch&) = delete;
+    OneWireSearch& operator=(const OneWireSearch&) = delete;
+
+    ~OneWireSearch()
+    {
+        active(false);
+    }
+
+    // start again from the first device
+    void reset();
+
+    // Perform at most maxSteps search steps. Returns true when a device was found, its address is stored in found.
+    bool step(OneWireAddress& found, uint16_t maxSteps);
+
+    // the last device was found or the bus has no devices
+    bool done() const
+    {
+        return m_done;
+    }
+
+    // number of times the search of a device was interrupted by other bus use
+    uint32_t restarts() const
+    {
+        return m_restarts;
+    }
+
+private:
+    bool romBit(uint8_t bit) const
+    {
+        return (m_rom[(bit - 1) / 8] >> ((bit - 1) % 8)) & 0x01;
+    }
+
+    void romBit(uint8_t bit, bool value);
+
+    // a device is in the search, the bus is held
+    void active(bool v);
+
+    OneWire& m_bus;
+
+    // state of the search after the last device found
+    uint8_t m_rom[8] = {0};
+    uint8_t m_lastDiscrepancy = 0;
+    bool m_done = false;
+
+    // state of the device that is being searched
+    bool m_active = false;
+    uint8_t m_bit = 0; // 1-64
+    uint8_t m_lastZero = 0;
+    uint32_t m_resetsAtStart = 0;
+    uint32_t m_restarts = 0;
+};
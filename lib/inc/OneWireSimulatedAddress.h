@@ -0,0 +1,38 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWire.h"
+#include "OneWireAddress.h"
+#include <cstdint>
+
+// Valid address for a device on the simulated bus, unique for each family and serial.
+// The serial is also spread over a second byte, so searches have to resolve more discrepancies.
+inline OneWireAddress
+makeAddress(uint8_t family, uint8_t serial)
+{
+    OneWireAddress address;
+    uint8_t* bytes = address.asUint8ptr();
+    bytes[0] = family;
+    bytes[1] = serial;
+    bytes[3] = serial ^ 0x5A;
+    bytes[7] = OneWire::crc8(bytes, 7);
+    return address;
+}
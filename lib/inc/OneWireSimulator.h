@@ -0,0 +1,351 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireAddress.h"
+#include "OneWireLowLevelInterface.h"
+#include "TicksTypes.h"
+#include <memory>
+#include <vector>
+
+/*
+ * A device on the simulated OneWire bus.
+ * The bus handles the ROM commands. The device only sees the bytes of transactions it is selected for.
+ */
+class OneWireSimulatedDevice {
+public:
+    explicit OneWireSimulatedDevice(const OneWireAddress& address)
+        : m_address(address)
+    {
+    }
+    virtual ~OneWireSimulatedDevice() = default;
+
+    const OneWireAddress& address() const
+    {
+        return m_address;
+    }
+
+    // called on each bus reset, which ends the current transaction
+    virtual void reset() {}
+
+    // byte written by the master, the first byte after selecting the device is the function command
+    virtual void write(uint8_t b) = 0;
+
+    // byte read by the master. Bits the device does not drive low are 1
+    virtual uint8_t read() = 0;
+
+    virtual uint8_t read_bit()
+    {
+        return read() & 0x01;
+    }
+
+private:
+    OneWireAddress m_address;
+};
+
+/*
+ * Bit and byte level simulation of a OneWire bus, used on the gcc build to test the OneWire classes without hardware.
+ * It handles the ROM commands (Match ROM, Skip ROM, Read ROM and Search ROM) and passes the function commands to the
+ * selected device models. It counts the bus traffic, so tests can check how efficiently the bus is used.
+ *
+ * The simulator has its own clock to model the timing of a bus master like the DS248x.
+ * Each call to the driver costs the caller the command time (the I2C transfer).
+ * The OneWire operation itself runs in the background for its bus time: blocking calls wait for it,
+ * split phase calls return and busy() is true until it is done.
+ *
+ * Bus errors can be injected at a fixed interval, which keeps tests deterministic.
+ */
+class OneWireSimulator final : public OneWireLowLevelInterface {
+public:
+    struct Stats {
+        uint32_t resets;
+        uint32_t bytesWritten;
+        uint32_t bytesRead;
+        duration_micros_t waited; // time blocking calls waited for the bus
+        uint32_t bitsRead;        // single bits, including the bits of a ROM search
+        uint32_t bitsWritten;
+        uint32_t corruptedReads;
+        uint32_t missedPresences;
+    };
+
+    struct Timing {
+        duration_micros_t command;
+        duration_micros_t reset;
+        duration_micros_t byte;
+        duration_micros_t bit;
+    };
+
+    // DS2482 at 400 kHz I2C with a standard speed OneWire bus
+    static constexpr Timing ds2482Timing = {60, 1150, 560, 70};
+
+    // an interval of 0 disables the error
+    struct Errors {
+        uint32_t corruptReadInterval;  // a bit is flipped in every nth byte read
+        uint32_t missPresenceInterval; // every nth reset gets no presence pulse
+    };
+
+    // faults of the bus master itself
+    enum class Fault : uint8_t {
+        None,
+        StuckBusy,  // the busy bit stays set
+        NoResponse, // I2C reads fail
+    };
+
+    OneWireSimulator() = default;
+    virtual ~OneWireSimulator() = default;
+
+    void timing(const Timing& t)
+    {
+        m_timing = t;
+    }
+
+    void errors(const Errors& e)
+    {
+        m_errors = e;
+    }
+
+    void fault(Fault f)
+    {
+        m_fault = f;
+    }
+
+    // simulated time in microseconds
+    ticks_micros_t micros() const
+    {
+        return m_time;
+    }
+
+    // time spent by the caller outside of the driver
+    void advance(duration_micros_t duration)
+    {
+        m_time += duration;
+    }
+
+    void attach(std::shared_ptr<OneWireSimulatedDevice> device);
+    void detach(const OneWireAddress& address);
+
+    const Stats& stats() const
+    {
+        return m_stats;
+    }
+
+    void resetStats()
+    {
+        m_stats = Stats{};
+    }
+
+    virtual bool init() override final
+    {
+        return true;
+    }
+
+    virtual bool reset() override final;
+    virtual void write(uint8_t b, uint8_t power = 0) override final;
+    virtual uint8_t read() override final;
+    virtual void write_bit(uint8_t bit) override final;
+    virtual uint8_t read_bit() override final;
+    virtual uint8_t search_triplet(uint8_t* search_direction, uint8_t* id_bit, uint8_t* cmp_id_bit) override final;
+
+    virtual bool busy() override final;
+    virtual void startReset() override final;
+    virtual bool presence() override final;
+    virtual void startWrite(uint8_t b) override final;
+    virtual void startRead() override final;
+    virtual uint8_t readResult() override final;
+    virtual bool failed() override final;
+
+private:
+    enum class State : uint8_t {
+        Idle,       // no reset since the last transaction
+        RomCommand, // waiting for a ROM command after reset
+        MatchRom,   // receiving the address of a Match ROM command
+        ReadRom,    // all devices send their address
+        Search,     // devices that match the bits of the search so far send their next address bit
+        Function,   // selected devices receive the bytes
+    };
+
+    std::vector<std::shared_ptr<OneWireSimulatedDevice>> m_devices;
+    std::vector<OneWireSimulatedDevice*> m_selected;
+    State m_state = State::Idle;
+    uint8_t m_matchRom[8] = {0};
+    uint8_t m_matchCount = 0;
+    uint8_t m_romIndex = 0;
+    uint8_t m_searchBit = 0;   // address bit of the ROM search
+    uint8_t m_searchPhase = 0; // 0: address bit, 1: complement, 2: master writes the direction
+    Stats m_stats{};
+
+    Errors m_errors{};
+    Fault m_fault = Fault::None;
+    uint32_t m_resetCount = 0;
+    uint32_t m_readCount = 0;
+
+    Timing m_timing{};
+    ticks_micros_t m_time = 0;
+    ticks_micros_t m_busyUntil = 0;
+    bool m_presence = false;
+    uint8_t m_readByte = 0xFF;
+
+    void command()
+    {
+        m_time += m_timing.command;
+    }
+    void runBus(duration_micros_t duration)
+    {
+        m_busyUntil = m_time + duration;
+    }
+    void waitForBus();
+
+    // bus level behavior, without timing
+    bool busReset();
+    void busWrite(uint8_t b);
+    uint8_t busRead();
+    uint8_t busReadBit();
+    void busWriteBit(uint8_t bit);
+};
+
+/*
+ * DS18B20 temperature sensor model. A conversion stores the simulated temperature in the scratchpad immediately.
+ */
+class OneWireSimulatedDS18B20 final : public OneWireSimulatedDevice {
+public:
+    explicit OneWireSimulatedDS18B20(const OneWireAddress& address);
+    virtual ~OneWireSimulatedDS18B20() = default;
+
+    // temperature for the next conversion, in 1/16 degree Celsius
+    void temperatureRaw(int16_t raw)
+    {
+        m_temperature = raw;
+    }
+
+    int16_t temperatureRaw() const
+    {
+        return m_temperature;
+    }
+
+    // number of Convert T commands received
+    uint32_t conversions() const
+    {
+        return m_conversions;
+    }
+
+    // the scratchpad is reloaded from EEPROM and the temperature register is reset to 85 degrees
+    void powerOn();
+
+    virtual void reset() override final;
+    virtual void write(uint8_t b) override final;
+    virtual uint8_t read() override final;
+
+private:
+    uint8_t m_scratchPad[9];
+    uint8_t m_eeprom[3] = {0x4B, 0x46, 0x7F}; // high alarm, low alarm, configuration
+    int16_t m_temperature = 0x0550;
+    uint32_t m_conversions = 0;
+    uint8_t m_command = 0;
+    uint8_t m_position = 0;
+};
+
+/*
+ * DS2413 dual channel switch model.
+ * A PIO is pulled low when its latch is enabled or when it is pulled down externally.
+ */
+class OneWireSimulatedDS2413 final : public OneWireSimulatedDevice {
+public:
+    explicit OneWireSimulatedDS2413(const OneWireAddress& address)
+        : OneWireSimulatedDevice(address)
+    {
+    }
+    virtual ~OneWireSimulatedDS2413() = default;
+
+    // pio 0 is PIOA, pio 1 is PIOB
+    bool latchEnabled(uint8_t pio) const
+    {
+        return (m_latches & (1 << pio)) == 0;
+    }
+
+    void externalPullDown(uint8_t pio, bool pulledDown);
+
+    // number of successful PIO access writes
+    uint32_t writes() const
+    {
+        return m_writes;
+    }
+
+    virtual void reset() override final;
+    virtual void write(uint8_t b) override final;
+    virtual uint8_t read() override final;
+
+private:
+    uint8_t status() const;
+
+    uint8_t m_latches = 0x03;  // 1 is off
+    uint8_t m_external = 0x03; // 0 is pulled down
+    uint32_t m_writes = 0;
+    uint8_t m_command = 0;
+    uint8_t m_received[2] = {0};
+    uint8_t m_position = 0;
+};
+
+/*
+ * DS2408 eight channel switch model.
+ * Supports the PIO access commands and reading the registers with the CRC16 at the end.
+ */
+class OneWireSimulatedDS2408 final : public OneWireSimulatedDevice {
+public:
+    explicit OneWireSimulatedDS2408(const OneWireAddress& address)
+        : OneWireSimulatedDevice(address)
+    {
+    }
+    virtual ~OneWireSimulatedDS2408() = default;
+
+    // bit n is PIO n, 0 means the output transistor is on
+    uint8_t latches() const
+    {
+        return m_latches;
+    }
+
+    void externalPullDown(uint8_t pio, bool pulledDown);
+
+    uint8_t pins() const
+    {
+        return m_latches & m_external;
+    }
+
+    // number of successful PIO access writes
+    uint32_t writes() const
+    {
+        return m_writes;
+    }
+
+    virtual void reset() override final;
+    virtual void write(uint8_t b) override final;
+    virtual uint8_t read() override final;
+
+private:
+    uint8_t registerValue(uint16_t address) const;
+
+    uint8_t m_latches = 0xFF;
+    uint8_t m_external = 0xFF;
+    uint32_t m_writes = 0;
+    uint8_t m_command = 0;
+    uint8_t m_received[2] = {0};
+    uint8_t m_position = 0;
+    uint16_t m_address = 0;
+    uint16_t m_crc = 0;
+};
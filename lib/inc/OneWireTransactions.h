@@ -0,0 +1,160 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireAddress.h"
+#include "TicksTypes.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+
+class OneWire;
+
+/*
+ * A complete OneWire transaction: reset, select a device (or all devices with Skip ROM), write bytes, read bytes.
+ * The bytes read are stored after the bytes written, so a CRC over the whole exchange can be checked on data.
+ */
+struct OneWireTransaction {
+    using Completion = std::function<void(const OneWireTransaction&)>;
+
+    static constexpr uint8_t maxBytes = 16;
+
+    OneWireTransaction() = default;
+    OneWireTransaction(const OneWireAddress& address_, std::initializer_list<uint8_t> writeBytes, uint8_t readCount_,
+                       const void* owner_ = nullptr, Completion onDone_ = nullptr);
+
+    // bytes read from the device
+    const uint8_t* result() const
+    {
+        return data + writeCount;
+    }
+
+    OneWireAddress address = 0; // 0 to address all devices with Skip ROM
+    uint8_t data[maxBytes] = {0};
+    uint8_t writeCount = 0;
+    uint8_t readCount = 0;
+    bool success = false;          // a device answered the reset and all bytes were transferred
+    duration_micros_t busTime = 0; // the bus is reserved for the transaction from its reset until completion
+    const void* owner = nullptr;   // used to cancel all transactions of an object
+    Completion onDone;
+};
+
+/*
+ * Queue of OneWire transactions that are executed without blocking the main loop.
+ *
+ * process() is called on each pass of the main loop. It polls the driver and starts the next step of the
+ * transaction at the front of the queue when the driver is done with the previous one, until the time budget is spent.
+ * A driver that runs bus operations in the background (DS248x) is busy after a step, process() then returns and
+ * continues the transaction on the next pass. It never waits for the bus.
+ * Transactions are executed in order of submission and the completion is called after the last byte is read.
+ *
+ * Synchronous use of the OneWire object is still possible: it first finishes the transaction that is in progress.
+ */
+class OneWireTransactions {
+public:
+    using Clock = std::function<ticks_micros_t()>;
+
+    static constexpr uint8_t maxPending = 64;
+
+    // A OneWire reset takes the longest, about 1.2 ms. A driver that is busy for longer than this is hung.
+    static constexpr duration_micros_t busyTimeout = 5000;
+
+    struct Stats {
+        uint32_t completed;
+        uint32_t failed;
+        uint32_t driverFaults;        // failed because the driver stayed busy or could not be reached
+        duration_micros_t maxLatency; // from submit to completion
+        duration_micros_t maxPass;    // longest time spent in process()
+    };
+
+    OneWireTransactions(OneWire& bus, Clock clock);
+    OneWireTransactions(const OneWireTransactions&) = delete;
+    OneWireTransactions& operator=(const OneWireTransactions&) = delete;
+    ~OneWireTransactions();
+
+    OneWire& bus()
+    {
+        return m_bus;
+    }
+
+    // returns false when the queue is full
+    bool submit(OneWireTransaction&& transaction);
+
+    // remove all transactions of the owner without calling their completion
+    void cancel(const void* owner);
+
+    // Advance the transactions for at most budget microseconds. Returns true when the queue is empty.
+    // The pass ends early when the driver is busy or fails, so a broken bus master doesn't take the whole budget.
+    // Nothing is done while a search holds the bus.
+    // A driver that stays busy fails the transaction on the first pass after busyTimeout.
+    bool process(duration_micros_t budget);
+
+    // Complete the transaction in progress, waiting for the bus if needed.
+    // It fails when the driver stays busy for longer than busyTimeout.
+    void finish();
+
+    size_t pending() const
+    {
+        return m_queue.size();
+    }
+
+    // the front transaction has reset the bus and is not completed yet
+    bool inProgress() const
+    {
+        return !m_queue.empty() && m_phase != Phase::Reset;
+    }
+
+    const Stats& stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    enum class Phase : uint8_t {
+        Reset,
+        Presence,
+        RomCommand,
+        Address,
+        Write,
+        Read,
+        ReadResult,
+    };
+
+    struct Entry {
+        OneWireTransaction transaction;
+        ticks_micros_t submitted;
+    };
+
+    // perform a single step of the front transaction, returns false if the driver is busy
+    bool step();
+    void complete(bool success);
+    void driverFault();
+
+    OneWire& m_bus;
+    Clock m_clock;
+    std::deque<Entry> m_queue;
+    Phase m_phase = Phase::Reset;
+    uint8_t m_index = 0;
+    ticks_micros_t m_started = 0; // time of the reset of the transaction in progress
+    ticks_micros_t m_busySince = 0;
+    bool m_waiting = false; // the driver was busy on the previous step, since m_busySince
+    Stats m_stats{};
+};
@@ -56,6 +56,10 @@ private:
 
     bool m_boilModeActive = false;
 
+    // derived from settings when they change, so they are not recalculated on each update
+    int32_t m_ki = 0;                    // kp / ti with 27 fraction bits
+    int32_t m_boilThreshold = 100 << 12; // raw value of 100C + boilPointAdjust
+
 public:
     explicit Pid(
         std::function<std::shared_ptr<SetpointSensorPair>()>&& input,
@@ -157,6 +161,7 @@ public:
     void boilPointAdjust(const in_t& v)
     {
         m_boilPointAdjust = v;
+        updateDerivedGains();
     }
 
     out_t boilMinOutput() const
@@ -170,6 +175,8 @@ public:
     }
 
 private:
+    void updateDerivedGains();
+
     void active(bool state)
     {
         if (m_enabled && m_active && !state) {
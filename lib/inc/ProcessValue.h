@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "ChangeNotifier.h"
 #include "FixedPoint.h"
 
 /*
@@ -43,4 +44,13 @@ public:
     virtual bool settingValid() const = 0;
     // writes valid flag of setting
     virtual void settingValid(bool v) = 0;
+
+    // listeners are notified when the value, the setting or their valid flags change
+    ChangeNotifier& changes()
+    {
+        return m_changes;
+    }
+
+protected:
+    ChangeNotifier m_changes;
 };
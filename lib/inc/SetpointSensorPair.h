@@ -20,8 +20,9 @@
 #pragma once
 
 #include "FixedPoint.h"
-#include "FpFilterChain.h"
+#include "FpFilterBank.h"
 #include "ProcessValue.h"
+#include "SlopeEstimator.h"
 #include "TempSensor.h"
 #include "Temperature.h"
 #include <functional>
@@ -34,27 +35,79 @@ class SetpointSensorPair : public ProcessValue<temp_t> {
 public:
     using derivative_t = safe_elastic_fixed_point<1, 23>;
 
+    enum class DerivativeSource : uint8_t {
+        FILTER,        // difference between the last 2 outputs of the filter stage that matches the requested period
+        LEAST_SQUARES, // slope of a least squares fit over the filtered values of the requested period
+    };
+
 private:
     temp_t m_setting = 20;
     bool m_settingEnabled = false;
     const std::function<std::shared_ptr<TempSensor>()> m_sensor;
-    FpFilterChain<temp_t> m_filter;
+    FpFilterBankChannel<temp_t> m_filter; // channel in a filter bank shared with other pairs
     uint8_t m_sensorFailureCount = 255; // force a reset on init
+    std::unique_ptr<SlopeEstimator> m_slopeEstimator; // only allocated for DerivativeSource::LEAST_SQUARES
+    temp_t m_lastValue = 0;        // filtered value at the last notification
+    bool m_awaitingFilter = false; // a value was added that the bank has not processed yet
+    std::shared_ptr<ChangeNotifier::Listener> m_filterListener;
+
+    void subscribeFilter()
+    {
+        m_filterListener = std::make_shared<ChangeNotifier::Listener>([this]() { filtered(); });
+        m_filter.stepped().subscribe(m_filterListener);
+    }
+
+    // called after the filter bank is stepped, handles the new filtered value
+    void filtered()
+    {
+        if (!m_awaitingFilter || m_filter.isPending()) {
+            return;
+        }
+        m_awaitingFilter = false;
+        if (m_slopeEstimator) {
+            m_slopeEstimator->add(cnl::unwrap(m_filter.read()));
+        }
+        auto newValue = value();
+        if (newValue != m_lastValue) {
+            m_lastValue = newValue;
+            m_changes.notify();
+        }
+    }
 
 public:
     explicit SetpointSensorPair(
-        std::function<std::shared_ptr<TempSensor>()>&& _sensor)
+        std::function<std::shared_ptr<TempSensor>()>&& _sensor,
+        std::shared_ptr<FilterBank> filterBank = FilterBank::defaultBank())
         : m_sensor(_sensor)
-        , m_filter(1)
+        , m_filter(std::move(filterBank), 1)
     {
+        subscribeFilter();
         update();
     }
 
+    SetpointSensorPair(SetpointSensorPair&& other)
+        : ProcessValue<temp_t>(std::move(other))
+        , m_setting(other.m_setting)
+        , m_settingEnabled(other.m_settingEnabled)
+        , m_sensor(other.m_sensor)
+        , m_filter(std::move(other.m_filter))
+        , m_sensorFailureCount(other.m_sensorFailureCount)
+        , m_slopeEstimator(std::move(other.m_slopeEstimator))
+        , m_lastValue(other.m_lastValue)
+        , m_awaitingFilter(other.m_awaitingFilter)
+    {
+        other.m_filterListener.reset(); // the moved from pair no longer owns a filter channel
+        subscribeFilter();
+    }
+
     virtual ~SetpointSensorPair() = default;
 
     virtual void setting(temp_t const& setting) override final
     {
-        m_setting = setting;
+        if (setting != m_setting) {
+            m_setting = setting;
+            m_changes.notify();
+        }
     }
 
     virtual temp_t setting() const override final
@@ -96,7 +149,10 @@ public:
 
     virtual void settingValid(bool v) override final
     {
-        m_settingEnabled = v;
+        if (v != m_settingEnabled) {
+            m_settingEnabled = v;
+            m_changes.notify();
+        }
     }
 
     auto filterChoice() const
@@ -122,20 +178,46 @@ public:
         m_filter.setStepThreshold(threshold);
     }
 
+    DerivativeSource derivativeSource() const
+    {
+        return m_slopeEstimator ? DerivativeSource::LEAST_SQUARES : DerivativeSource::FILTER;
+    }
+
+    void derivativeSource(DerivativeSource source)
+    {
+        if (source == DerivativeSource::LEAST_SQUARES) {
+            if (!m_slopeEstimator) {
+                m_slopeEstimator = std::make_unique<SlopeEstimator>();
+            }
+        } else {
+            m_slopeEstimator.reset();
+        }
+    }
+
+    // Add a new sensor value to the filter. The filtered value and the derivative are updated when the bank is stepped,
+    // which is right away for a bank without an owner and on the first read of the value otherwise.
     void update()
     {
+        auto oldValid = valueValid();
         if (sensorValid()) {
             auto val = valueUnfiltered();
             if (!valueValid()) {
                 m_filter.reset(val);
+                if (m_slopeEstimator) {
+                    m_slopeEstimator->reset();
+                }
             }
-            m_filter.add(val);
             m_sensorFailureCount = 0;
+            m_awaitingFilter = true;
+            m_filter.add(val);
         } else {
             if (m_sensorFailureCount < 255) {
                 m_sensorFailureCount++;
             }
         }
+        if (valueValid() != oldValid) {
+            m_changes.notify();
+        }
     }
 
     auto error()
@@ -143,8 +225,17 @@ public:
         return setting() - value();
     }
 
-    auto derivative(uint32_t period)
+    derivative_t derivative(uint32_t period)
     {
+        if (m_slopeEstimator) {
+            // the window follows the requested period. Samples are cleared when it changes, which should be rare
+            uint16_t window = period < UINT16_MAX ? period : UINT16_MAX;
+            if (window != m_slopeEstimator->period()) {
+                m_slopeEstimator->configure(window);
+            }
+            const uint8_t extraFractionBits = cnl::_impl::fractional_digits<derivative_t>() - cnl::_impl::fractional_digits<temp_t>();
+            return cnl::wrap<derivative_t>(m_slopeEstimator->slope(extraFractionBits));
+        }
         return m_filter.readDerivativeForInterval<derivative_t>(period);
     }
 
@@ -152,6 +243,9 @@ public:
     {
         if (sensorValid()) {
             m_filter.reset(valueUnfiltered());
+            if (m_slopeEstimator) {
+                m_slopeEstimator->reset();
+            }
             m_sensorFailureCount = 0;
         }
     }
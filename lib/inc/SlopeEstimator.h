@@ -0,0 +1,91 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#ifndef SLOPE_ESTIMATOR_MAX_WINDOW
+#define SLOPE_ESTIMATOR_MAX_WINDOW 32
+#endif
+
+/*
+ * Estimates the slope of a signal with a least squares linear fit over a sliding window of samples.
+ *
+ * The sum and the position weighted sum of the samples in the window are updated incrementally,
+ * so the cost of adding a sample and of calculating the slope does not depend on the window length.
+ * To cover a period longer than the maximum window, only one of every few samples is stored.
+ */
+class SlopeEstimator {
+public:
+    static constexpr uint8_t maxWindow = SLOPE_ESTIMATOR_MAX_WINDOW;
+
+private:
+    std::array<int32_t, maxWindow> m_values; // ring buffer of stored samples
+    int64_t m_sum = 0;                       // sum of the stored samples
+    int64_t m_weightedSum = 0;               // sum of the stored samples multiplied by their position, oldest is 0
+    uint16_t m_period = 0;                   // number of input samples covered by the window
+    uint16_t m_decimation = 1;               // one of every m_decimation input samples is stored
+    uint16_t m_skip = 0;                     // input samples to skip before the next one is stored
+    uint8_t m_window = 2;                    // number of stored samples used for the fit
+    uint8_t m_oldest = 0;
+    uint8_t m_count = 0;
+
+    static_assert(maxWindow >= 2 && maxWindow < 256, "window position is stored as uint8_t");
+
+public:
+    explicit SlopeEstimator(uint16_t period = maxWindow)
+    {
+        configure(period);
+    }
+    ~SlopeEstimator() = default;
+
+    // Set the number of input samples the fit is done over. This clears the stored samples.
+    void configure(uint16_t period);
+
+    uint16_t period() const
+    {
+        return m_period;
+    }
+
+    uint8_t window() const
+    {
+        return m_window;
+    }
+
+    uint16_t decimation() const
+    {
+        return m_decimation;
+    }
+
+    // number of samples currently used for the fit
+    uint8_t count() const
+    {
+        return m_count;
+    }
+
+    void reset();
+
+    void add(const int32_t& value);
+
+    // Returns the slope per input sample, with extraFractionBits more fraction bits than the input values.
+    // Returns 0 when there are less than 2 samples.
+    int64_t slope(uint8_t extraFractionBits) const;
+};
@@ -22,10 +22,12 @@
 #include "DallasTemperature.h"
 #include "OneWireAddress.h"
 #include "OneWireDevice.h"
+#include "OneWirePolling.h"
 #include "TempSensor.h"
 #include "Temperature.h"
 
 class OneWire;
+class TempSensorOneWireBus;
 
 #define ONEWIRE_TEMP_SENSOR_PRECISION (4)
 
@@ -35,6 +37,8 @@ private:
     DallasTemperature m_sensor;
     temp_t m_calibrationOffset;
     temp_t m_cachedValue = 0;
+    TempSensorOneWireBus* m_conversionBus = nullptr;
+    OneWirePolling m_polling; // when the conversion bus reads the sensor
 
 public:
     /**
@@ -51,7 +55,16 @@ public:
     {
     }
 
-    ~TempSensorOneWire() = default;
+    /**
+	 * Constructs a onewire temp sensor that shares the conversions of all sensors on the bus.
+	 * The conversion bus starts the conversions and reads the scratchpad, so update() does not access the bus.
+	 */
+    TempSensorOneWire(TempSensorOneWireBus& conversionBus, OneWireAddress _address = 0, const temp_t& _calibrationOffset = 0);
+
+    TempSensorOneWire(const TempSensorOneWire&) = delete;
+    TempSensorOneWire& operator=(const TempSensorOneWire&) = delete;
+
+    ~TempSensorOneWire();
 
     virtual bool valid() const override final
     {
@@ -71,16 +84,34 @@ public:
         return m_calibrationOffset;
     }
 
+    OneWirePolling& polling()
+    {
+        return m_polling;
+    }
+
+    const OneWirePolling& polling() const
+    {
+        return m_polling;
+    }
+
 private:
+    friend class TempSensorOneWireBus;
+
     void init();
 
     void connected(bool _connected);
 
     void requestConversion();
 
+    // called by the conversion bus with the scratchpad it read, or nullptr when the sensor did not respond
+    void readConversion(const uint8_t* scratchPad);
+
     /**
 	 * Reads the temperature. If successful, constrains the temp to the range of the temperature type and
 	 * updates lastRequestTime. On successful, leaves lastRequestTime alone and returns DEVICE_DISCONNECTED.
 	 */
     temp_t readAndConstrainTemp();
+
+    // handles a raw reading: re-initializes the sensor on reset and updates the connected state
+    temp_t constrainTemp(int16_t tempRaw);
 };
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "TicksTypes.h"
+#include <cstdint>
+#include <vector>
+
+class OneWire;
+class OneWireTransactions;
+class TempSensorOneWire;
+
+/*
+ * Coordinates the temperature conversions of all TempSensorOneWire objects on a bus.
+ *
+ * Instead of each sensor starting its own conversion, a single Skip ROM + Convert T starts the conversion on all sensors.
+ * All bus traffic is queued as OneWireTransactions, so update() never waits for the bus or for the conversion.
+ * When the conversion time has passed, the scratchpads of all sensors are read in one sweep and each sensor
+ * processes its own scratchpad when the read completes.
+ *
+ * Each sensor has its own polling policy: it is read in the sweep before it would become due,
+ * and no conversion is started when no sensor will be read.
+ */
+class TempSensorOneWireBus {
+public:
+    static constexpr duration_millis_t conversionTime = 750; // 12 bit resolution
+    static constexpr uint8_t readRetries = 1;                // a scratchpad with a CRC error is read again
+
+    explicit TempSensorOneWireBus(OneWireTransactions& transactions, duration_millis_t interval = 1000);
+    TempSensorOneWireBus(const TempSensorOneWireBus&) = delete;
+    TempSensorOneWireBus& operator=(const TempSensorOneWireBus&) = delete;
+    ~TempSensorOneWireBus();
+
+    OneWire& bus();
+
+    // sensors register themselves on construction
+    void add(TempSensorOneWire& sensor);
+    void remove(TempSensorOneWire& sensor);
+
+    // queues the conversion or the scratchpad reads when they are due, returns the time of the next update
+    ticks_millis_t update(const ticks_millis_t& now);
+
+    // number of bus wide conversions started
+    uint32_t conversions() const
+    {
+        return m_conversions;
+    }
+
+private:
+    enum class State : uint8_t {
+        Idle,
+        Starting,   // convert command is queued
+        Started,    // convert command is sent, start time not recorded yet
+        Converting, // waiting for the conversion time
+    };
+
+    bool readInSweep(const TempSensorOneWire& sensor, const ticks_millis_t& readTime) const;
+    void submitRead(TempSensorOneWire* sensor, uint8_t retries, duration_micros_t busTime);
+
+    OneWireTransactions& m_transactions;
+    std::vector<TempSensorOneWire*> m_sensors;
+    duration_millis_t m_interval;
+    ticks_millis_t m_lastSubmit = 0;
+    ticks_millis_t m_conversionStart = 0;
+    ticks_millis_t m_readTime = 0; // time of the last sweep, recorded as the sample time of the reads
+    uint32_t m_conversions = 0;
+    State m_state = State::Idle;
+};
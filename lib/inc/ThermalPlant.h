@@ -0,0 +1,138 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ActuatorAnalog.h"
+#include "TempSensorMock.h"
+#include "Temperature.h"
+#include "TicksTypes.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/*
+ * Simulation model of a lumped thermal mass, to test control loops in closed loop.
+ *
+ * Each input actuator heats or cools the mass in proportion to its value, after a dead time.
+ * Heat is lost to the environment in proportion to the difference with the ambient temperature.
+ * The model is updated with a fixed time step and writes its temperature to a mock sensor.
+ */
+class ThermalPlant {
+public:
+    using gain_t = temp_t; // temperature change per hour with the actuator at 100%, negative for cooling
+    using loss_t = fp12_t; // fraction of the difference with ambient that is lost per hour
+    using value_t = ActuatorAnalog::value_t;
+
+    struct Input {
+        std::function<std::shared_ptr<ActuatorAnalog>()> actuator;
+        gain_t gain;
+    };
+
+private:
+    static constexpr uint8_t extraFractionBits = 20; // precision of the temperature state, on top of temp_t
+    static constexpr int64_t extraScale = int64_t(1) << extraFractionBits; // multiply by this, values can be negative
+
+    const std::function<std::shared_ptr<TempSensorMock>()> m_sensor;
+    std::vector<Input> m_inputs;
+    int64_t m_temperature;
+    temp_t m_ambient = 20;
+    loss_t m_lossRate = 0;
+    temp_t m_maxTemperature = cnl::numeric_limits<temp_t>::max();
+    duration_millis_t m_interval;
+
+    // heating per step, delayed by the dead time
+    std::vector<int64_t> m_delayed;
+    uint16_t m_delayedIdx = 0;
+
+    ticks_millis_t m_lastUpdate = 0;
+    bool m_started = false;
+
+    void step();
+
+public:
+    explicit ThermalPlant(
+        std::function<std::shared_ptr<TempSensorMock>()>&& sensor,
+        const temp_t& initial = 20,
+        const duration_millis_t& interval = 1000);
+    ~ThermalPlant() = default;
+
+    void inputs(std::vector<Input>&& arg)
+    {
+        m_inputs = std::move(arg);
+    }
+
+    const std::vector<Input>& inputs() const
+    {
+        return m_inputs;
+    }
+
+    temp_t temperature() const;
+
+    // set the temperature of the mass, the heating that is still delayed is discarded
+    void temperature(const temp_t& val);
+
+    temp_t ambient() const
+    {
+        return m_ambient;
+    }
+
+    void ambient(const temp_t& val)
+    {
+        m_ambient = val;
+    }
+
+    loss_t lossRate() const
+    {
+        return m_lossRate;
+    }
+
+    void lossRate(const loss_t& val)
+    {
+        m_lossRate = val;
+    }
+
+    temp_t maxTemperature() const
+    {
+        return m_maxTemperature;
+    }
+
+    // the mass does not get hotter than this, for example because it boils
+    void maxTemperature(const temp_t& val)
+    {
+        m_maxTemperature = val;
+    }
+
+    duration_millis_t deadTime() const
+    {
+        return m_delayed.size() * m_interval;
+    }
+
+    // the dead time is rounded down to a whole number of time steps
+    void deadTime(const duration_millis_t& val);
+
+    duration_millis_t interval() const
+    {
+        return m_interval;
+    }
+
+    // Advance the model to now in fixed time steps. Returns the time of the next step.
+    ticks_millis_t update(const ticks_millis_t& now);
+};
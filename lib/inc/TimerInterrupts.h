@@ -1,9 +1,65 @@
+#pragma once
+
 #include <cinttypes>
-#include <functional>
 
+#ifndef PLATFORM_GCC
+#define PLATFORM_GCC 3
+#endif
+
+/*
+ * Fixed capacity table of tasks that are run from a 10 kHz timer interrupt.
+ *
+ * A task is a plain function pointer with a context pointer. The table is double buffered:
+ * add() and remove() edit the copy that the interrupt is not using and publish it with a single atomic store.
+ * The interrupt never blocks and never sees a partially edited table.
+ * When remove() returns, the task is not running and will not be called again, so its context can be destroyed.
+ *
+ * add() and remove() should only be called from the main loop.
+ */
 class TimerInterrupts {
 public:
+    using TaskFunction = void (*)(void* context);
+
+    static constexpr uint8_t capacity = 8;
+    static constexpr uint32_t frequency = 10000; // Hz
+
+    // start the timer of the backend
     static void init();
-    static int16_t add(std::function<void()>&& func);
+
+    // returns the id of the new task, or 0 when the table is full
+    static uint8_t add(TaskFunction func, void* context);
     static void remove(uint8_t id);
+    static uint8_t count();
+
+    // run all tasks once, called by the backend on each timer tick
+    static void run();
+
+#if PLATFORM_ID == PLATFORM_GCC
+    // The Linux backend runs the tasks from a real time thread after init().
+    // Without init(), the tasks only run when the simulation clock or a test calls tick().
+    static void tick(uint32_t ticks);
+
+    // stop the real time thread, it does not outlive exit()
+    static void stop();
+
+    // The real time thread skips its ticks while a Guard exists, so the main loop can access
+    // state that the tasks share with it. On the Photon the interrupt cannot be held off,
+    // the state shared there is limited to single words.
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        void unlock();
+
+    private:
+        bool locked;
+    };
+#endif
+
+private:
+    // start or stop the timer, implemented by the backend. Called when the first task is added or the last one removed
+    static void enableTimer(bool enable);
 };
@@ -63,6 +63,7 @@ ActuatorAnalogConstrained::constrain(const value_t& val)
 void
 ActuatorAnalogConstrained::setting(const value_t& val)
 {
+    auto oldSetting = actuator.setting();
     // first set actuator to requested value to check whether it constrains the setting itself
     actuator.setting(val);
     m_desiredSetting = actuator.setting();
@@ -73,6 +74,9 @@ ActuatorAnalogConstrained::setting(const value_t& val)
     } else {
         constrain(0);
     }
+    if (actuator.setting() != oldSetting) {
+        m_changes.notify();
+    }
 }
 
 void
@@ -83,5 +87,6 @@ ActuatorAnalogConstrained::settingValid(bool v)
     if (old != actuator.settingValid()) {
         // update constraints state in case setting valid has changed the limits inside the actuator itself
         constrain(actuator.setting());
+        m_changes.notify();
     }
 }
\ No newline at end of file
@@ -1,10 +1,7 @@
 #include "ActuatorPwm.h"
 #include "future_std.h"
-#include <cstdint>
-
-#if PLATFORM_ID != PLATFORM_GCC
 #include "TimerInterrupts.h"
-#endif
+#include <cstdint>
 
 ActuatorPwm::ActuatorPwm(
     std::function<std::shared_ptr<ActuatorDigitalConstrained>()>&& target_,
@@ -46,14 +43,21 @@ ActuatorPwm::dutyFraction() const
     return safe_elastic_fixed_point<2, 28>{cnl::quotient(m_dutySetting + rounder, maxDuty())};
 }
 
-#if PLATFORM_ID != PLATFORM_GCC
 void
 ActuatorPwm::manageTimerTask()
 {
     if (m_period < 1000 && m_enabled) {
         m_period = 100;
-        if (!timerFuncId) {
-            timerFuncId = TimerInterrupts::add([this]() { timerTask(); });
+        auto target = m_target();
+        if (timerFuncId && (!target || target != m_fastTarget.lock())) {
+            // target block was replaced or deleted, task is re-added below when there is a new target
+            TimerInterrupts::remove(timerFuncId);
+            timerFuncId = 0;
+            m_dutyAchieved = value_t{0};
+        }
+        if (!timerFuncId && target) {
+            m_fastTarget = std::move(target);
+            timerFuncId = TimerInterrupts::add(&ActuatorPwm::timerTaskHandler, this);
         }
     } else {
         if (timerFuncId) {
@@ -61,9 +65,9 @@ ActuatorPwm::manageTimerTask()
             timerFuncId = 0;
             m_dutyAchieved = value_t{0};
         }
+        m_fastTarget.reset();
     }
 }
-#endif
 
 void
 ActuatorPwm::period(const duration_millis_t& p)
@@ -74,28 +78,29 @@ ActuatorPwm::period(const duration_millis_t& p)
             m_period = 1000;
         }
     }
-#if PLATFORM_ID != PLATFORM_GCC
     manageTimerTask();
-#endif
 }
 
 duration_millis_t
 ActuatorPwm::period() const
 {
-#if PLATFORM_ID != PLATFORM_GCC
     if (m_period < 1000) {
         return 10; // internally 100 is used for timer based pwm, but return 10ms, the actual period
     }
-#endif
     return m_period;
 }
 
-#if PLATFORM_ID != PLATFORM_GCC
+void
+ActuatorPwm::timerTaskHandler(void* pwm)
+{
+    static_cast<ActuatorPwm*>(pwm)->timerTask();
+}
+
 void
 ActuatorPwm::timerTask()
 {
     // timer clock is 10 kHz, 100 steps at 100Hz
-    if (auto actPtr = m_target()) {
+    if (auto actPtr = m_fastTarget.lock()) {
         if (actPtr->state() != State::Active) {
             if (m_fastPwmElapsed < m_dutyTime) {
                 actPtr->setStateUnlogged(State::Active);
@@ -120,18 +125,12 @@ ActuatorPwm::timerTask()
 ActuatorPwm::update_t
 ActuatorPwm::update(const update_t& now)
 {
-    if (timerFuncId) {
+    if (m_period < 1000 && m_enabled) {
+        manageTimerTask(); // follow changes of the target block, also when it was deleted and created again
         return now + 1000;
     }
     return slowPwmUpdate(now);
 }
-#else
-ActuatorPwm::update_t
-ActuatorPwm::update(const update_t& now)
-{
-    return slowPwmUpdate(now);
-}
-#endif
 
 ActuatorPwm::update_t
 ActuatorPwm::slowPwmUpdate(const update_t& now)
@@ -21,18 +21,20 @@
 
 using value_t = ActuatorAnalog::value_t;
 
+constexpr uint8_t BalancerImpl::maxRequesters;
+constexpr uint8_t BalancerImpl::noEntry;
+
 uint8_t
 BalancerImpl::registerEntry()
 {
-    for (uint8_t id = 1; id < 255; id++) {
-        // find free id
-        auto match = find_if(requesters.begin(), requesters.end(), [&id](const Request& r) {
-            return r.id == id;
-        });
-
-        if (match == requesters.end()) {
-            requesters.push_back(Request{id, available, 0});
-            return id;
+    // find the lowest free id
+    for (uint16_t id = 1; id <= maxRequesters; id++) {
+        if (m_index[id] == noEntry) {
+            m_index[id] = requesters.size();
+            requesters.push_back(Request{uint8_t(id), available, 0});
+            m_requestedTotal = total_t(m_requestedTotal + available);
+            m_changed = true;
+            return uint8_t(id);
         }
     };
     return 0;
@@ -41,19 +43,29 @@ BalancerImpl::registerEntry()
 void
 BalancerImpl::unregisterEntry(const uint8_t& requester_id)
 {
-    requesters.erase(std::remove_if(requesters.begin(), requesters.end(), [&requester_id](const Request& r) { return r.id == requester_id; }),
-                     requesters.end());
+    auto idx = m_index[requester_id];
+    if (idx == noEntry) {
+        return;
+    }
+    m_requestedTotal = total_t(m_requestedTotal - requesters[idx].requested);
+    m_changed = true;
+    m_index[requester_id] = noEntry;
+    requesters.erase(requesters.begin() + idx);
+    // entries after the removed one have moved down
+    for (; idx < requesters.size(); ++idx) {
+        m_index[requesters[idx].id] = idx;
+    }
 }
 
 value_t
 BalancerImpl::constrain(uint8_t& requester_id, const value_t& val)
 {
-    auto match = find_if(requesters.begin(), requesters.end(), [&requester_id](const Request& r) {
-        return r.id == requester_id;
-    });
-
-    if (match != requesters.end()) {
-        match->requested = val;
+    if (auto match = find(requester_id)) {
+        if (match->requested != val) {
+            m_requestedTotal = total_t(m_requestedTotal + val - match->requested);
+            match->requested = val;
+            m_changed = true;
+        }
         return std::min(val, match->granted);
     };
 
@@ -66,29 +78,27 @@ BalancerImpl::constrain(uint8_t& requester_id, const value_t& val)
 value_t
 BalancerImpl::granted(const uint8_t& requester_id) const
 {
-    auto match = find_if(requesters.begin(), requesters.end(), [&requester_id](const Request& r) {
-        return r.id == requester_id;
-    });
-
-    if (match == requesters.end()) {
-        return 0;
+    if (auto match = find(requester_id)) {
+        return match->granted;
     }
-
-    return match->granted;
+    return 0;
 }
 
 void
 BalancerImpl::update()
 {
-    int8_t numActuators = requesters.size(); // signed, because value_t is signed too
-    if (numActuators == 0) {
+    // the granted values only depend on the requests, which are summed as they change
+    if (!m_changed) {
         return;
     }
+    m_changed = false;
 
-    auto requestedTotal = value_t(0);
-    for (const auto& a : requesters) {
-        requestedTotal += a.requested;
+    int16_t numActuators = requesters.size(); // signed, because value_t is signed too
+    if (numActuators == 0) {
+        return;
     }
+
+    auto requestedTotal = m_requestedTotal;
     auto budgetLeft = value_t(0);
     if (available > requestedTotal) {
         budgetLeft = available - requestedTotal;
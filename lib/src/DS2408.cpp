@@ -38,8 +38,7 @@ bool
 DS2408::accessWrite(uint8_t b,
                     uint8_t maxTries)
 {
-    // b |= 0xFC;        /* Upper 6 bits should be set to 1's */
-    uint8_t ack = 0;
+    bool verified = false;
 
     do {
         oneWire.reset();
@@ -51,16 +50,21 @@ DS2408::accessWrite(uint8_t b,
         oneWire.write(~b);
 
         /* Acknowledgement byte, 0xAA for success, 0xFF for failure. */
-        ack = oneWire.read();
+        uint8_t ack = oneWire.read();
 
         if (ack == ACK_SUCCESS) {
-            oneWire.read(); // status byte sent after ack
+            // PIO state sent after ack, pins with an enabled latch are pulled low
+            uint8_t pio = oneWire.read();
+            verified = (pio & ~b) == 0;
+            if (verified) {
+                m_regCache.pio = pio;
+            }
         }
-    } while ((ack != ACK_SUCCESS) && (maxTries-- > 0));
+    } while (!verified && (maxTries-- > 0));
 
     oneWire.reset();
 
-    return ack == ACK_SUCCESS;
+    return verified;
 }
 
 void
@@ -87,9 +91,9 @@ DS2408::update() const
 
     if (success != m_connected) {
         if (success) {
-            CL_LOG_INFO("DS2408 connected ") << address.toString();
+            CL_LOG_RECORD_INFO(DS2408_CONNECTED, address);
         } else {
-            CL_LOG_WARN("DS2408 disconnected ") << address.toString();
+            CL_LOG_RECORD_WARN(DS2408_DISCONNECTED, address);
         }
     }
     m_connected = success;
@@ -83,9 +83,9 @@ DS2413::update() const
     m_cachedState = accessRead();
     bool success = cacheIsValid();
     if (connected() && !success) {
-        CL_LOG_WARN("DS2413 disconnected: ") << getDeviceAddress().toString();
+        CL_LOG_RECORD_WARN(DS2413_DISCONNECTED, getDeviceAddress());
     } else if (!connected() && success) {
-        CL_LOG_INFO("DS2413 connected: ") << getDeviceAddress().toString();
+        CL_LOG_RECORD_INFO(DS2413_CONNECTED, getDeviceAddress());
     }
     m_connected = success;
     return success;
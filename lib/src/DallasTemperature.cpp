@@ -572,7 +572,7 @@ DallasTemperature::getTempFByIndex(uint8_t deviceIndex)
 // reads scratchpad and returns the raw temperature (12bit)
 
 int16_t
-DallasTemperature::calculateTemperature(const uint8_t* deviceAddress, uint8_t* scratchPad)
+DallasTemperature::calculateTemperature(const uint8_t* deviceAddress, const uint8_t* scratchPad)
 {
     int16_t rawTemperature = (((int16_t)scratchPad[TEMP_MSB]) << 8) | scratchPad[TEMP_LSB];
 
@@ -616,6 +616,16 @@ DallasTemperature::getTempRaw(const uint8_t* deviceAddress)
     if (!readScratchPadCRC(deviceAddress, scratchPad)) {
         return DEVICE_DISCONNECTED_RAW;
     }
+    return getTempRaw(deviceAddress, scratchPad);
+}
+
+// returns the raw temperature from a scratchpad that was read by the caller, checking its CRC
+int16_t
+DallasTemperature::getTempRaw(const uint8_t* deviceAddress, const uint8_t* scratchPad)
+{
+    if (_wire->crc8(scratchPad, 8) != scratchPad[SCRATCHPAD_CRC]) {
+        return DEVICE_DISCONNECTED_RAW;
+    }
     // return DEVICE_DISCONNECTED when a reset has been detected to force it to be reconfigured
     if (detectedReset(scratchPad)) {
         return RESET_DETECTED_RAW;
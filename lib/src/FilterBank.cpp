@@ -0,0 +1,315 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FilterBank.h"
+#include <algorithm>
+#include <stdlib.h>
+
+constexpr FilterBank::channel_t FilterBank::chunkSize;
+constexpr uint8_t FilterBank::taps;
+constexpr uint8_t FilterBank::numStages;
+constexpr FilterBank::Stage FilterBank::stages[];
+
+namespace {
+
+// rounded shift, same as IirFilter::unshift
+int64_t
+unshift(const int64_t val, uint8_t shift)
+{
+    const int64_t rounder = int64_t(1) << (shift - 1);
+    return (val + rounder) >> shift;
+}
+
+} // end anonymous namespace
+
+std::shared_ptr<FilterBank>
+FilterBank::defaultBank()
+{
+    static auto bank = []() {
+        auto b = std::make_shared<FilterBank>();
+        b->stepOnAdd(true);
+        return b;
+    }();
+    return bank;
+}
+
+FilterBank::channel_t
+FilterBank::addChannel(const int32_t& threshold)
+{
+    channel_t channel = 0;
+    while (channel < capacity() && chunk(channel).used[lane(channel)]) {
+        ++channel;
+    }
+    if (channel == capacity()) {
+        chunks.push_back(std::make_unique<Chunk>()); // value initialized to zero
+    }
+    auto& c = chunk(channel);
+    auto l = lane(channel);
+    c.used[l] = 1;
+    ++numUsed;
+    c.pending[l] = 0;
+    c.input[l] = 0;
+    c.counter[l] = 0;
+    c.stepThreshold[l] = threshold;
+    for (uint8_t s = 0; s < numStages; ++s) {
+        resetHistory(c, s, l, 0);
+    }
+    return channel;
+}
+
+void
+FilterBank::removeChannel(channel_t channel)
+{
+    auto& c = chunk(channel);
+    auto l = lane(channel);
+    if (c.pending[l]) {
+        c.pending[l] = 0;
+        --numPending;
+    }
+    c.input[l] = 0;
+    c.used[l] = 0;
+    --numUsed;
+}
+
+void
+FilterBank::add(channel_t channel, const int32_t& val)
+{
+    auto& c = chunk(channel);
+    auto l = lane(channel);
+    if (c.pending[l]) {
+        step();
+    }
+    c.input[l] = val;
+    c.pending[l] = 1;
+    ++numPending;
+    if (m_stepOnAdd) {
+        step();
+    }
+}
+
+void
+FilterBank::step()
+{
+    if (numPending == 0) {
+        return;
+    }
+
+    for (auto& c : chunks) {
+        std::copy_n(c->pending, chunkSize, c->active);
+    }
+    channel_t numActive = numPending;
+
+    uint8_t inputFractionBits = 0;
+    for (uint8_t s = 0; s < numStages && numActive > 0; ++s) {
+        numActive = 0;
+        for (auto& c : chunks) {
+            numActive += stepStage(*c, s, inputFractionBits);
+        }
+        inputFractionBits = params(s).shift;
+    }
+
+    const uint32_t chainPeriod = sampleInterval();
+    for (auto& c : chunks) {
+        for (uint8_t l = 0; l < chunkSize; ++l) {
+            if (c->pending[l]) {
+                c->counter[l]++;
+                if (c->counter[l] == chainPeriod) {
+                    c->counter[l] = 0;
+                }
+                c->pending[l] = 0;
+            }
+            c->input[l] = 0;
+        }
+    }
+    numPending = 0;
+    m_stepped.notify();
+}
+
+FilterBank::channel_t
+FilterBank::stepStage(Chunk& c, uint8_t s, uint8_t inputFractionBits)
+{
+    const auto& params = FilterBank::params(s);
+    const uint32_t period = FilterBank::period(s);
+    const int64_t inputScale = int64_t(1) << (params.shift - inputFractionBits);
+
+    channel_t numActive = 0;
+    for (uint8_t l = 0; l < chunkSize; ++l) {
+        if (!c.active[l]) {
+            continue;
+        }
+        // move the head of the channel back one slot for the new value, the oldest value is overwritten
+        auto& head = c.head[s][l];
+        head = (head == 0) ? FILTER_ORDER : head - 1;
+        int64_t* xh = c.xv[s][l];
+        int64_t* yh = c.yv[s][l];
+
+        const int64_t input = c.input[l] * inputScale;
+        int64_t output = params.b[0] * input;
+        // the older values follow the head and wrap around to the start of the ring
+        uint8_t t = 1;
+        for (uint8_t i = head + 1; i < taps; ++i, ++t) {
+            output += params.b[t] * xh[i];
+            output -= params.a[t] * yh[i];
+        }
+        for (uint8_t i = 0; i < head; ++i, ++t) {
+            output += params.b[t] * xh[i];
+            output -= params.a[t] * yh[i];
+        }
+        xh[head] = input;
+        yh[head] = unshift(output, params.shift);
+
+        // step detection and down sampling, like in IirFilter and FilterChain
+        int64_t thresholdAtOutPut = uint64_t(c.stepThreshold[l]) * uint64_t(params.maxDerivative);
+        if (abs(yh[head] - y(c, s, l, 1)) >= thresholdAtOutPut) {
+            resetHistory(c, s, l, input);
+        }
+        if (c.counter[l] % period != period - 1) {
+            c.active[l] = 0;
+            c.input[l] = 0;
+        } else {
+            c.input[l] = y(c, s, l, 0);
+            ++numActive;
+        }
+    }
+    return numActive;
+}
+
+void
+FilterBank::resetHistory(Chunk& c, uint8_t stage, uint8_t l, int64_t value)
+{
+    for (uint8_t t = 0; t < taps; ++t) {
+        c.xv[stage][l][t] = value;
+        c.yv[stage][l][t] = value;
+    }
+}
+
+void
+FilterBank::reset(channel_t channel, const int32_t& value)
+{
+    if (isPending(channel)) {
+        step();
+    }
+    for (uint8_t s = 0; s < numStages; ++s) {
+        resetHistory(chunk(channel), s, lane(channel), int64_t(value) * (int64_t(1) << params(s).shift));
+    }
+}
+
+void
+FilterBank::setStepThreshold(channel_t channel, const int32_t& threshold)
+{
+    if (isPending(channel)) {
+        step();
+    }
+    chunk(channel).stepThreshold[lane(channel)] = threshold;
+}
+
+int32_t
+FilterBank::getStepThreshold(channel_t channel) const
+{
+    return chunk(channel).stepThreshold[lane(channel)];
+}
+
+int32_t
+FilterBank::read(channel_t channel, uint8_t filterNr) const
+{
+    if (filterNr >= numStages) {
+        return 0;
+    }
+    return unshift(y(chunk(channel), filterNr, lane(channel), 0), params(filterNr).shift);
+}
+
+int64_t
+FilterBank::readWithNFractionBits(channel_t channel, uint8_t filterNr, uint8_t bits) const
+{
+    if (filterNr >= numStages) {
+        return 0;
+    }
+    auto shift = params(filterNr).shift;
+    auto value = y(chunk(channel), filterNr, lane(channel), 0);
+    if (bits >= shift) {
+        return value * (int64_t(1) << (bits - shift));
+    }
+    return unshift(value, shift - bits);
+}
+
+int32_t
+FilterBank::readLastInput(channel_t channel) const
+{
+    return unshift(x(chunk(channel), 0, lane(channel), 0), params(0).shift);
+}
+
+IirFilter::DerivativeResult
+FilterBank::readDerivative(channel_t channel, uint8_t filterNr) const
+{
+    if (filterNr >= numStages) {
+        filterNr = numStages - 1;
+    }
+    const auto& c = chunk(channel);
+    IirFilter::DerivativeResult retv{y(c, filterNr, lane(channel), 0) - y(c, filterNr, lane(channel), 1), fractionBits(filterNr)};
+    // Scale back derivative to account for sample interval in slower updating stages
+    auto inputSamplesPerOutputChange = filterNr > 0 ? sampleInterval(filterNr - 1) : 1;
+    retv.result = retv.result / inputSamplesPerOutputChange;
+    return retv;
+}
+
+uint32_t
+FilterBank::getCount(channel_t channel) const
+{
+    return chunk(channel).counter[lane(channel)];
+}
+
+uint32_t
+FilterBank::sampleInterval(uint8_t filterNr) const
+{
+    if (filterNr >= numStages) {
+        return 1;
+    }
+    return period(filterNr);
+}
+
+uint32_t
+FilterBank::sampleInterval() const
+{
+    return sampleInterval(numStages - 1);
+}
+
+uint8_t
+FilterBank::intervalToFilterNr(uint32_t maxInterval) const
+{
+    uint8_t filterNr = 0;
+    uint32_t stageInterval = 1;
+    for (uint8_t s = 1; s < numStages; s++) {
+        stageInterval *= stages[s].interval;
+        if (stageInterval < maxInterval) {
+            filterNr++;
+        } else {
+            break;
+        }
+    }
+    return filterNr;
+}
+
+uint8_t
+FilterBank::fractionBits(uint8_t filterNr) const
+{
+    if (filterNr >= numStages) {
+        return params(numStages - 1).shift;
+    }
+    return params(filterNr).shift;
+}
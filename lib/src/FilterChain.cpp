@@ -18,6 +18,7 @@
  */
 
 #include <FilterChain.h>
+#include <algorithm>
 #include <limits>
 #include <memory>
 
@@ -57,6 +58,51 @@ FilterChain::add(const int32_t& val)
     }
 }
 
+void
+FilterChain::add(const int32_t* vals, size_t count)
+{
+    // Values are processed in blocks, stage by stage. Each stage filters all its input values for the block and
+    // writes the values that the next stage should receive to the front of the buffer.
+    constexpr size_t blockSize = 16;
+    int64_t buffer[blockSize];
+
+    while (count > 0) {
+        const size_t blockCount = std::min(count, blockSize);
+        std::copy(vals, vals + blockCount, buffer);
+
+        size_t n = blockCount;
+        uint32_t inputPeriod = 1; // number of chain inputs per input of this stage
+        uint8_t inputFractionBits = 0;
+        for (auto& s : stages) {
+            // number of inputs this stage has received since its last output
+            uint32_t phase = (counter / inputPeriod) % s.interval;
+            size_t out = 0;
+            for (size_t i = 0; i < n; ++i) {
+                s.filter.add(buffer[i], inputFractionBits);
+                if (phase == s.interval - 1u) {
+                    buffer[out++] = s.filter.readWithNFractionBits(s.filter.fractionBits());
+                    phase = 0;
+                } else {
+                    ++phase;
+                }
+            }
+            n = out;
+            if (n == 0) {
+                break;
+            }
+            inputPeriod *= s.interval;
+            inputFractionBits = s.filter.fractionBits();
+        }
+
+        // same as incrementing the counter for each value
+        uint32_t period = sampleInterval();
+        counter = (counter < period) ? (counter + blockCount) % period : counter + blockCount;
+
+        vals += blockCount;
+        count -= blockCount;
+    }
+}
+
 void
 FilterChain::reset(const int32_t& value)
 {
@@ -5,12 +5,147 @@
 #include "../inc/IirFilter.h"
 #include <stdlib.h>
 
+namespace {
+
+// Try out these filters in pyFDA to view Magnitude response and stability
+constexpr IirFilter::FilterParams availableFilters[] = {
+    // 0 - Bessel 6th order, -60 dB > 1/4 FS, To downsample 2x. -3dB at 0.0575 FS
+    {
+        {
+            34,
+            202,
+            506,
+            675,
+            506,
+            202,
+            34,
+        },
+        {
+            131072,
+            -449749,
+            672637,
+            -556881,
+            267670,
+            -70519,
+            7929,
+        },
+        17,
+        2,
+        20773,
+    },
+    // 1 - Bessel 6th order, -50 dB > 1/4 FS, To downsample 2x. -3dB at 0.069 FS
+    {
+        {
+            77,
+            460,
+            1149,
+            1531,
+            1149,
+            460,
+            77,
+        },
+        {
+            131072,
+            -394137,
+            530035,
+            -401475,
+            178825,
+            -44094,
+            4677,
+        },
+        17,
+        2,
+        24599,
+    },
+    // 2 - Bessel 6th order, -40 dB > 1/8 FS, To downsample 4x. Fc at 0.06125, -3dB at 0.035 FS
+    {
+        {
+            3,
+            18,
+            46,
+            61,
+            46,
+            18,
+            3,
+        },
+        {
+            131072,
+            -569338,
+            1045651,
+            -1037968,
+            586655,
+            -178824,
+            22947,
+        },
+        17,
+        4,
+        13073,
+    },
+};
+
+constexpr uint8_t numFilters = sizeof(availableFilters) / sizeof(availableFilters[0]);
+
+constexpr uint8_t
+validIdx(const uint8_t idx)
+{
+    return idx < numFilters ? idx : 0;
+}
+
+constexpr uint8_t
+ringIndex(const uint8_t head, const uint8_t age)
+{
+    return head + age > FILTER_ORDER ? head + age - (FILTER_ORDER + 1) : head + age;
+}
+
+// Adds the terms for one tap of the history and recurses to the next, so the compiler generates a straight
+// multiply-accumulate sequence with the coefficients of the filter as constants.
+template <uint8_t idx, uint8_t tap = 1>
+struct Taps {
+    static int64_t accumulate(int64_t output, const int64_t* xv, const int64_t* yv, uint8_t head)
+    {
+        const uint8_t pos = ringIndex(head, tap);
+        output += availableFilters[idx].b[tap] * xv[pos]; // 19 bits max + 24 bits + 16 bits = 59 bits max
+        output -= availableFilters[idx].a[tap] * yv[pos]; // 19 bits max + 24 bits + 16 bits = 59 bits max
+        return Taps<idx, tap + 1>::accumulate(output, xv, yv, head);
+    }
+};
+
+template <uint8_t idx>
+struct Taps<idx, FILTER_ORDER + 1> {
+    static int64_t accumulate(int64_t output, const int64_t*, const int64_t*, uint8_t)
+    {
+        return output;
+    }
+};
+
+// Calculates the new output. xv[head] should already hold the new input. The value at yv[head] is not used.
+template <uint8_t idx>
+int64_t
+filterKernel(const int64_t* xv, const int64_t* yv, uint8_t head)
+{
+    constexpr uint8_t shift = availableFilters[idx].shift;
+    const int64_t output = Taps<idx>::accumulate(availableFilters[idx].b[0] * xv[head], xv, yv, head);
+    return (output + (int64_t(1) << (shift - 1))) >> shift; // rounded shift, same as IirFilter::unshift
+}
+
+// indexed by filter number, like availableFilters
+constexpr int64_t (*kernels[])(const int64_t*, const int64_t*, uint8_t) = {
+    filterKernel<0>,
+    filterKernel<1>,
+    filterKernel<2>,
+};
+
+static_assert(sizeof(kernels) / sizeof(kernels[0]) == numFilters, "each filter definition needs a kernel");
+
+} // end anonymous namespace
+
 IirFilter::IirFilter(const uint8_t& idx, const int32_t& threshold)
     : xv{0}
     , yv{0}
-    , paramsIdx(idx)
+    , head(0)
     , fastStepThreshold(threshold)
 {
+    selectParams(idx);
 }
 
 IirFilter::~IirFilter()
@@ -38,22 +173,10 @@ IirFilter::add(const int32_t val)
 bool
 IirFilter::add(const int64_t val, uint8_t fractionBits)
 {
-    int64_t output = 0;
-    FilterParams const& paramsRef = params();
-
-    // shift input/output history by 1 position
-    for (uint8_t i = FILTER_ORDER; i >= 1; i--) {
-        xv[i] = xv[i - 1];
-        yv[i] = yv[i - 1];
-    }
-    xv[0] = shift(val, params().shift - fractionBits);
-
-    output = paramsRef.b[0] * xv[0];
-    for (uint8_t i = 1; i <= FILTER_ORDER; i++) {
-        output += paramsRef.b[i] * xv[i]; // 19 bits max + 24 bits + 16 bits = 59 bits max
-        output -= paramsRef.a[i] * yv[i]; // 19 bits max + 24 bits + 16 bits = 59 bits max
-    }
-    yv[0] = unshift(output); // rounded shift
+    // move the ring buffer head back 1 position, it now points to the oldest values, which are overwritten
+    head = (head == 0) ? FILTER_ORDER : head - 1;
+    xv[head] = shift(val, params().shift - fractionBits);
+    yv[head] = kernel(xv, yv, head);
 
     // If the output of filter is rising fast, we detect this as a step and copy the input directly to the output history
     // To prevent false triggers (not a step), we take the difference between the last 2 outputs instead of the input.
@@ -61,8 +184,8 @@ IirFilter::add(const int64_t val, uint8_t fractionBits)
     // All values of the output history are set to the new value to prevent instability
 
     int64_t thresholdAtOutPut = uint64_t(fastStepThreshold) * uint64_t(params().maxDerivative);
-    if (abs(yv[0] - yv[1]) >= thresholdAtOutPut) {
-        resetInternal(xv[0]);
+    if (abs(yv[head] - yv[historyIndex(1)]) >= thresholdAtOutPut) {
+        resetInternal(xv[head]);
         return true;
     }
     return false;
@@ -87,16 +210,16 @@ IirFilter::resetInternal(const int64_t& value)
 int32_t
 IirFilter::read(void) const
 {
-    return unshift(yv[0]);
+    return unshift(yv[head]);
 }
 
 int64_t
 IirFilter::readWithNFractionBits(uint8_t bits) const
 {
     if (bits >= params().shift) {
-        return shift(yv[0], bits - params().shift);
+        return shift(yv[head], bits - params().shift);
     }
-    return unshift(yv[0], params().shift - bits);
+    return unshift(yv[head], params().shift - bits);
 }
 
 int64_t
@@ -128,96 +251,18 @@ IirFilter::unshift(const int64_t val, uint8_t shift) const
     return rounded >> shift;
 }
 
-// Try out these filters in pyFDA to view Magnitude response and stability
 IirFilter::FilterParams const&
 IirFilter::FilterDefinition(const uint8_t idx)
 {
-    static const FilterParams availableFilters[] = {
-        // 0 - Bessel 6th order, -60 dB > 1/4 FS, To downsample 2x. -3dB at 0.0575 FS
-        {
-            {
-                34,
-                202,
-                506,
-                675,
-                506,
-                202,
-                34,
-            },
-            {
-                131072,
-                -449749,
-                672637,
-                -556881,
-                267670,
-                -70519,
-                7929,
-            },
-            17,
-            2,
-            20773,
-        },
-        // 1 - Bessel 6th order, -50 dB > 1/4 FS, To downsample 2x. -3dB at 0.069 FS
-        {
-            {
-                77,
-                460,
-                1149,
-                1531,
-                1149,
-                460,
-                77,
-            },
-            {
-                131072,
-                -394137,
-                530035,
-                -401475,
-                178825,
-                -44094,
-                4677,
-            },
-            17,
-            2,
-            24599,
-        },
-        // 2 - Bessel 6th order, -40 dB > 1/8 FS, To downsample 4x. Fc at 0.06125, -3dB at 0.035 FS
-        {
-            {
-                3,
-                18,
-                46,
-                61,
-                46,
-                18,
-                3,
-            },
-            {
-                131072,
-                -569338,
-                1045651,
-                -1037968,
-                586655,
-                -178824,
-                22947,
-            },
-            17,
-            4,
-            13073,
-        },
-    };
-
-    if (idx < sizeof(availableFilters) / sizeof(availableFilters[0])) {
-        return availableFilters[idx];
-    } else {
-        return availableFilters[0];
-    }
+    return availableFilters[validIdx(idx)];
 }
 
-IirFilter::FilterParams const&
-IirFilter::params() const
+void
+IirFilter::selectParams(const uint8_t idx)
 {
-    return FilterDefinition(paramsIdx);
+    paramsIdx = idx;
+    paramsPtr = &availableFilters[validIdx(idx)];
+    kernel = kernels[validIdx(idx)];
 }
 
 void
@@ -225,7 +270,7 @@ IirFilter::setParamsIdx(const uint8_t idx)
 {
     // reset filter (all history same value) to prevent instability
     int64_t oldValue = readWithNFractionBits(FilterDefinition(idx).shift);
-    paramsIdx = idx;
+    selectParams(idx);
     reset(oldValue);
 }
 
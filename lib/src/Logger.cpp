@@ -0,0 +1,117 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Logger.h"
+#include "OneWireAddress.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+
+enum class ArgFormat : uint8_t {
+    NONE,
+    NUMBER,
+    ONEWIRE_ADDRESS,
+};
+
+struct LogCodeInfo {
+    const char* msg;
+    ArgFormat arg;
+};
+
+// indexed by Logger::LogCode
+const LogCodeInfo logCodeInfo[] = {
+    {"Log buffer full, records dropped: ", ArgFormat::NUMBER},
+    {"DS2413 connected: ", ArgFormat::ONEWIRE_ADDRESS},
+    {"DS2413 disconnected: ", ArgFormat::ONEWIRE_ADDRESS},
+    {"DS2408 connected: ", ArgFormat::ONEWIRE_ADDRESS},
+    {"DS2408 disconnected: ", ArgFormat::ONEWIRE_ADDRESS},
+    {"OneWire temp sensor connected: ", ArgFormat::ONEWIRE_ADDRESS},
+    {"OneWire temp sensor disconnected: ", ArgFormat::ONEWIRE_ADDRESS},
+};
+
+char
+hexDigit(uint8_t b)
+{
+    return ((b > 9) ? b - 10 + 'A' : b + '0');
+}
+
+} // end anonymous namespace
+
+size_t
+Logger::format(const LogRecord& record, char* buf, size_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+    auto idx = size_t(record.code);
+    if (idx >= sizeof(logCodeInfo) / sizeof(logCodeInfo[0])) {
+        return size_t(snprintf(buf, len, "[%" PRIu32 "] Unknown log code %u", record.timestamp, unsigned(idx)));
+    }
+    const auto& info = logCodeInfo[idx];
+
+    int written = snprintf(buf, len, "[%" PRIu32 "] %s", record.timestamp, info.msg);
+    if (written < 0) {
+        buf[0] = 0;
+        return 0;
+    }
+    size_t pos = std::min(size_t(written), len - 1);
+
+    switch (info.arg) {
+    case ArgFormat::NONE:
+        break;
+    case ArgFormat::NUMBER:
+        written = snprintf(buf + pos, len - pos, "%" PRIu32, uint32_t(record.arg));
+        if (written > 0) {
+            pos = std::min(pos + size_t(written), len - 1);
+        }
+        break;
+    case ArgFormat::ONEWIRE_ADDRESS: {
+        // same format as OneWireAddress::toString()
+        auto address = OneWireAddress(record.arg);
+        auto const addr = address.asUint8ptr();
+        for (auto bytePtr = addr; bytePtr < addr + 8 && pos + 2 < len; ++bytePtr) {
+            buf[pos++] = hexDigit((*bytePtr >> 4) & 0x0f);
+            buf[pos++] = hexDigit((*bytePtr) & 0x0f);
+        }
+        buf[pos] = 0;
+    } break;
+    }
+    return pos;
+}
+
+void
+Logger::drain()
+{
+    char buf[64];
+    while (m_count > 0) {
+        const auto& record = m_records[m_head];
+        format(record, buf, sizeof(buf));
+        m_head = (m_head + 1) % m_records.size();
+        --m_count;
+        m_logWriteFunction(record.level, buf);
+    }
+    if (m_dropped != m_droppedReported) {
+        LogRecord overflow{m_timeFunction ? m_timeFunction() : 0, m_dropped - m_droppedReported, WARN, LogCode::LOG_BUFFER_OVERFLOW};
+        m_droppedReported = m_dropped;
+        format(overflow, buf, sizeof(buf));
+        m_logWriteFunction(overflow.level, buf);
+    }
+}
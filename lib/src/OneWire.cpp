@@ -115,6 +115,21 @@ sample code bearing this copyright.
  */
 
 #include "../inc/OneWire.h"
+#include "../inc/OneWireTransactions.h"
+
+void
+OneWire::finishTransactions()
+{
+    if (m_transactions) {
+        m_transactions->finish();
+    }
+}
+
+bool
+OneWire::transactionInProgress() const
+{
+    return m_transactions && m_transactions->inProgress();
+}
 
 void
 OneWire::write_bytes(const uint8_t* buf, uint16_t count)
@@ -228,7 +243,7 @@ OneWire::search(uint8_t* newAddr)
     // if the last call was not the last one
     if (!LastDeviceFlag) {
         // 1-Wire reset
-        if (!driver.reset()) {
+        if (!reset()) {
             // reset the search
             LastDiscrepancy = 0;
             LastDeviceFlag = FALSE;
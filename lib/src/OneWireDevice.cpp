@@ -18,6 +18,36 @@ OneWireDevice::OneWireDevice(OneWire& oneWire_, const OneWireAddress& address_)
     : oneWire(oneWire_)
     , address(address_)
 {
+    registerAddress();
+}
+
+OneWireDevice::OneWireDevice(const OneWireDevice& other)
+    : OneWireDevice(other.oneWire, other.address)
+{
+}
+
+OneWireDevice::~OneWireDevice()
+{
+    unregisterAddress();
+}
+
+void
+OneWireDevice::registerAddress()
+{
+    if (address) {
+        oneWire.m_deviceAddresses.insert(uint64_t(address));
+    }
+}
+
+void
+OneWireDevice::unregisterAddress()
+{
+    if (address) {
+        auto it = oneWire.m_deviceAddresses.find(uint64_t(address));
+        if (it != oneWire.m_deviceAddresses.end()) {
+            oneWire.m_deviceAddresses.erase(it); // only one, other objects can use the same address
+        }
+    }
 }
 
 /**
@@ -37,7 +67,9 @@ OneWireDevice::getDeviceAddress() const
 void
 OneWireDevice::setDeviceAddress(const OneWireAddress& addr)
 {
+    unregisterAddress();
     address = addr;
+    registerAddress();
 }
 
 /**
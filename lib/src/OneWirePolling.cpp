@@ -0,0 +1,84 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/OneWirePolling.h"
+#include <algorithm>
+
+constexpr duration_millis_t OneWirePolling::defaultInterval;
+constexpr duration_millis_t OneWirePolling::idleInterval;
+constexpr duration_millis_t OneWirePolling::maxBackoff;
+
+namespace {
+
+// moving average with a weight of 1/4 for the new value, starts at the first value
+uint32_t
+average(uint32_t avg, uint32_t value)
+{
+    if (avg == 0) {
+        return value;
+    }
+    return uint32_t(int64_t(avg) + (int64_t(value) - int64_t(avg)) / 4);
+}
+
+} // end anonymous namespace
+
+duration_millis_t
+OneWirePolling::currentInterval() const
+{
+    if (m_failures > 0) {
+        // double the interval for each failure, but not beyond the maximum
+        uint8_t shift = std::min(m_failures, uint8_t(16));
+        return std::max(m_interval, std::min(maxBackoff, m_interval << shift));
+    }
+    if (m_mode == Mode::OnDemand && !m_demanded) {
+        return std::max(m_interval, idleInterval);
+    }
+    return m_interval;
+}
+
+void
+OneWirePolling::polled(const ticks_millis_t& now, bool success, duration_micros_t busTime)
+{
+    if (m_polls != 0) {
+        m_pollInterval = average(m_pollInterval, now - m_lastPoll);
+    }
+    if (success) {
+        if (m_samples != 0) {
+            m_sampleInterval = average(m_sampleInterval, now - m_lastSample);
+        }
+        m_lastSample = now;
+        ++m_samples;
+        m_failures = 0;
+    } else if (m_failures < 255) {
+        ++m_failures;
+    }
+    m_busTime = average(m_busTime, busTime);
+    m_lastPoll = now;
+    ++m_polls;
+    m_demanded = false;
+}
+
+duration_micros_t
+OneWirePolling::busLoad() const
+{
+    if (m_pollInterval == 0) {
+        return 0;
+    }
+    return uint32_t(uint64_t(m_busTime) * 1000 / m_pollInterval);
+}
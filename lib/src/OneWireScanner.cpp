@@ -0,0 +1,55 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/OneWireScanner.h"
+#include <algorithm>
+
+constexpr uint16_t OneWireScanner::stepsPerUpdate;
+constexpr duration_millis_t OneWireScanner::scanInterval;
+
+ticks_millis_t
+OneWireScanner::update(const ticks_millis_t& now)
+{
+    if (!m_scanning) {
+        if (!m_requested && int32_t(now - m_nextScan) < 0) {
+            return m_nextScan;
+        }
+        m_search.reset();
+        m_scanned.clear();
+        m_scanning = true;
+        m_requested = false;
+    }
+
+    OneWireAddress found;
+    if (m_search.step(found, stepsPerUpdate)) {
+        m_scanned.push_back(found);
+        if (std::find(m_devices.begin(), m_devices.end(), found) == m_devices.end()) {
+            m_devices.push_back(found);
+        }
+    }
+
+    if (!m_search.done()) {
+        return now + 1;
+    }
+    m_devices.swap(m_scanned);
+    m_scanning = false;
+    ++m_completedScans;
+    m_nextScan = now + scanInterval;
+    return m_requested ? now + 1 : m_nextScan;
+}
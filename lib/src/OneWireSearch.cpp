@@ -0,0 +1,107 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/OneWireSearch.h"
+#include "../inc/OneWire.h"
+#include <algorithm>
+
+void
+OneWireSearch::reset()
+{
+    std::fill(m_rom, m_rom + 8, 0);
+    m_lastDiscrepancy = 0;
+    m_done = false;
+    active(false);
+}
+
+void
+OneWireSearch::active(bool v)
+{
+    if (m_active != v) {
+        m_active = v;
+        m_bus.hold(v);
+    }
+}
+
+void
+OneWireSearch::romBit(uint8_t bit, bool value)
+{
+    uint8_t mask = 1 << ((bit - 1) % 8);
+    if (value) {
+        m_rom[(bit - 1) / 8] |= mask;
+    } else {
+        m_rom[(bit - 1) / 8] &= ~mask;
+    }
+}
+
+bool
+OneWireSearch::step(OneWireAddress& found, uint16_t maxSteps)
+{
+    for (uint16_t steps = 0; steps < maxSteps && !m_done; ++steps) {
+        if (m_active && m_bus.resets() != m_resetsAtStart) {
+            // the bus was used by someone else, the devices are no longer in the search
+            active(false);
+            ++m_restarts;
+        }
+
+        if (!m_active) {
+            if (m_bus.transactionInProgress()) {
+                break; // start the next device between two transactions, instead of waiting for the one in progress
+            }
+            if (!m_bus.reset()) {
+                m_done = true; // no devices
+                break;
+            }
+            m_bus.write(0xF0); // search ROM
+            m_resetsAtStart = m_bus.resets();
+            active(true);
+            m_bit = 1;
+            m_lastZero = 0;
+            continue;
+        }
+
+        // take the same path as the previous device up to the last discrepancy, then take the 1 branch
+        uint8_t direction = m_bit < m_lastDiscrepancy ? romBit(m_bit) : m_bit == m_lastDiscrepancy;
+        uint8_t idBit;
+        uint8_t cmpIdBit;
+        m_bus.search_triplet(&direction, &idBit, &cmpIdBit);
+
+        if (idBit && cmpIdBit) {
+            // no devices responded
+            active(false);
+            m_done = true;
+            break;
+        }
+        if (!idBit && !cmpIdBit && direction == 0) {
+            m_lastZero = m_bit; // discrepancy: the 1 branch is searched later
+        }
+        romBit(m_bit, direction);
+
+        if (m_bit++ == 64) {
+            active(false);
+            m_lastDiscrepancy = m_lastZero;
+            m_done = m_lastDiscrepancy == 0;
+            if (OneWire::crc8(m_rom, 7) == m_rom[7]) {
+                std::copy(m_rom, m_rom + 8, found.asUint8ptr());
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/OneWireTransactions.h"
+#include "../inc/OneWire.h"
+#include <algorithm>
+
+constexpr uint8_t OneWireTransaction::maxBytes;
+constexpr uint8_t OneWireTransactions::maxPending;
+constexpr duration_micros_t OneWireTransactions::busyTimeout;
+
+OneWireTransaction::OneWireTransaction(const OneWireAddress& address_, std::initializer_list<uint8_t> writeBytes, uint8_t readCount_,
+                                       const void* owner_, Completion onDone_)
+    : address(address_)
+    , writeCount(uint8_t(std::min(writeBytes.size(), size_t(maxBytes))))
+    , readCount(std::min(readCount_, uint8_t(maxBytes - writeCount)))
+    , owner(owner_)
+    , onDone(std::move(onDone_))
+{
+    std::copy(writeBytes.begin(), writeBytes.begin() + writeCount, data);
+}
+
+OneWireTransactions::OneWireTransactions(OneWire& bus, Clock clock)
+    : m_bus(bus)
+    , m_clock(std::move(clock))
+{
+    m_bus.m_transactions = this;
+}
+
+OneWireTransactions::~OneWireTransactions()
+{
+    m_bus.m_transactions = nullptr;
+}
+
+bool
+OneWireTransactions::submit(OneWireTransaction&& transaction)
+{
+    if (m_queue.size() >= maxPending) {
+        return false;
+    }
+    m_queue.push_back(Entry{std::move(transaction), m_clock()});
+    return true;
+}
+
+void
+OneWireTransactions::cancel(const void* owner)
+{
+    if (!m_queue.empty() && m_queue.front().transaction.owner == owner) {
+        // the transaction in progress can be dropped, the next one starts with a reset
+        m_phase = Phase::Reset;
+        m_index = 0;
+        m_waiting = false;
+    }
+    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), [owner](const Entry& e) {
+                      return e.transaction.owner == owner;
+                  }),
+                  m_queue.end());
+}
+
+bool
+OneWireTransactions::process(duration_micros_t budget)
+{
+    if (m_bus.held()) {
+        return m_queue.empty(); // a reset would drop the devices from the search
+    }
+    auto start = m_clock();
+    auto elapsed = duration_micros_t(0);
+    auto faults = m_stats.driverFaults;
+    while (!m_queue.empty() && elapsed < budget && m_stats.driverFaults == faults) {
+        bool stepped = step();
+        elapsed = m_clock() - start;
+        if (!stepped) {
+            break; // the driver is busy, continue on the next pass instead of polling it again
+        }
+    }
+    m_stats.maxPass = std::max(m_stats.maxPass, elapsed);
+    return m_queue.empty();
+}
+
+void
+OneWireTransactions::finish()
+{
+    if (m_queue.empty() || m_phase == Phase::Reset) {
+        return; // nothing on the bus yet
+    }
+    // the completion can submit new transactions, only finish the current one.
+    // step() fails the transaction when the driver is hung, so this ends.
+    auto done = m_stats.completed + m_stats.failed;
+    while (m_stats.completed + m_stats.failed == done) {
+        step();
+    }
+}
+
+bool
+OneWireTransactions::step()
+{
+    auto& driver = m_bus.driver;
+    if (driver.busy()) {
+        auto now = m_clock();
+        if (!m_waiting) {
+            m_waiting = true;
+            m_busySince = now;
+        } else if (now - m_busySince > busyTimeout) {
+            driverFault();
+            return true;
+        }
+        return false;
+    }
+    m_waiting = false;
+    if (driver.failed()) {
+        driverFault();
+        return true;
+    }
+
+    auto& t = m_queue.front().transaction;
+    switch (m_phase) {
+    case Phase::Reset:
+        m_started = m_clock();
+        ++m_bus.m_resets;
+        driver.startReset();
+        m_phase = Phase::Presence;
+        break;
+    case Phase::Presence:
+        if (!driver.presence()) {
+            complete(false);
+            break;
+        }
+        m_phase = Phase::RomCommand;
+        break;
+    case Phase::RomCommand:
+        m_index = 0;
+        if (t.address == 0) {
+            driver.startWrite(0xCC); // skip ROM
+            m_phase = Phase::Write;
+        } else {
+            driver.startWrite(0x55); // match ROM
+            m_phase = Phase::Address;
+        }
+        break;
+    case Phase::Address:
+        driver.startWrite(t.address.asUint8ptr()[m_index++]);
+        if (m_index == 8) {
+            m_index = 0;
+            m_phase = Phase::Write;
+        }
+        break;
+    case Phase::Write:
+        if (m_index < t.writeCount) {
+            driver.startWrite(t.data[m_index++]);
+            break;
+        }
+        m_index = 0;
+        m_phase = Phase::Read;
+        // fall through
+    case Phase::Read:
+        if (m_index < t.readCount) {
+            driver.startRead();
+            m_phase = Phase::ReadResult;
+            break;
+        }
+        complete(true);
+        break;
+    case Phase::ReadResult:
+        t.data[t.writeCount + m_index++] = driver.readResult();
+        if (driver.failed()) {
+            driverFault();
+            break;
+        }
+        m_phase = Phase::Read;
+        break;
+    }
+    return true;
+}
+
+void
+OneWireTransactions::driverFault()
+{
+    ++m_stats.driverFaults;
+    if (m_phase == Phase::Reset) {
+        m_started = m_clock(); // nothing was started on the bus
+    }
+    complete(false);
+}
+
+void
+OneWireTransactions::complete(bool success)
+{
+    auto now = m_clock();
+    auto latency = now - m_queue.front().submitted;
+    m_stats.maxLatency = std::max(m_stats.maxLatency, latency);
+    if (success) {
+        ++m_stats.completed;
+    } else {
+        ++m_stats.failed;
+    }
+
+    // remove it from the queue before calling the completion, which can submit or cancel transactions
+    OneWireTransaction t = std::move(m_queue.front().transaction);
+    m_queue.pop_front();
+    m_phase = Phase::Reset;
+    m_index = 0;
+    m_waiting = false;
+
+    t.success = success;
+    t.busTime = now - m_started;
+    if (t.onDone) {
+        t.onDone(t);
+    }
+}
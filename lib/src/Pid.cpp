@@ -19,47 +19,100 @@
 
 #include "../inc/Pid.h"
 #include "../inc/future_std.h"
+#include <limits>
+
+// The PID calculations are done on the raw integers of the fixed point types.
+// This avoids the saturated wide integer arithmetic that cnl generates for each operation.
+// Each step replicates the rounding and saturation of the cnl expression it replaces:
+// - scaling down to fewer fraction bits truncates towards zero, like an integer division
+// - assigning to a fixed point type saturates to its symmetric range
+namespace {
+
+constexpr int32_t fp12Max = (int32_t(1) << 23) - 1;     // fp12_t, 11 integer and 12 fraction bits
+constexpr int32_t integralMax = (int32_t(1) << 30) - 1; // Pid::integral_t, 18 integer and 12 fraction bits
+
+inline int32_t
+saturate(int64_t v, int32_t max)
+{
+    return v > max ? max : (v < -max ? -max : int32_t(v));
+}
+
+inline int64_t
+scaleDown(int64_t v, uint8_t shift)
+{
+    return v / (int64_t(1) << shift);
+}
+
+inline int32_t
+raw(const fp12_t& v)
+{
+    return int32_t(cnl::unwrap(v));
+}
+
+inline int32_t
+raw(const Pid::integral_t& v)
+{
+    return int32_t(cnl::unwrap(v));
+}
+
+// excess / kp as out_t. Equal to converting cnl::quotient(excess, kp) to out_t
+inline int32_t
+divideByKp(int32_t excess, int32_t kp)
+{
+    return saturate((int64_t(excess) << 12) / kp, fp12Max);
+}
+
+} // end anonymous namespace
 
 void
 Pid::update()
 {
     auto input = m_inputPtr();
-    auto setpoint = in_t{0};
+    int32_t integral = raw(m_integral);
     if (input && input->settingValid() && input->valueValid()) {
         if (m_enabled) {
             active(true);
         }
-        setpoint = input->setting();
-        m_boilModeActive = setpoint >= in_t{100} + m_boilPointAdjust;
+        m_boilModeActive = raw(input->setting()) >= m_boilThreshold;
         m_error = input->error();
         m_derivative = m_td ? input->derivative(m_td / 2) : 0;
-        m_integral = (m_ti != 0 && !m_boilModeActive) ? integral_t(m_integral + m_error) : integral_t(0);
+        integral = (m_ti != 0 && !m_boilModeActive) ? saturate(int64_t(integral) + raw(m_error), integralMax) : 0;
     } else {
         if (active()) {
             active(false);
         }
-        m_integral = 0;
+        integral = 0;
     }
+    m_integral = cnl::wrap<integral_t>(integral);
     if (!active()) {
         return;
     }
 
     // calculate PID parts.
+    const int32_t kp = raw(m_kp);
+    const int32_t error = raw(m_error);
 
-    m_p = m_kp * m_error;
+    const int32_t p = saturate(scaleDown(int64_t(kp) * error, 12), fp12Max);
+    m_p = cnl::wrap<out_t>(p);
 
+    int32_t i = raw(m_i);
     if (m_ti != 0) {
-        m_i = m_integral * safe_elastic_fixed_point<4, 27>(cnl::quotient(m_kp, m_ti));
+        // m_ki is kp / ti with 27 fraction bits
+        i = saturate(scaleDown(int64_t(integral) * m_ki, 27), fp12Max);
+        m_i = cnl::wrap<out_t>(i);
     }
 
-    m_d = -m_kp * fp12_t(m_derivative * m_td);
+    // derivative has 23 fraction bits, derivative * td is scaled to 12 fraction bits before multiplying with kp
+    const int32_t derivativeTd = saturate(scaleDown(int64_t(cnl::unwrap(m_derivative)) * m_td, 11), fp12Max);
+    const int32_t d = saturate(scaleDown(-int64_t(kp) * derivativeTd, 12), fp12Max);
+    m_d = cnl::wrap<out_t>(d);
 
-    auto pidResult = m_p + m_i + m_d;
+    const int32_t pidResult = p + i + d; // not saturated, used for anti-windup
 
-    out_t outputValue = pidResult;
+    int32_t outputValue = saturate(pidResult, fp12Max);
 
     if (m_boilModeActive) {
-        outputValue = std::max(outputValue, m_boilMinOutput);
+        outputValue = std::max(outputValue, raw(m_boilMinOutput));
     }
 
     // try to set the output to the desired setting
@@ -67,7 +120,7 @@ Pid::update()
 
         if (auto output = m_outputPtr()) {
             output->settingValid(true);
-            output->setting(outputValue);
+            output->setting(cnl::wrap<out_t>(outputValue));
 
             if (m_boilModeActive) {
                 return;
@@ -75,64 +128,76 @@ Pid::update()
 
             // get the clipped setting from the actuator for anti-windup
             if (output->settingValid()) {
-                auto outputSetting = output->setting();
+                const int32_t outputSetting = raw(output->setting());
 
                 if (m_ti != 0) { // 0 has been chosen to indicate that the integrator is disabled. This also prevents divide by zero.
                                  // update integral with anti-windup back calculation
                                  // pidResult - output is zero when actuator is not saturated
 
-                    auto antiWindup = integral_t{0};
-                    if (m_kp != 0) { // prevent divide by zero
+                    int32_t antiWindup = 0;
+                    if (kp != 0) { // prevent divide by zero
                         if (pidResult != outputSetting) {
                             // clipped to actuator min or max set in target actuator
                             // calculate anti-windup from setting instead of actual value, so it doesn't dip under the maximum
                             // make sure anti-windup is at least m_error when clipping to prevent further windup, with extra anti-windup to scale back integral
-                            out_t excess = cnl::quotient(pidResult - outputSetting, m_kp);
-                            out_t correction = int8_t{3} * excess; // anti windup gain is 3
-                            antiWindup = m_error + correction;
+                            int32_t excess = divideByKp(pidResult - outputSetting, kp);
+                            int32_t correction = saturate(3 * int64_t(excess), fp12Max); // anti windup gain is 3
+                            antiWindup = saturate(int64_t(error) + correction, integralMax);
                         } else {
                             // Actuator could be not reaching set value due to physics or limits in its target actuator
                             // Get the actual achieved value in actuator. This could differ due to slowness time/mutex limits
                             if (output->valueValid()) {
-                                auto achievedValue = output->value();
+                                const int32_t achievedValue = raw(output->value());
 
-                                // Anti windup gain is 3
-                                out_t excess = cnl::quotient(pidResult - achievedValue, m_kp);
-                                antiWindup = int8_t(3) * excess; // anti windup gain is 3
+                                int32_t excess = divideByKp(pidResult - achievedValue, kp);
+                                antiWindup = 3 * excess; // anti windup gain is 3
 
                                 // Disable anti-windup if integral part dominates. But only if it counteracts p.
-                                decltype(m_i) mi_limit = int8_t{3} * m_p;
-                                if (m_p < 0 && m_i < 0 && m_i < mi_limit) {
-                                    antiWindup = integral_t{0};
+                                int32_t mi_limit = saturate(3 * int64_t(p), fp12Max);
+                                if (p < 0 && i < 0 && i < mi_limit) {
+                                    antiWindup = 0;
                                 }
-                                if (m_p > 0 && m_i > 0 && m_i > mi_limit) {
-                                    antiWindup = integral_t{0};
+                                if (p > 0 && i > 0 && i > mi_limit) {
+                                    antiWindup = 0;
                                 }
                             }
                         }
                     }
 
                     // make sure integral does not cross zero and does not increase by anti-windup
-                    integral_t newIntegral = m_integral - antiWindup;
-                    if (m_integral >= integral_t{0}) {
-                        m_integral = std::clamp(newIntegral, integral_t{0}, m_integral);
+                    int32_t newIntegral = saturate(int64_t(integral) - antiWindup, integralMax);
+                    if (integral >= 0) {
+                        integral = std::clamp(newIntegral, int32_t(0), integral);
                     } else {
-                        m_integral = std::clamp(newIntegral, m_integral, integral_t{0});
+                        integral = std::clamp(newIntegral, integral, int32_t(0));
                     }
+                    m_integral = cnl::wrap<integral_t>(integral);
                 }
             }
         }
     }
 }
 
+void
+Pid::updateDerivedGains()
+{
+    // kp / ti with 27 fraction bits, equal to safe_elastic_fixed_point<4, 27>(cnl::quotient(m_kp, m_ti))
+    m_ki = m_ti ? saturate((int64_t(raw(m_kp)) << 15) / m_ti, std::numeric_limits<int32_t>::max()) : 0;
+    m_boilThreshold = (int32_t(100) << 12) + raw(m_boilPointAdjust);
+}
+
 void
 Pid::kp(const in_t& arg)
 {
-    if (arg != 0) {
+    const int32_t newKp = raw(arg);
+    if (newKp != 0) {
         // scale integral history so integral action doesn't change
-        m_integral = m_integral * safe_elastic_fixed_point<15, 15>(cnl::quotient(m_kp, arg));
+        // the ratio old kp / new kp has 15 fraction bits
+        int32_t ratio = saturate((int64_t(raw(m_kp)) << 15) / newKp, integralMax);
+        m_integral = cnl::wrap<integral_t>(saturate(scaleDown(int64_t(raw(m_integral)) * ratio, 15), integralMax));
     }
     m_kp = arg;
+    updateDerivedGains();
 }
 
 void
@@ -140,16 +205,20 @@ Pid::ti(const uint16_t& arg)
 {
     if (m_ti != 0) {
         // scale integral history so integral action doesn't change
-        m_integral = cnl::wrap<integral_t>((int64_t(cnl::unwrap(m_integral)) * arg) / m_ti);
+        m_integral = cnl::wrap<integral_t>(saturate((int64_t(raw(m_integral)) * arg) / m_ti, integralMax));
     }
     m_ti = arg;
+    updateDerivedGains();
 }
 
 void
 Pid::setIntegral(const out_t& newIntegratorPart)
 {
-    if (m_kp == 0) {
+    const int32_t kp = raw(m_kp);
+    if (kp == 0) {
         return;
     }
-    m_integral = m_ti * safe_elastic_fixed_point<14, 16>(cnl::quotient(newIntegratorPart, m_kp));
-}
\ No newline at end of file
+    // newIntegratorPart / kp with 16 fraction bits
+    int32_t ratio = saturate((int64_t(raw(newIntegratorPart)) << 16) / kp, integralMax);
+    m_integral = cnl::wrap<integral_t>(saturate(scaleDown(int64_t(m_ti) * ratio, 4), integralMax));
+}
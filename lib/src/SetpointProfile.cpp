@@ -19,42 +19,62 @@
 
 #include "../inc/SetpointProfile.h"
 
+namespace {
+
+constexpr uint8_t slopeFractionBits = 32;
+
+} // end anonymous namespace
+
 void
-SetpointProfile::update(const utc_seconds_t& time)
+SetpointProfile::calculateSlopes()
 {
-    struct TimeStampLessEqual {
-        bool operator()(const Point& p, const utc_seconds_t& time) const { return p.time <= time; }
-        bool operator()(const utc_seconds_t& time, const Point& p) const { return time <= p.time; }
-    };
+    m_slopes.assign(m_points.size(), 0); // the last point is held, steps have no slope
+    for (size_t i = 0; i + 1 < m_points.size(); i++) {
+        auto& lower = m_points[i];
+        auto& upper = m_points[i + 1];
+        if (upper.time > lower.time) {
+            auto tempDiff = int64_t(cnl::unwrap(upper.temp)) - int64_t(cnl::unwrap(lower.temp));
+            m_slopes[i] = tempDiff * (int64_t(1) << slopeFractionBits) / int64_t(upper.time - lower.time);
+        }
+    }
+    m_next = 0;
+}
 
+void
+SetpointProfile::update(const utc_seconds_t& time)
+{
     if (!isDriving()) {
         return;
     }
 
-    auto newTemp = temp_t(0);
+    if (time == 0 || m_profileStartTime > time) {
+        return;
+    }
+    auto elapsed = time - m_profileStartTime;
+
+    // move the cursor to the first point after the elapsed time.
+    // Time normally only moves forward, it moves back when the start time or the clock is changed.
+    while (m_next < m_points.size() && m_points[m_next].time <= elapsed) {
+        ++m_next;
+    }
+    while (m_next > 0 && m_points[m_next - 1].time > elapsed) {
+        --m_next;
+    }
+
+    if (m_next == 0) {
+        return; // first point is in the future
+    }
 
-    if (!m_points.empty() && time != 0) {
+    auto newTemp = m_points.back().temp; // every point is in the past, use the last point
+    if (m_next < m_points.size()) {
+        auto& lower = m_points[m_next - 1];
+        // the division by a power of 2 truncates towards zero, like the fixed point conversion
+        auto offset = m_slopes[m_next - 1] * int64_t(elapsed - lower.time) / (int64_t(1) << slopeFractionBits);
+        newTemp = cnl::wrap<temp_t>(int32_t(cnl::unwrap(lower.temp) + offset));
+    }
 
-        if (m_profileStartTime > time) {
-            return;
-        }
-        auto elapsed = time - m_profileStartTime;
-        auto upper = std::lower_bound(m_points.cbegin(), m_points.cend(), elapsed, TimeStampLessEqual{});
-        if (upper == m_points.cend()) { // every point is in the past, use the last point
-            newTemp = m_points.back().temp;
-        } else if (upper != m_points.cbegin()) { // first point is not in the future
-            auto lower = upper - 1;
-            auto segmentElapsed = elapsed - lower->time;
-            auto segmentDuration = upper->time - lower->time;
-            auto fraction = safe_elastic_fixed_point<1, 30>(cnl::quotient(segmentElapsed, segmentDuration));
-            auto interpolated = lower->temp + temp_t((upper->temp - lower->temp) * fraction);
-            newTemp = interpolated;
-        } else {
-            return;
-        }
-        if (auto targetPtr = m_target()) {
-            targetPtr->setting(newTemp);
-            targetPtr->settingValid(true);
-        }
+    if (auto targetPtr = m_target()) {
+        targetPtr->setting(newTemp);
+        targetPtr->settingValid(true);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SlopeEstimator.h"
+
+constexpr uint8_t SlopeEstimator::maxWindow;
+
+void
+SlopeEstimator::configure(uint16_t period)
+{
+    if (period < 2) {
+        period = 2;
+    }
+    m_period = period;
+    m_decimation = (period + maxWindow - 1) / maxWindow;
+    m_window = period / m_decimation;
+    reset();
+}
+
+void
+SlopeEstimator::reset()
+{
+    m_sum = 0;
+    m_weightedSum = 0;
+    m_skip = 0;
+    m_oldest = 0;
+    m_count = 0;
+}
+
+void
+SlopeEstimator::add(const int32_t& value)
+{
+    if (m_skip > 0) {
+        --m_skip;
+        return;
+    }
+    m_skip = m_decimation - 1;
+
+    if (m_count < m_window) {
+        // the buffer is filled in order, m_oldest is still 0
+        m_values[m_count] = value;
+        m_weightedSum += int64_t(m_count) * value;
+        m_sum += value;
+        ++m_count;
+        return;
+    }
+
+    // All samples move 1 position down, which lowers the weighted sum by the sum of the samples that are kept.
+    // The new sample is added at the last position.
+    const int32_t removed = m_values[m_oldest];
+    m_values[m_oldest] = value;
+    m_oldest = (m_oldest + 1 == m_window) ? 0 : m_oldest + 1;
+    m_weightedSum += int64_t(m_window - 1) * value - (m_sum - removed);
+    m_sum += value - removed;
+}
+
+int64_t
+SlopeEstimator::slope(uint8_t extraFractionBits) const
+{
+    if (m_count < 2) {
+        return 0;
+    }
+    // For positions 0..n-1, the least squares slope is:
+    // (n * sum(i * y) - sum(i) * sum(y)) / (n * sum(i^2) - sum(i)^2) = 12 * (n * sum(i * y) - sum(i) * sum(y)) / (n^2 * (n^2 - 1))
+    const int64_t n = m_count;
+    const int64_t sumPositions = n * (n - 1) / 2;
+    const int64_t numerator = 12 * (n * m_weightedSum - sumPositions * m_sum);
+    const int64_t denominator = n * n * (n * n - 1) * m_decimation;
+
+    // divide before shifting to prevent overflow, rounded to nearest
+    const bool negative = numerator < 0;
+    const uint64_t absNumerator = negative ? -uint64_t(numerator) : uint64_t(numerator);
+    const uint64_t quotient = absNumerator / uint64_t(denominator);
+    const uint64_t remainder = absNumerator % uint64_t(denominator);
+    const uint64_t result = (quotient << extraFractionBits) + ((remainder << extraFractionBits) + uint64_t(denominator) / 2) / uint64_t(denominator);
+    return negative ? -int64_t(result) : int64_t(result);
+}
@@ -24,8 +24,25 @@
 #include "../inc/OneWire.h"
 #include "../inc/OneWireAddress.h"
 #include "../inc/TempSensorOneWire.h"
+#include "../inc/TempSensorOneWireBus.h"
 #include "../inc/Temperature.h"
 
+TempSensorOneWire::TempSensorOneWire(TempSensorOneWireBus& conversionBus, OneWireAddress _address, const temp_t& _calibrationOffset)
+    : OneWireDevice(conversionBus.bus(), _address)
+    , m_sensor(&conversionBus.bus())
+    , m_calibrationOffset(_calibrationOffset)
+    , m_conversionBus(&conversionBus)
+{
+    m_conversionBus->add(*this);
+}
+
+TempSensorOneWire::~TempSensorOneWire()
+{
+    if (m_conversionBus) {
+        m_conversionBus->remove(*this);
+    }
+}
+
 /**
  * Initializes the temperature sensor.
  * This method should be called when the sensor is first created and also any time the sensor reports it has been reset.
@@ -34,7 +51,8 @@
 void
 TempSensorOneWire::init()
 {
-    if (m_sensor.initConnection(getDeviceAddress().asUint8ptr())) {
+    // with a conversion bus, the sensor is included in the next bus wide conversion
+    if (m_sensor.initConnection(getDeviceAddress().asUint8ptr()) && !m_conversionBus) {
         requestConversion();
     }
 }
@@ -53,15 +71,16 @@ TempSensorOneWire::connected(bool _connected)
     }
     m_connected = _connected;
     if (m_connected) {
-        // CL_LOG_WARN("OneWire temp sensor connected: ") << getDeviceAddress().toString();
+        // CL_LOG_RECORD_INFO(TEMP_SENSOR_CONNECTED, getDeviceAddress());
     } else {
-        // CL_LOG_WARN("OneWire temp sensor disconnected: ") << getDeviceAddress().toString();
+        // CL_LOG_RECORD_WARN(TEMP_SENSOR_DISCONNECTED, getDeviceAddress());
     }
 }
 
 temp_t
 TempSensorOneWire::value() const
 {
+    m_polling.demand(); // a consumer uses the value, keep sampling it when polling on demand
     if (!m_connected) {
         return 0;
     }
@@ -72,18 +91,33 @@ TempSensorOneWire::value() const
 void
 TempSensorOneWire::update()
 {
+    if (m_conversionBus) {
+        return; // value is read by the conversion bus
+    }
     m_cachedValue = readAndConstrainTemp();
     requestConversion();
 }
 
+void
+TempSensorOneWire::readConversion(const uint8_t* scratchPad)
+{
+    int16_t tempRaw = DEVICE_DISCONNECTED_RAW;
+    if (scratchPad) {
+        tempRaw = m_sensor.getTempRaw(getDeviceAddress().asUint8ptr(), scratchPad);
+    }
+    m_cachedValue = constrainTemp(tempRaw);
+}
+
 temp_t
 TempSensorOneWire::readAndConstrainTemp()
 {
-    int16_t tempRaw;
-    bool success;
+    return constrainTemp(m_sensor.getTempRaw(getDeviceAddress().asUint8ptr()));
+}
 
-    tempRaw = m_sensor.getTempRaw(getDeviceAddress().asUint8ptr());
-    success = tempRaw > RESET_DETECTED_RAW;
+temp_t
+TempSensorOneWire::constrainTemp(int16_t tempRaw)
+{
+    bool success = tempRaw > RESET_DETECTED_RAW;
 
     if (tempRaw == RESET_DETECTED_RAW) {
         // retry re-init if the sensor is present, but needs a reset
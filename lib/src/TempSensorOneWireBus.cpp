@@ -0,0 +1,130 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/TempSensorOneWireBus.h"
+#include "../inc/DallasTemperature.h"
+#include "../inc/OneWire.h"
+#include "../inc/OneWireTransactions.h"
+#include "../inc/TempSensorOneWire.h"
+#include <algorithm>
+
+constexpr duration_millis_t TempSensorOneWireBus::conversionTime;
+constexpr uint8_t TempSensorOneWireBus::readRetries;
+
+TempSensorOneWireBus::TempSensorOneWireBus(OneWireTransactions& transactions, duration_millis_t interval)
+    : m_transactions(transactions)
+    , m_interval(std::max(interval, conversionTime))
+{
+}
+
+TempSensorOneWireBus::~TempSensorOneWireBus()
+{
+    m_transactions.cancel(this);
+}
+
+OneWire&
+TempSensorOneWireBus::bus()
+{
+    return m_transactions.bus();
+}
+
+void
+TempSensorOneWireBus::add(TempSensorOneWire& sensor)
+{
+    m_sensors.push_back(&sensor);
+}
+
+void
+TempSensorOneWireBus::remove(TempSensorOneWire& sensor)
+{
+    m_transactions.cancel(&sensor);
+    m_sensors.erase(std::remove(m_sensors.begin(), m_sensors.end(), &sensor), m_sensors.end());
+}
+
+ticks_millis_t
+TempSensorOneWireBus::update(const ticks_millis_t& now)
+{
+    if (m_state == State::Started) {
+        m_conversionStart = now;
+        m_state = State::Converting;
+    }
+
+    if (m_state == State::Converting) {
+        if (now - m_conversionStart < conversionTime) {
+            return m_conversionStart + conversionTime;
+        }
+        m_readTime = now;
+        for (auto sensor : m_sensors) {
+            if (readInSweep(*sensor, now)) {
+                submitRead(sensor, readRetries, 0);
+            }
+        }
+        m_state = State::Idle;
+    }
+
+    if (m_state == State::Idle) {
+        if (m_conversions != 0 && now - m_lastSubmit < m_interval) {
+            return m_lastSubmit + m_interval;
+        }
+        // only convert when a sensor is due to be read at the end of the conversion
+        auto readTime = now + conversionTime;
+        bool needed = std::any_of(m_sensors.cbegin(), m_sensors.cend(), [this, &readTime](const TempSensorOneWire* sensor) {
+            return readInSweep(*sensor, readTime);
+        });
+        if (!needed) {
+            return now + m_interval;
+        }
+
+        // start the conversion on all devices at once
+        bool queued = m_transactions.submit(OneWireTransaction(0, {STARTCONVO}, 0, this, [this](const OneWireTransaction&) {
+            m_state = State::Started;
+        }));
+        if (!queued) {
+            return now + 1;
+        }
+        m_lastSubmit = now;
+        m_state = State::Starting;
+        ++m_conversions;
+    }
+
+    return now + 1; // the convert command is sent on the next pass
+}
+
+bool
+TempSensorOneWireBus::readInSweep(const TempSensorOneWire& sensor, const ticks_millis_t& readTime) const
+{
+    // read it now if it would otherwise become due before the next sweep
+    return sensor.polling().due(readTime + m_interval - 1);
+}
+
+void
+TempSensorOneWireBus::submitRead(TempSensorOneWire* sensor, uint8_t retries, duration_micros_t busTime)
+{
+    auto address = sensor->getDeviceAddress();
+    m_transactions.submit(OneWireTransaction(address, {READSCRATCH}, 9, sensor, [this, sensor, retries, busTime](const OneWireTransaction& t) {
+        const uint8_t* scratchPad = t.result();
+        bool valid = t.success && OneWire::crc8(scratchPad, 8) == scratchPad[SCRATCHPAD_CRC];
+        if (!valid && retries > 0) {
+            submitRead(sensor, retries - 1, busTime + t.busTime);
+            return;
+        }
+        sensor->readConversion(t.success ? scratchPad : nullptr);
+        sensor->polling().polled(m_readTime, valid, busTime + t.busTime);
+    }));
+}
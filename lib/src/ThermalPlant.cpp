@@ -0,0 +1,112 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThermalPlant.h"
+#include <algorithm>
+#include <limits>
+
+constexpr uint8_t ThermalPlant::extraFractionBits;
+constexpr int64_t ThermalPlant::extraScale;
+
+ThermalPlant::ThermalPlant(
+    std::function<std::shared_ptr<TempSensorMock>()>&& sensor,
+    const temp_t& initial,
+    const duration_millis_t& interval)
+    : m_sensor(sensor)
+    , m_interval(interval > 0 ? interval : 1)
+{
+    temperature(initial);
+}
+
+temp_t
+ThermalPlant::temperature() const
+{
+    const int64_t rounder = int64_t(1) << (extraFractionBits - 1);
+    return cnl::wrap<temp_t>((m_temperature + rounder) >> extraFractionBits);
+}
+
+void
+ThermalPlant::temperature(const temp_t& val)
+{
+    m_temperature = int64_t(cnl::unwrap(val)) * extraScale;
+    std::fill(m_delayed.begin(), m_delayed.end(), 0);
+}
+
+void
+ThermalPlant::deadTime(const duration_millis_t& val)
+{
+    m_delayed.assign(val / m_interval, 0);
+    m_delayedIdx = 0;
+}
+
+void
+ThermalPlant::step()
+{
+    constexpr int64_t millisPerHour = 3600000;
+    constexpr int64_t fullScale = int64_t(100) << 12; // raw actuator value of 100%
+    // limit of the summed heating, so it can be scaled by extraScale without overflow
+    constexpr int64_t maxHeating = std::numeric_limits<int64_t>::max() / extraScale;
+
+    // sum of gain * actuator value, in raw temp_t per hour * fullScale
+    // a single term is at most 2^31 * fullScale, so the sum is clamped after each term
+    int64_t heating = 0;
+    for (const auto& input : m_inputs) {
+        if (auto actPtr = input.actuator()) {
+            if (actPtr->valueValid()) {
+                int64_t value = cnl::unwrap(actPtr->value());
+                value = value < 0 ? 0 : (value > fullScale ? fullScale : value);
+                heating += int64_t(cnl::unwrap(input.gain)) * value;
+                heating = std::max(-maxHeating, std::min(heating, maxHeating));
+            }
+        }
+    }
+    // scale the heating per hour to the interval, dividing first and adding the remainder to prevent overflow
+    int64_t heatingPerHour = heating * extraScale / fullScale;
+    int64_t heatingPerStep = heatingPerHour / millisPerHour * m_interval
+                             + heatingPerHour % millisPerHour * m_interval / millisPerHour;
+
+    if (!m_delayed.empty()) {
+        std::swap(heatingPerStep, m_delayed[m_delayedIdx]);
+        m_delayedIdx = (size_t(m_delayedIdx) + 1 == m_delayed.size()) ? 0 : m_delayedIdx + 1;
+    }
+
+    // loss has 12 fraction bits, divide the difference first to prevent overflow
+    int64_t difference = int64_t(cnl::unwrap(m_ambient)) * extraScale - m_temperature;
+    int64_t lossPerStep = (difference >> 12) * cnl::unwrap(m_lossRate) * m_interval / millisPerHour;
+
+    m_temperature += heatingPerStep + lossPerStep;
+    m_temperature = std::min(m_temperature, int64_t(cnl::unwrap(m_maxTemperature)) * extraScale);
+}
+
+ticks_millis_t
+ThermalPlant::update(const ticks_millis_t& now)
+{
+    if (!m_started) {
+        m_started = true;
+        m_lastUpdate = now;
+    }
+    while (now - m_lastUpdate >= m_interval) {
+        step();
+        m_lastUpdate += m_interval;
+    }
+    if (auto sensorPtr = m_sensor()) {
+        sensorPtr->setting(temperature());
+    }
+    return m_lastUpdate + m_interval;
+}
@@ -0,0 +1,121 @@
+#include "TimerInterrupts.h"
+#include <atomic>
+
+namespace {
+
+struct Task {
+    TimerInterrupts::TaskFunction func;
+    void* context;
+    uint8_t id;
+};
+
+struct Table {
+    Task tasks[TimerInterrupts::capacity];
+    uint8_t size;
+};
+
+constexpr uint8_t idle = 2;
+
+// The interrupt only reads tables[published]. The main loop edits the other table and then swaps them.
+Table tables[2] = {};
+std::atomic<uint8_t> published{0};
+// table that the interrupt is iterating, idle when it is not running
+std::atomic<uint8_t> running{idle};
+
+uint8_t
+editable()
+{
+    return 1 - published.load();
+}
+
+// publish an edited table, and wait until the interrupt has stopped using the previous one
+void
+publish(uint8_t idx)
+{
+    uint8_t previous = published.load();
+    published.store(idx);
+    while (running.load() == previous) {
+    }
+}
+
+} // end anonymous namespace
+
+void
+TimerInterrupts::run()
+{
+    // Mark the table in use before iterating it, and check that it was not replaced in between.
+    // Otherwise the main loop could have missed the mark and be editing it.
+    uint8_t idx;
+    do {
+        idx = published.load();
+        running.store(idx);
+    } while (published.load() != idx);
+
+    const Table& table = tables[idx];
+    for (uint8_t i = 0; i < table.size; i++) {
+        table.tasks[i].func(table.tasks[i].context);
+    }
+
+    running.store(idle);
+}
+
+uint8_t
+TimerInterrupts::add(TaskFunction func, void* context)
+{
+    const Table& current = tables[published.load()];
+    if (current.size >= capacity) {
+        return 0;
+    }
+
+    // find a free id
+    uint8_t id = 1;
+    for (uint8_t i = 0; i < current.size;) {
+        if (current.tasks[i].id == id) {
+            ++id;
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+
+    uint8_t idx = editable();
+    Table& next = tables[idx];
+    next = current;
+    next.tasks[next.size] = Task{func, context, id};
+    ++next.size;
+    publish(idx);
+
+    if (next.size == 1) {
+        enableTimer(true);
+    }
+    return id;
+}
+
+void
+TimerInterrupts::remove(uint8_t id)
+{
+    const Table& current = tables[published.load()];
+    uint8_t idx = editable();
+    Table& next = tables[idx];
+    next.size = 0;
+    for (uint8_t i = 0; i < current.size; i++) {
+        if (current.tasks[i].id != id) {
+            next.tasks[next.size] = current.tasks[i];
+            ++next.size;
+        }
+    }
+    if (next.size == current.size) {
+        return; // not found
+    }
+    publish(idx);
+
+    if (next.size == 0) {
+        enableTimer(false);
+    }
+}
+
+uint8_t
+TimerInterrupts::count()
+{
+    return tables[published.load()].size;
+}
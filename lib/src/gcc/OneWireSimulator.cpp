@@ -0,0 +1,542 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OneWireSimulator.h"
+#include "OneWire.h"
+#include <algorithm>
+
+void
+OneWireSimulator::attach(std::shared_ptr<OneWireSimulatedDevice> device)
+{
+    m_devices.push_back(std::move(device));
+}
+
+void
+OneWireSimulator::detach(const OneWireAddress& address)
+{
+    m_devices.erase(std::remove_if(m_devices.begin(), m_devices.end(), [&address](const std::shared_ptr<OneWireSimulatedDevice>& d) {
+                        return d->address() == address;
+                    }),
+                    m_devices.end());
+    m_selected.clear();
+    m_state = State::Idle;
+}
+
+constexpr OneWireSimulator::Timing OneWireSimulator::ds2482Timing;
+
+void
+OneWireSimulator::waitForBus()
+{
+    if (m_busyUntil > m_time) {
+        m_stats.waited += m_busyUntil - m_time;
+        m_time = m_busyUntil;
+    }
+}
+
+bool
+OneWireSimulator::reset()
+{
+    waitForBus();
+    command();
+    bool present = busReset();
+    runBus(m_timing.reset);
+    waitForBus();
+    return present;
+}
+
+void
+OneWireSimulator::write(uint8_t b, uint8_t)
+{
+    waitForBus();
+    command();
+    busWrite(b);
+    runBus(m_timing.byte);
+}
+
+uint8_t
+OneWireSimulator::read()
+{
+    waitForBus();
+    command();
+    uint8_t b = busRead();
+    runBus(m_timing.byte);
+    waitForBus();
+    command(); // fetch the result
+    return b;
+}
+
+void
+OneWireSimulator::write_bit(uint8_t bit)
+{
+    waitForBus();
+    command();
+    busWriteBit(bit);
+    runBus(m_timing.bit);
+}
+
+uint8_t
+OneWireSimulator::read_bit()
+{
+    waitForBus();
+    command();
+    uint8_t bit = busReadBit();
+    runBus(m_timing.bit);
+    waitForBus();
+    return bit;
+}
+
+uint8_t
+OneWireSimulator::search_triplet(uint8_t* search_direction, uint8_t* id_bit, uint8_t* cmp_id_bit)
+{
+    waitForBus();
+    command();
+
+    // read the address bit and its complement, then write the direction like the DS248x triplet command
+    *id_bit = busReadBit();
+    *cmp_id_bit = busReadBit();
+    if (*id_bit != *cmp_id_bit) {
+        *search_direction = *id_bit; // all remaining devices have the same bit
+    }
+    busWriteBit(*search_direction);
+
+    runBus(3 * m_timing.bit);
+    waitForBus();
+    return 0;
+}
+
+bool
+OneWireSimulator::busy()
+{
+    command(); // status read
+    switch (m_fault) {
+    case Fault::StuckBusy:
+        return true;
+    case Fault::NoResponse:
+        return false;
+    case Fault::None:
+        break;
+    }
+    return m_time < m_busyUntil;
+}
+
+void
+OneWireSimulator::startReset()
+{
+    command();
+    m_presence = busReset();
+    runBus(m_timing.reset);
+}
+
+bool
+OneWireSimulator::presence()
+{
+    return m_presence;
+}
+
+void
+OneWireSimulator::startWrite(uint8_t b)
+{
+    command();
+    busWrite(b);
+    runBus(m_timing.byte);
+}
+
+void
+OneWireSimulator::startRead()
+{
+    command();
+    m_readByte = busRead();
+    runBus(m_timing.byte);
+}
+
+uint8_t
+OneWireSimulator::readResult()
+{
+    command();
+    return m_fault == Fault::NoResponse ? 0xFF : m_readByte;
+}
+
+bool
+OneWireSimulator::failed()
+{
+    return m_fault == Fault::NoResponse;
+}
+
+bool
+OneWireSimulator::busReset()
+{
+    ++m_stats.resets;
+    m_selected.clear();
+    for (auto& d : m_devices) {
+        d->reset();
+    }
+    ++m_resetCount;
+    if (m_errors.missPresenceInterval && m_resetCount % m_errors.missPresenceInterval == 0) {
+        ++m_stats.missedPresences;
+        m_state = State::Idle;
+        return false;
+    }
+    m_state = m_devices.empty() ? State::Idle : State::RomCommand;
+    return !m_devices.empty();
+}
+
+void
+OneWireSimulator::busWrite(uint8_t b)
+{
+    ++m_stats.bytesWritten;
+    switch (m_state) {
+    case State::Idle:
+    case State::ReadRom:
+    case State::Search:
+        break;
+    case State::RomCommand:
+        if (b == 0x55) { // match ROM
+            m_matchCount = 0;
+            m_state = State::MatchRom;
+        } else if (b == 0xCC) { // skip ROM
+            for (auto& d : m_devices) {
+                m_selected.push_back(d.get());
+            }
+            m_state = State::Function;
+        } else if (b == 0x33) { // read ROM
+            m_romIndex = 0;
+            m_state = State::ReadRom;
+        } else if (b == 0xF0) { // search ROM, all devices take part
+            for (auto& d : m_devices) {
+                m_selected.push_back(d.get());
+            }
+            m_searchBit = 0;
+            m_searchPhase = 0;
+            m_state = State::Search;
+        } else {
+            m_state = State::Idle; // other ROM commands are not simulated
+        }
+        break;
+    case State::MatchRom:
+        m_matchRom[m_matchCount++] = b;
+        if (m_matchCount == 8) {
+            for (auto& d : m_devices) {
+                if (std::equal(m_matchRom, m_matchRom + 8, d->address().asUint8ptr())) {
+                    m_selected.push_back(d.get());
+                }
+            }
+            m_state = State::Function;
+        }
+        break;
+    case State::Function:
+        for (auto d : m_selected) {
+            d->write(b);
+        }
+        break;
+    }
+}
+
+uint8_t
+OneWireSimulator::busRead()
+{
+    ++m_stats.bytesRead;
+    // the bus is pulled high, each device can pull bits low
+    uint8_t result = 0xFF;
+    if (m_state == State::Function) {
+        for (auto d : m_selected) {
+            result &= d->read();
+        }
+    } else if (m_state == State::ReadRom) {
+        // devices send their address at the same time, which only gives a valid address with a single device
+        for (auto& d : m_devices) {
+            result &= d->address().asUint8ptr()[m_romIndex];
+        }
+        if (++m_romIndex == 8) {
+            for (auto& d : m_devices) {
+                m_selected.push_back(d.get());
+            }
+            m_state = State::Function;
+        }
+    }
+
+    ++m_readCount;
+    if (m_errors.corruptReadInterval && m_readCount % m_errors.corruptReadInterval == 0) {
+        ++m_stats.corruptedReads;
+        result ^= 0x01;
+    }
+    return result;
+}
+
+uint8_t
+OneWireSimulator::busReadBit()
+{
+    ++m_stats.bitsRead;
+    uint8_t result = 1;
+    if (m_state == State::Function) {
+        for (auto d : m_selected) {
+            result &= d->read_bit();
+        }
+    } else if (m_state == State::Search && m_searchPhase < 2) {
+        // devices that are still in the search send the address bit, then its complement
+        for (auto d : m_selected) {
+            uint8_t bit = (d->address().asUint8ptr()[m_searchBit / 8] >> (m_searchBit % 8)) & 0x01;
+            result &= m_searchPhase == 0 ? bit : bit ^ 0x01;
+        }
+        ++m_searchPhase;
+    }
+    return result;
+}
+
+void
+OneWireSimulator::busWriteBit(uint8_t bit)
+{
+    ++m_stats.bitsWritten;
+    if (m_state != State::Search || m_searchPhase != 2) {
+        return;
+    }
+    // devices with a different address bit leave the search
+    m_selected.erase(std::remove_if(m_selected.begin(), m_selected.end(), [this, bit](OneWireSimulatedDevice* d) {
+                         return ((d->address().asUint8ptr()[m_searchBit / 8] >> (m_searchBit % 8)) & 0x01) != (bit & 0x01);
+                     }),
+                     m_selected.end());
+    m_searchPhase = 0;
+    if (++m_searchBit == 64) {
+        m_state = State::Function; // the device that was found is selected
+    }
+}
+
+OneWireSimulatedDS18B20::OneWireSimulatedDS18B20(const OneWireAddress& address)
+    : OneWireSimulatedDevice(address)
+{
+    powerOn();
+}
+
+void
+OneWireSimulatedDS18B20::powerOn()
+{
+    m_scratchPad[0] = 0x50; // 85 degrees
+    m_scratchPad[1] = 0x05;
+    m_scratchPad[2] = m_eeprom[0];
+    m_scratchPad[3] = m_eeprom[1];
+    m_scratchPad[4] = m_eeprom[2];
+    m_scratchPad[5] = 0xFF;
+    m_scratchPad[6] = 0x0C;
+    m_scratchPad[7] = 0x10;
+    m_scratchPad[8] = OneWire::crc8(m_scratchPad, 8);
+    m_command = 0;
+}
+
+void
+OneWireSimulatedDS18B20::reset()
+{
+    m_command = 0;
+}
+
+void
+OneWireSimulatedDS18B20::write(uint8_t b)
+{
+    if (m_command == 0) {
+        m_command = b;
+        m_position = 0;
+        switch (b) {
+        case 0x44: // convert T
+            m_scratchPad[0] = uint8_t(m_temperature);
+            m_scratchPad[1] = uint8_t(uint16_t(m_temperature) >> 8);
+            ++m_conversions;
+            break;
+        case 0x48: // copy scratchpad to EEPROM
+            std::copy(m_scratchPad + 2, m_scratchPad + 5, m_eeprom);
+            break;
+        case 0xB8: // recall EEPROM
+            std::copy(m_eeprom, m_eeprom + 3, m_scratchPad + 2);
+            break;
+        default:
+            break;
+        }
+        m_scratchPad[8] = OneWire::crc8(m_scratchPad, 8);
+        return;
+    }
+    if (m_command == 0x4E && m_position < 3) { // write scratchpad: high alarm, low alarm, configuration
+        m_scratchPad[2 + m_position++] = b;
+        m_scratchPad[8] = OneWire::crc8(m_scratchPad, 8);
+    }
+}
+
+uint8_t
+OneWireSimulatedDS18B20::read()
+{
+    if (m_command == 0xBE && m_position < 9) { // read scratchpad
+        return m_scratchPad[m_position++];
+    }
+    // read power supply and other commands: not pulling the bus low means externally powered or done
+    return 0xFF;
+}
+
+void
+OneWireSimulatedDS2413::externalPullDown(uint8_t pio, bool pulledDown)
+{
+    if (pulledDown) {
+        m_external &= ~(1 << pio);
+    } else {
+        m_external |= (1 << pio);
+    }
+}
+
+uint8_t
+OneWireSimulatedDS2413::status() const
+{
+    uint8_t pins = m_latches & m_external;
+    // bit 0: PIOA pin, bit 1: PIOA latch, bit 2: PIOB pin, bit 3: PIOB latch, upper nibble is the complement
+    uint8_t lower = (pins & 0x01) | (m_latches & 0x01) << 1 | (pins & 0x02) << 1 | (m_latches & 0x02) << 2;
+    return uint8_t(uint8_t(~lower) << 4) | lower;
+}
+
+void
+OneWireSimulatedDS2413::reset()
+{
+    m_command = 0;
+}
+
+void
+OneWireSimulatedDS2413::write(uint8_t b)
+{
+    if (m_command == 0) {
+        m_command = b;
+        m_position = 0;
+        return;
+    }
+    if (m_command == 0x5A && m_position < 2) { // PIO access write: data and inverted data
+        m_received[m_position++] = b;
+        if (m_position == 2 && m_received[0] == uint8_t(~m_received[1])) {
+            m_latches = m_received[0] & 0x03;
+            ++m_writes;
+        }
+    }
+}
+
+uint8_t
+OneWireSimulatedDS2413::read()
+{
+    if (m_command == 0xF5) { // PIO access read, repeats the status
+        return status();
+    }
+    if (m_command == 0x5A && m_position == 2) {
+        if (m_received[0] != uint8_t(~m_received[1])) {
+            return 0xFF;
+        }
+        m_position = 3;
+        return 0xAA; // confirmation, followed by the status
+    }
+    if (m_command == 0x5A && m_position == 3) {
+        return status();
+    }
+    return 0xFF;
+}
+
+void
+OneWireSimulatedDS2408::externalPullDown(uint8_t pio, bool pulledDown)
+{
+    if (pulledDown) {
+        m_external &= ~(1 << pio);
+    } else {
+        m_external |= (1 << pio);
+    }
+}
+
+uint8_t
+OneWireSimulatedDS2408::registerValue(uint16_t address) const
+{
+    switch (address) {
+    case 0x88: // PIO logic state
+        return pins();
+    case 0x89: // output latch state
+        return m_latches;
+    case 0x8A: // activity latch state
+    case 0x8B: // conditional search channel selection mask
+    case 0x8C: // conditional search channel polarity
+        return 0x00;
+    case 0x8D: // control/status: VCC powered, power on reset
+        return 0x88;
+    default:
+        return 0xFF;
+    }
+}
+
+void
+OneWireSimulatedDS2408::reset()
+{
+    m_command = 0;
+}
+
+void
+OneWireSimulatedDS2408::write(uint8_t b)
+{
+    if (m_command == 0) {
+        m_command = b;
+        m_position = 0;
+        m_crc = OneWire::crc16(&b, 1);
+        return;
+    }
+    if (m_position < 2) {
+        m_received[m_position++] = b;
+        if (m_command == 0xF0) { // read PIO registers: target address
+            m_crc = OneWire::crc16(&b, 1, m_crc);
+            m_address = uint16_t(m_received[0]) | uint16_t(m_received[1]) << 8;
+        } else if (m_command == 0x5A && m_position == 2 && m_received[0] == uint8_t(~m_received[1])) {
+            m_latches = m_received[0];
+            ++m_writes;
+        }
+    }
+}
+
+uint8_t
+OneWireSimulatedDS2408::read()
+{
+    switch (m_command) {
+    case 0xF0:
+        if (m_position < 2) {
+            return 0xFF;
+        }
+        if (m_address <= 0x8F) {
+            uint8_t value = registerValue(m_address++);
+            m_crc = OneWire::crc16(&value, 1, m_crc);
+            return value;
+        }
+        // the inverted CRC16 follows the last register
+        switch (m_address++) {
+        case 0x90:
+            return uint8_t(~m_crc);
+        case 0x91:
+            return uint8_t(~m_crc >> 8);
+        default:
+            return 0xFF;
+        }
+    case 0xF5: // PIO access read
+        return pins();
+    case 0x5A:
+        if (m_position < 2) {
+            return 0xFF;
+        }
+        if (m_received[0] != uint8_t(~m_received[1])) {
+            return 0xFF;
+        }
+        if (m_position == 2) {
+            m_position = 3;
+            return 0xAA; // confirmation, followed by the PIO state
+        }
+        return pins();
+    default:
+        return 0xFF;
+    }
+}
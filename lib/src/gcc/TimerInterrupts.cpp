@@ -0,0 +1,140 @@
+#include "TimerInterrupts.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+
+// Linux backend: a real time thread takes the place of the timer interrupt
+
+namespace {
+
+std::thread timerThread;
+std::mutex timerMutex;
+std::condition_variable timerWakeup;
+bool timerEnabled = false;
+std::atomic<bool> stopRequested{false};
+// held by the thread while it runs the tasks and by TimerInterrupts::Guard
+std::mutex taskMutex;
+
+constexpr long tickNanos = 1000000000L / TimerInterrupts::frequency;
+
+void
+timerLoop()
+{
+    // Try to get real time priority to reduce jitter. This requires privileges, run as normal thread if it fails.
+    sched_param param{};
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!stopRequested.load()) {
+        {
+            std::unique_lock<std::mutex> lock(timerMutex);
+            if (!timerEnabled) {
+                // stop() does not take the lock, so it can be called from a signal handler. Poll to not miss it.
+                while (!timerWakeup.wait_for(lock, std::chrono::milliseconds(100), []() { return timerEnabled || stopRequested.load(); })) {
+                }
+                clock_gettime(CLOCK_MONOTONIC, &next);
+            }
+        }
+        if (stopRequested.load()) {
+            break;
+        }
+
+        // sleep until an absolute time, so the period does not drift by the time the tasks take
+        next.tv_nsec += tickNanos;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+
+        // skip the tick while the main loop holds a guard, instead of running the missed ticks in a burst later
+        std::unique_lock<std::mutex> lock(taskMutex, std::try_to_lock);
+        if (lock) {
+            TimerInterrupts::run();
+        }
+    }
+}
+
+} // end anonymous namespace
+
+void
+TimerInterrupts::init()
+{
+    if (timerThread.joinable()) {
+        return;
+    }
+    stopRequested.store(false);
+    timerThread = std::thread(timerLoop);
+
+    static bool stopAtExit = false;
+    if (!stopAtExit) {
+        // a thread that is still joinable when the static destructors run terminates the process
+        std::atexit(TimerInterrupts::stop);
+        stopAtExit = true;
+    }
+}
+
+void
+TimerInterrupts::stop()
+{
+    if (!timerThread.joinable()) {
+        return;
+    }
+    stopRequested.store(true);
+    timerWakeup.notify_one();
+    if (timerThread.get_id() == std::this_thread::get_id()) {
+        // called from a signal handler that interrupted the thread itself
+        timerThread.detach();
+    } else {
+        timerThread.join();
+    }
+}
+
+TimerInterrupts::Guard::Guard()
+    : locked(true)
+{
+    taskMutex.lock();
+}
+
+TimerInterrupts::Guard::~Guard()
+{
+    unlock();
+}
+
+void
+TimerInterrupts::Guard::unlock()
+{
+    if (locked) {
+        taskMutex.unlock();
+        locked = false;
+    }
+}
+
+void
+TimerInterrupts::tick(uint32_t ticks)
+{
+    if (!count()) {
+        return;
+    }
+    for (; ticks > 0; --ticks) {
+        run();
+    }
+}
+
+void
+TimerInterrupts::enableTimer(bool enable)
+{
+    {
+        std::lock_guard<std::mutex> lock(timerMutex);
+        timerEnabled = enable;
+    }
+    timerWakeup.notify_one();
+}
@@ -49,8 +49,9 @@ DS248x::setReadPtr(uint8_t readPtr)
 uint8_t
 DS248x::readByte()
 {
-    Wire.requestFrom(mAddress, size_t{1});
-    return Wire.read();
+    // a failed read returns 0xFF, which has the busy bit set
+    mI2cError = Wire.requestFrom(mAddress, size_t{1}) != 1;
+    return mI2cError ? 0xFF : Wire.read();
 }
 
 uint8_t
@@ -165,12 +166,8 @@ bool
 DS248x::reset()
 {
     busyWait(true);
-    Wire.beginTransmission(mAddress);
-    Wire.write(DS248X_1WRS);
-    Wire.endTransmission(false);
-
+    startReset();
     uint8_t status = busyWait();
-
     return status & DS248X_STATUS_PPD ? true : false;
 }
 
@@ -178,22 +175,16 @@ void
 DS248x::write(uint8_t b, uint8_t power)
 {
     busyWait(true);
-    Wire.beginTransmission(mAddress);
-    Wire.write(DS248X_1WWB);
-    Wire.write(b);
-    Wire.endTransmission(false);
+    startWrite(b);
 }
 
 uint8_t
 DS248x::read()
 {
     busyWait(true);
-    Wire.beginTransmission(mAddress);
-    Wire.write(DS248X_1WRB);
-    Wire.endTransmission(false);
+    startRead();
     busyWait();
-    setReadPtr(PTR_READ);
-    return readByte();
+    return readResult();
 }
 
 void
@@ -238,3 +229,57 @@ DS248x::search_triplet(uint8_t* search_direction, uint8_t* id_bit, uint8_t* cmp_
 
     return status;
 }
+
+bool
+DS248x::busy()
+{
+    mStatus = wireReadStatus(true);
+    if (mI2cError) {
+        return false; // failed() reports it, instead of waiting for a status that doesn't come
+    }
+    return mStatus & DS248X_STATUS_BUSY;
+}
+
+void
+DS248x::startReset()
+{
+    Wire.beginTransmission(mAddress);
+    Wire.write(DS248X_1WRS);
+    Wire.endTransmission(false);
+}
+
+bool
+DS248x::presence()
+{
+    return mStatus & DS248X_STATUS_PPD ? true : false;
+}
+
+void
+DS248x::startWrite(uint8_t b)
+{
+    Wire.beginTransmission(mAddress);
+    Wire.write(DS248X_1WWB);
+    Wire.write(b);
+    Wire.endTransmission(false);
+}
+
+void
+DS248x::startRead()
+{
+    Wire.beginTransmission(mAddress);
+    Wire.write(DS248X_1WRB);
+    Wire.endTransmission(false);
+}
+
+uint8_t
+DS248x::readResult()
+{
+    setReadPtr(PTR_READ);
+    return readByte();
+}
+
+bool
+DS248x::failed()
+{
+    return mI2cError;
+}
@@ -1,15 +1,5 @@
 #include "TimerInterrupts.h"
 #include "spark_wiring_interrupts.h"
-#include <algorithm>
-#include <functional>
-#include <vector>
-
-struct FuncEntry {
-    uint8_t id;
-    std::function<void()> func;
-};
-
-static std::vector<FuncEntry> funcs;
 
 void
 timerIsrHandler()
@@ -17,9 +7,7 @@ timerIsrHandler()
     if (TIM_GetITStatus(TIM4, TIM_IT_Update) != RESET) {
         TIM_ClearITPendingBit(TIM4, TIM_IT_Update);
 
-        for (auto& fe : funcs) {
-            fe.func();
-        }
+        TimerInterrupts::run();
     }
 }
 
@@ -48,34 +36,13 @@ TimerInterrupts::init()
 
     TIM_TimeBaseInit(TIM4, &timerInitStructure);
     TIM_ITConfig(TIM4, TIM_IT_Update, ENABLE);
-    TIM_Cmd(TIM4, ENABLE);
+    TIM_Cmd(TIM4, count() ? ENABLE : DISABLE);
 
     attachSystemInterrupt(SysInterrupt_TIM4_Update, timerIsrHandler);
 }
 
-int16_t
-TimerInterrupts::add(std::function<void()>&& func)
-{
-    for (uint8_t id = 1; id < 255; id++) {
-        // find free id
-        auto match = find_if(funcs.begin(), funcs.end(), [&id](const FuncEntry& fe) {
-            return fe.id == id;
-        });
-
-        if (match == funcs.end()) {
-            funcs.push_back(FuncEntry{id, std::move(func)});
-            TIM_Cmd(TIM4, ENABLE);
-            return id;
-        }
-    };
-    return 0;
-}
-
 void
-TimerInterrupts::remove(uint8_t id)
+TimerInterrupts::enableTimer(bool enable)
 {
-    funcs.erase(std::remove_if(funcs.begin(), funcs.end(), [&id](const FuncEntry& fe) { return fe.id == id; }), funcs.end());
-    if (funcs.empty()) {
-        TIM_Cmd(TIM4, DISABLE);
-    }
+    TIM_Cmd(TIM4, enable ? ENABLE : DISABLE);
 }
@@ -151,3 +151,49 @@ SCENARIO("ActuatorDigitalChangeLogged test", "[ActuatorChangeLog]")
         }
     }
 }
+
+SCENARIO("ActuatorDigitalChangeLog with a longer history", "[ActuatorChangeLog]")
+{
+    using State = ActuatorDigitalBase::State;
+
+    auto mockIo = std::make_shared<MockIoArray>();
+    auto mock = ActuatorDigital([mockIo]() { return mockIo; }, 1);
+    auto logged = ActuatorDigitalChangeLog<9>(mock);
+
+    WHEN("The actuator toggled more often than the default history length")
+    {
+        for (ticks_millis_t now = 1000; now <= 5000; now += 1000) {
+            logged.state(((now / 1000) % 2) == 1 ? State::Active : State::Inactive, now);
+        }
+
+        THEN("The initial Unknown state is still in the history")
+        {
+            auto times = logged.getLastStartEndTime(State::Unknown, 6000);
+            CHECK(times.start == ticks_millis_t(-1));
+            CHECK(times.end == 0);
+        }
+
+        THEN("The durations only include the current and previous period")
+        {
+            auto durations = logged.activeDurations(6000);
+            CHECK(durations.currentActive == 1000);
+            CHECK(durations.currentPeriod == 2000);
+            CHECK(durations.previousActive == 1000);
+            CHECK(durations.previousPeriod == 2000);
+        }
+
+        THEN("The oldest changes are dropped when the history is full")
+        {
+            for (ticks_millis_t now = 6000; now <= 9000; now += 1000) {
+                logged.state(((now / 1000) % 2) == 1 ? State::Active : State::Inactive, now);
+            }
+            auto times = logged.getLastStartEndTime(State::Unknown, 10000);
+            CHECK(times.start == 10001);
+            CHECK(times.end == 10001);
+
+            times = logged.getLastStartEndTime(State::Inactive, 10000);
+            CHECK(times.start == 8000);
+            CHECK(times.end == 9000);
+        }
+    }
+}
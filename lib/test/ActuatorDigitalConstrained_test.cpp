@@ -397,3 +397,77 @@ SCENARIO("Mutex contraint", "[constraints]")
         }
     }
 }
+
+SCENARIO("ActuatorDigitalConstrained update interval", "[constraints]")
+{
+    auto mockIo = std::make_shared<MockIoArray>();
+    auto mock = ActuatorDigital([mockIo]() { return mockIo; }, 1);
+    auto constrained = ActuatorDigitalConstrained(mock);
+
+    WHEN("No transition is pending, the actuator is updated once per second")
+    {
+        constrained.desiredState(State::Active, 1000);
+        CHECK(constrained.update(1001) == 1000);
+    }
+
+    WHEN("A transition is blocked by a minimum ON time")
+    {
+        constrained.addConstraint(std::make_unique<ADConstraints::MinOnTime<2>>(1500));
+        constrained.desiredState(State::Active, 1000);
+        CHECK(constrained.desiredState(State::Inactive, 1100) == 1400);
+
+        THEN("The update is scheduled at the time it is allowed")
+        {
+            CHECK(constrained.update(1200) == 1000);
+            CHECK(constrained.update(2100) == 400);
+            CHECK(constrained.state() == State::Active);
+            CHECK(constrained.update(2500) == 1000);
+            CHECK(constrained.state() == State::Inactive);
+        }
+
+        THEN("The cached wait follows time and is reported by the constraint")
+        {
+            CHECK(constrained.desiredState(State::Inactive, 2000) == 500);
+            CHECK(constrained.constraintsList().front()->timeRemaining() == 500);
+        }
+
+        THEN("Changing the desired state back clears the wait")
+        {
+            CHECK(constrained.desiredState(State::Active, 1200) == 0);
+            CHECK(constrained.constraintsList().front()->timeRemaining() == 0);
+            CHECK(constrained.update(1300) == 1000);
+        }
+    }
+
+    WHEN("The actuator has a mutex constraint, it is updated every time to release or acquire the mutex")
+    {
+        auto mut = std::make_shared<MutexTarget>();
+        constrained.addConstraint(std::make_unique<ADConstraints::Mutex<3>>(
+            [mut]() {
+                return mut;
+            },
+            0, true));
+        constrained.desiredState(State::Active, 1000);
+        CHECK(constrained.update(1001) == 0);
+    }
+
+    WHEN("An actuator on a bus has a mutex constraint, it is polled at a limited rate")
+    {
+        struct BusActuator final : public ActuatorDigitalBase {
+            State s = State::Inactive;
+            virtual void state(const State& v) override final { s = v; }
+            virtual State state() const override final { return s; }
+            virtual bool supportsFastIo() const override final { return false; }
+        } busActuator;
+        auto busConstrained = ActuatorDigitalConstrained(busActuator);
+
+        auto mut = std::make_shared<MutexTarget>();
+        busConstrained.addConstraint(std::make_unique<ADConstraints::Mutex<3>>(
+            [mut]() {
+                return mut;
+            },
+            0, true));
+        busConstrained.desiredState(State::Active, 1000);
+        CHECK(busConstrained.update(1001) == ActuatorDigitalConstrained::slowIoPollInterval());
+    }
+}
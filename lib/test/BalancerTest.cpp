@@ -0,0 +1,134 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "ActuatorAnalogConstrained.h"
+#include "ActuatorAnalogMock.h"
+#include "Balancer.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using value_t = ActuatorAnalog::value_t;
+
+SCENARIO("Balancer requester registration", "[balancer]")
+{
+    BalancerImpl balancer;
+
+    WHEN("Requesters register, they get the lowest free id")
+    {
+        CHECK(balancer.registerEntry() == 1);
+        CHECK(balancer.registerEntry() == 2);
+        CHECK(balancer.registerEntry() == 3);
+
+        balancer.unregisterEntry(2);
+        CHECK(balancer.clients().size() == 2);
+        CHECK(balancer.registerEntry() == 2);
+
+        THEN("Clients are listed in order of registration")
+        {
+            REQUIRE(balancer.clients().size() == 3);
+            CHECK(balancer.clients()[0].id == 1);
+            CHECK(balancer.clients()[1].id == 3);
+            CHECK(balancer.clients()[2].id == 2);
+        }
+
+        THEN("Requests are found by id after other requesters were removed")
+        {
+            uint8_t id3 = 3;
+            uint8_t id2 = 2;
+            balancer.constrain(id3, 40);
+            balancer.constrain(id2, 60);
+            balancer.unregisterEntry(1);
+            balancer.update();
+            CHECK(balancer.granted(3) == value_t(40));
+            CHECK(balancer.granted(2) == value_t(60));
+            CHECK(balancer.granted(1) == value_t(0));
+            CHECK(id3 == 3);
+        }
+    }
+
+    WHEN("An unknown requester requests a value, it is registered")
+    {
+        uint8_t id = 200;
+        CHECK(balancer.constrain(id, 50) == value_t(0));
+        CHECK(id == 1);
+    }
+
+    WHEN("All ids are in use, registering returns 0")
+    {
+        for (uint16_t i = 0; i < BalancerImpl::maxRequesters; i++) {
+            balancer.registerEntry();
+        }
+        CHECK(balancer.registerEntry() == 0);
+    }
+
+    WHEN("Many requesters request the maximum, the total does not saturate")
+    {
+        std::vector<uint8_t> ids;
+        for (uint8_t i = 0; i < 40; i++) {
+            ids.push_back(balancer.registerEntry());
+        }
+        for (auto& id : ids) {
+            balancer.constrain(id, 100);
+        }
+        balancer.update();
+        for (auto& id : ids) {
+            CHECK(balancer.granted(id) == Approx(2.5).margin(0.001));
+        }
+    }
+}
+
+SCENARIO("Benchmark balancer with 32 balanced actuators", "[balancer][.benchmark]")
+{
+    constexpr int numActuators = 32;
+    constexpr int iterations = 10000;
+
+    auto balancer = std::make_shared<Balancer<2>>();
+    std::vector<std::unique_ptr<ActuatorAnalogMock>> actuators;
+    std::vector<std::unique_ptr<ActuatorAnalogConstrained>> constrained;
+    for (int i = 0; i < numActuators; i++) {
+        actuators.push_back(std::make_unique<ActuatorAnalogMock>());
+        actuators.back()->minSetting(0);
+        actuators.back()->maxSetting(100);
+        constrained.push_back(std::make_unique<ActuatorAnalogConstrained>(*actuators.back()));
+        constrained.back()->addConstraint(std::make_unique<AAConstraints::Balanced<2>>([balancer]() { return balancer; }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (int a = 0; a < numActuators; a++) {
+            constrained[a]->setting((i + a) % 100);
+        }
+        balancer->update();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Balancer with " << numActuators << " actuators: "
+              << std::chrono::duration<double, std::nano>(end - start).count() / iterations
+              << " ns per update of all actuators and the balancer" << std::endl;
+
+    value_t total = 0;
+    for (auto& client : balancer->clients()) {
+        total += client.granted;
+    }
+    CHECK(total <= value_t(100.01));
+}
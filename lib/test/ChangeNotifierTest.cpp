@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "ActuatorAnalogConstrained.h"
+#include "ActuatorAnalogMock.h"
+#include "ActuatorDigital.h"
+#include "ActuatorDigitalConstrained.h"
+#include "ChangeNotifier.h"
+#include "MockIoArray.h"
+
+using State = ActuatorDigital::State;
+
+SCENARIO("Change notification", "[changes]")
+{
+    uint32_t notified = 0;
+    auto listener = std::make_shared<ChangeNotifier::Listener>([&notified]() { ++notified; });
+
+    WHEN("A listener is subscribed to a notifier")
+    {
+        ChangeNotifier notifier;
+        notifier.subscribe(listener);
+        notifier.subscribe(listener);
+        CHECK(notifier.listeners() == 1);
+
+        notifier.notify();
+        CHECK(notified == 1);
+
+        THEN("A destroyed listener is removed on the next notification")
+        {
+            listener.reset();
+            notifier.notify();
+            CHECK(notifier.listeners() == 0);
+            CHECK(notified == 1);
+        }
+    }
+
+    WHEN("A listener is subscribed to a constrained digital actuator")
+    {
+        auto now = ticks_millis_t(0);
+        auto mockIo = std::make_shared<MockIoArray>();
+        auto mock = ActuatorDigital([mockIo]() { return mockIo; }, 1);
+        auto constrained = ActuatorDigitalConstrained(mock);
+        constrained.desiredState(State::Inactive, now);
+        constrained.changes().subscribe(listener);
+
+        THEN("It is notified when the desired state changes")
+        {
+            constrained.desiredState(State::Active, now);
+            CHECK(notified == 1);
+        }
+
+        THEN("It is not notified when the same state is applied again")
+        {
+            constrained.desiredState(State::Inactive, ++now);
+            constrained.update(++now);
+            CHECK(notified == 0);
+        }
+
+        THEN("It is notified when a blocked state change is applied by a later update")
+        {
+            constrained.addConstraint(std::make_unique<ADConstraints::MinOffTime<1>>(1000));
+            constrained.desiredState(State::Active, now);
+            CHECK(constrained.state() == State::Inactive);
+            CHECK(notified == 1);
+
+            now += 1000;
+            constrained.update(now);
+            CHECK(constrained.state() == State::Active);
+            CHECK(notified == 2);
+        }
+    }
+
+    WHEN("A listener is subscribed to a constrained analog actuator")
+    {
+        auto mock = ActuatorAnalogMock();
+        auto constrained = ActuatorAnalogConstrained(mock);
+        constrained.setting(10);
+        constrained.changes().subscribe(listener);
+
+        THEN("It is notified when the setting changes, but not when the same setting is written again")
+        {
+            constrained.setting(10);
+            CHECK(notified == 0);
+            constrained.setting(20);
+            CHECK(notified == 1);
+        }
+
+        THEN("It is notified when the setting becomes invalid")
+        {
+            constrained.settingValid(false);
+            CHECK(notified == 1);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+
+#include "FilterBank.h"
+#include "FilterChain.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+SCENARIO("A filter bank gives the same result as separate filter chains", "[filterbank]")
+{
+    // the configuration of the stages of the bank
+    const std::vector<uint8_t> params = {0, 2, 2, 2, 2, 2};
+    const std::vector<uint8_t> intervals = {2, 2, 2, 3, 3, 4};
+    constexpr uint8_t numChannels = 10;
+
+    FilterBank bank;
+    std::vector<std::unique_ptr<FilterChain>> chains;
+    std::vector<FilterBank::channel_t> channels;
+    std::vector<int32_t> values;
+    for (uint8_t i = 0; i < numChannels; i++) {
+        int32_t threshold = (i % 2) ? 5000 : std::numeric_limits<int32_t>::max();
+        chains.push_back(std::make_unique<FilterChain>(params, intervals, threshold));
+        channels.push_back(bank.addChannel(threshold));
+        values.push_back(i * 1000);
+    }
+
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int32_t> noise(-300, 300);
+    std::uniform_int_distribution<int32_t> percent(0, 99);
+
+    auto check = [&]() {
+        bank.step();
+        for (uint8_t i = 0; i < numChannels; i++) {
+            CAPTURE(i);
+            REQUIRE(bank.getCount(channels[i]) == chains[i]->getCount());
+            REQUIRE(bank.readLastInput(channels[i]) == chains[i]->readLastInput());
+            for (uint8_t f = 0; f < chains[i]->length(); f++) {
+                CAPTURE(f);
+                REQUIRE(bank.read(channels[i], f) == chains[i]->read(f));
+                REQUIRE(bank.readWithNFractionBits(channels[i], f, 32) == chains[i]->readWithNFractionBits(f, 32));
+                REQUIRE(bank.readDerivative(channels[i], f).result == chains[i]->readDerivative(f).result);
+            }
+        }
+    };
+
+    WHEN("All channels receive a value on each step")
+    {
+        for (uint32_t t = 0; t < 3000; t++) {
+            for (uint8_t i = 0; i < numChannels; i++) {
+                values[i] += noise(gen) + (t % 1000 == 500 ? 100000 : 0);
+                bank.add(channels[i], values[i]);
+                chains[i]->add(values[i]);
+            }
+            CAPTURE(t);
+            check();
+        }
+    }
+
+    WHEN("Channels skip values, receive multiple values between steps and are reset")
+    {
+        for (uint32_t t = 0; t < 3000; t++) {
+            for (uint8_t i = 0; i < numChannels; i++) {
+                auto p = percent(gen);
+                if (p < 20) {
+                    continue; // no value for this channel
+                }
+                if (p < 22) {
+                    bank.step(); // reset applies after the pending value has been processed
+                    bank.reset(channels[i], values[i]);
+                    chains[i]->reset(values[i]);
+                }
+                values[i] += noise(gen);
+                bank.add(channels[i], values[i]);
+                chains[i]->add(values[i]);
+                if (p > 90) {
+                    // second value, steps the bank before it is added
+                    values[i] += noise(gen);
+                    bank.add(channels[i], values[i]);
+                    chains[i]->add(values[i]);
+                }
+            }
+            CAPTURE(t);
+            check();
+        }
+    }
+
+    WHEN("A channel is removed and a new channel is added")
+    {
+        for (uint32_t t = 0; t < 100; t++) {
+            for (uint8_t i = 0; i < numChannels; i++) {
+                bank.add(channels[i], values[i]);
+                chains[i]->add(values[i]);
+            }
+        }
+        bank.removeChannel(channels[3]);
+        CHECK(bank.channels() == numChannels - 1);
+
+        THEN("The new channel reuses the slot and starts from zero")
+        {
+            auto newChannel = bank.addChannel(5000);
+            CHECK(newChannel == channels[3]);
+            CHECK(bank.channels() == numChannels);
+            chains[3] = std::make_unique<FilterChain>(params, intervals, 5000);
+            check();
+        }
+    }
+
+    WHEN("Channels are added while the others are filtering")
+    {
+        for (uint32_t t = 0; t < 100; t++) {
+            for (uint8_t i = 0; i < numChannels; i++) {
+                values[i] += noise(gen);
+                bank.add(channels[i], values[i]);
+                chains[i]->add(values[i]);
+            }
+        }
+        auto oldCapacity = bank.capacity();
+        for (uint8_t i = 0; i < FilterBank::chunkSize; i++) {
+            bank.addChannel();
+        }
+
+        THEN("A chunk of channels is added and the existing channels keep their history")
+        {
+            CHECK(bank.capacity() == oldCapacity + FilterBank::chunkSize);
+            check();
+        }
+    }
+}
+
+SCENARIO("A filter bank without an owner steps on each add", "[filterbank]")
+{
+    FilterBank bank;
+    FilterChain chain({0, 2, 2, 2, 2, 2}, {2, 2, 2, 3, 3, 4});
+    auto channel = bank.addChannel();
+
+    uint32_t steps = 0;
+    auto listener = std::make_shared<ChangeNotifier::Listener>([&steps]() { ++steps; });
+    bank.stepped().subscribe(listener);
+
+    WHEN("Step on add is disabled, values are pending until the owner steps the bank")
+    {
+        bank.add(channel, 1000);
+        CHECK(bank.isPending(channel));
+        CHECK(steps == 0);
+        CHECK(bank.readLastInput(channel) == 0);
+
+        bank.step();
+        CHECK_FALSE(bank.isPending(channel));
+        CHECK(steps == 1);
+        CHECK(bank.readLastInput(channel) == 1000);
+    }
+
+    WHEN("Step on add is enabled, each value is processed right away")
+    {
+        bank.stepOnAdd(true);
+        for (int32_t v = 0; v < 100; v++) {
+            bank.add(channel, v * 10);
+            chain.add(v * 10);
+            CHECK_FALSE(bank.isPending(channel));
+            CHECK(bank.read(channel, 5) == chain.read(5));
+        }
+        CHECK(steps == 100);
+    }
+}
+
+SCENARIO("Benchmark filter bank", "[filterbank][.benchmark]")
+{
+    const std::vector<uint8_t> params = {0, 2, 2, 2, 2, 2};
+    const std::vector<uint8_t> intervals = {2, 2, 2, 3, 3, 4};
+    constexpr uint32_t samplesPerChannel = 20000;
+
+    for (uint16_t numChannels : {8, 32, 128}) {
+        std::vector<FilterChain> chains(numChannels, FilterChain(params, intervals));
+        FilterBank bank;
+        for (uint16_t c = 0; c < numChannels; c++) {
+            bank.addChannel();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t t = 0; t < samplesPerChannel; t++) {
+            for (uint16_t c = 0; c < numChannels; c++) {
+                chains[c].add(int32_t(t + c));
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double chainSeconds = std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t t = 0; t < samplesPerChannel; t++) {
+            for (uint16_t c = 0; c < numChannels; c++) {
+                bank.add(c, int32_t(t + c));
+            }
+            bank.step();
+        }
+        end = std::chrono::steady_clock::now();
+        double bankSeconds = std::chrono::duration<double>(end - start).count();
+
+        double samples = double(samplesPerChannel) * numChannels;
+        std::cout << numChannels << " channels, FilterChain per channel: " << samples / chainSeconds << " samples per second" << std::endl;
+        std::cout << numChannels << " channels, FilterBank: " << samples / bankSeconds << " samples per second" << std::endl;
+
+        CHECK(bank.read(numChannels - 1, 5) == chains[numChannels - 1].read(5));
+    }
+}
@@ -24,6 +24,7 @@
 #include "TestMatchers.hpp"
 #include <algorithm> // std::copy
 #include <cassert>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <iterator> // std::ostream_iterator
@@ -424,3 +425,86 @@ SCENARIO("Filters chain output matches manually cascaded filters", "[filterchain
         }
     }
 }
+
+SCENARIO("Benchmark 6 stage filter chain", "[filterchain][.benchmark]")
+{
+    constexpr uint32_t samples = 1000000;
+    // same configuration as FpFilterChain
+    FilterChain chain({0, 2, 2, 2, 2, 2}, {2, 2, 2, 3, 3, 4});
+
+    int32_t v = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < samples; i++) {
+        v += (i % 512 < 256) ? 17 : -17; // triangle wave
+        chain.add(v);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::cout << "FilterChain::add (6 stages): " << samples / seconds << " samples per second" << std::endl;
+
+    CHECK(chain.read() != 0);
+}
+
+SCENARIO("Adding a block of values to a filter chain", "[filterchain][block]")
+{
+    std::vector<int32_t> input;
+    int32_t v = 0;
+    for (uint32_t i = 0; i < 5000; i++) {
+        v += (i % 300 < 150) ? 31 : -29;
+        if (i % 1000 == 999) {
+            v += 100000; // step to trigger step detection
+        }
+        input.push_back(v);
+    }
+
+    for (size_t blockSize : {1, 3, 16, 17, 100, 5000}) {
+        GIVEN("A block size of " + std::to_string(blockSize))
+        {
+            FilterChain sequential({0, 2, 2, 2, 2, 2}, {2, 2, 2, 3, 3, 4}, 5000);
+            FilterChain blocks({0, 2, 2, 2, 2, 2}, {2, 2, 2, 3, 3, 4}, 5000);
+
+            THEN("The result is identical to adding the values one by one")
+            {
+                for (size_t start = 0; start < input.size(); start += blockSize) {
+                    size_t count = std::min(blockSize, input.size() - start);
+                    for (size_t i = start; i < start + count; i++) {
+                        sequential.add(input[i]);
+                    }
+                    blocks.add(&input[start], count);
+
+                    CAPTURE(start);
+                    REQUIRE(blocks.getCount() == sequential.getCount());
+                    REQUIRE(blocks.readLastInput() == sequential.readLastInput());
+                    for (uint8_t f = 0; f < sequential.length(); f++) {
+                        CAPTURE(f);
+                        REQUIRE(blocks.readWithNFractionBits(f, 32) == sequential.readWithNFractionBits(f, 32));
+                        REQUIRE(blocks.readDerivative(f).result == sequential.readDerivative(f).result);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Benchmark adding a block of values to a 6 stage filter chain", "[filterchain][.benchmark]")
+{
+    constexpr uint32_t samples = 1000000;
+    FilterChain chain({0, 2, 2, 2, 2, 2}, {2, 2, 2, 3, 3, 4});
+
+    std::vector<int32_t> input;
+    int32_t v = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+        v += (i % 512 < 256) ? 17 : -17; // triangle wave
+        input.push_back(v);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    chain.add(input.data(), input.size());
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::cout << "FilterChain::add (6 stages, block): " << samples / seconds << " samples per second" << std::endl;
+
+    CHECK(chain.read() != 0);
+}
@@ -212,3 +212,24 @@ SCENARIO("Fixed point filterchain using temp_t")
         }
     }
 }
+
+SCENARIO("Adding a block of values to a fixed point filterchain", "[filterchain][block]")
+{
+    std::vector<temp_t> input;
+    for (uint32_t t = 0; t < 2000; ++t) {
+        input.push_back(temp_t(20) + temp_t(sin(2.0 * M_PI * t / 300)));
+    }
+
+    auto sequential = FpFilterChain<temp_t>(3);
+    auto blocks = FpFilterChain<temp_t>(3);
+
+    for (auto& v : input) {
+        sequential.add(v);
+    }
+    blocks.add(input.data(), input.size());
+
+    for (uint8_t f = 0; f < sequential.length(); ++f) {
+        CHECK(blocks.read(f) == sequential.read(f));
+    }
+    CHECK(blocks.readLastInput() == sequential.readLastInput());
+}
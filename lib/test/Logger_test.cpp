@@ -0,0 +1,76 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "Logger.h"
+#include "OneWireAddress.h"
+#include <string>
+#include <vector>
+
+namespace {
+ticks_millis_t loggerTestTime = 0;
+}
+
+SCENARIO("Log records are buffered and formatted when drained", "[logger]")
+{
+    loggerTestTime = 0;
+    std::vector<std::pair<Logger::LogLevel, std::string>> written;
+    Logger testLogger([&written](Logger::LogLevel level, const char* msg) {
+        written.emplace_back(level, msg);
+    },
+                      []() { return loggerTestTime; });
+
+    WHEN("A record is logged, nothing is written until the logger is drained")
+    {
+        loggerTestTime = 1234;
+        testLogger.log(Logger::WARN, Logger::LogCode::DS2413_DISCONNECTED, 0x0123456789ABCDEF);
+        CHECK(written.empty());
+        CHECK(testLogger.pending() == 1);
+
+        loggerTestTime = 2000;
+        testLogger.drain();
+        REQUIRE(written.size() == 1);
+        CHECK(written[0].first == Logger::WARN);
+        CHECK(written[0].second == "[1234] DS2413 disconnected: " + OneWireAddress(0x0123456789ABCDEF).toString());
+        CHECK(testLogger.pending() == 0);
+    }
+
+    WHEN("More records are logged than fit in the buffer, the extra records are dropped and counted")
+    {
+        for (uint8_t i = 0; i < LOG_BUFFER_SIZE + 3; ++i) {
+            testLogger.log(Logger::INFO, Logger::LogCode::DS2408_CONNECTED, i);
+        }
+        CHECK(testLogger.pending() == LOG_BUFFER_SIZE);
+        CHECK(testLogger.dropped() == 3);
+
+        testLogger.drain();
+        REQUIRE(written.size() == LOG_BUFFER_SIZE + 1);
+        CHECK(written.back().first == Logger::WARN);
+        CHECK(written.back().second == "[0] Log buffer full, records dropped: 3");
+
+        AND_WHEN("The buffer is drained again, the overflow is not reported twice")
+        {
+            written.clear();
+            testLogger.log(Logger::INFO, Logger::LogCode::DS2408_CONNECTED, 1);
+            testLogger.drain();
+            CHECK(written.size() == 1);
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "DS2408.h"
+#include "MotorValve.h"
+#include "OneWire.h"
+#include "OneWireSimulatedAddress.h"
+#include "OneWireSimulator.h"
+#include <memory>
+
+SCENARIO("Motor valves on a simulated DS2408", "[ds2408]")
+{
+    OneWireSimulator driver;
+    OneWire ow(driver);
+    auto model = std::make_shared<OneWireSimulatedDS2408>(makeAddress(DS2408_FAMILY_ID, 0x12));
+    driver.attach(model);
+
+    auto ds = std::make_shared<DS2408>(ow, makeAddress(DS2408_FAMILY_ID, 0x12));
+    ds->update();
+    REQUIRE(ds->connected());
+
+    WHEN("Several channels are written between beginWrites and commitWrites")
+    {
+        auto writesBefore = model->writes();
+        ds->beginWrites();
+        ds->writeChannelConfig(1, IoArray::ChannelConfig::ACTIVE_HIGH);
+        ds->writeChannelConfig(2, IoArray::ChannelConfig::ACTIVE_HIGH);
+        ds->beginWrites(); // nested
+        ds->writeChannelConfig(8, IoArray::ChannelConfig::ACTIVE_HIGH);
+        CHECK(ds->commitWrites());
+        CHECK(model->writes() == writesBefore);
+        CHECK(model->latches() == 0xFF);
+        CHECK(ds->commitWrites());
+
+        THEN("They are written to the device with a single latch write")
+        {
+            CHECK(model->writes() == writesBefore + 1);
+            CHECK(model->latches() == uint8_t(~0x83));
+        }
+
+        THEN("Writing the same latches again does not access the bus")
+        {
+            driver.resetStats();
+            ds->beginWrites();
+            ds->writeChannelConfig(1, IoArray::ChannelConfig::ACTIVE_HIGH);
+            CHECK(ds->commitWrites());
+            CHECK(driver.stats().resets == 0);
+        }
+    }
+
+    WHEN("A latch write is corrupted on the bus")
+    {
+        driver.errors(OneWireSimulator::Errors{1, 0});
+        ds->beginWrites();
+        ds->writeChannelConfig(1, IoArray::ChannelConfig::ACTIVE_HIGH);
+
+        THEN("The commit reports the failure")
+        {
+            CHECK_FALSE(ds->commitWrites());
+        }
+    }
+
+    WHEN("Two valves share the device")
+    {
+        MotorValve valve1([ds]() { return ds; }, 1);
+        MotorValve valve2([ds]() { return ds; }, 5);
+        CHECK(valve1.channelReady());
+        CHECK(valve2.channelReady());
+
+        THEN("Each valve change is a single latch write")
+        {
+            driver.resetStats();
+            auto writesBefore = model->writes();
+
+            valve1.state(ActuatorDigitalBase::State::Active);
+            CHECK(model->writes() == writesBefore + 1);
+            // opening enables the latch of the closing channel (4), valve 2 is still idle with both latches enabled
+            CHECK(model->latches() == uint8_t(~0xC8));
+
+            valve2.state(ActuatorDigitalBase::State::Active);
+            CHECK(model->writes() == writesBefore + 2);
+            CHECK(model->latches() == uint8_t(~0x88));
+
+            valve1.state(ActuatorDigitalBase::State::Inactive);
+            CHECK(model->writes() == writesBefore + 3);
+            CHECK(model->latches() == uint8_t(~0x84));
+
+            // one reset before and one after each access write
+            CHECK(driver.stats().resets == 2 * 3);
+        }
+
+        THEN("With deferred writes, all valve changes of a pass are a single latch write")
+        {
+            ds->deferWrites(true);
+            driver.resetStats();
+            auto writesBefore = model->writes();
+
+            valve1.state(ActuatorDigitalBase::State::Active);
+            valve2.state(ActuatorDigitalBase::State::Active);
+            CHECK(model->writes() == writesBefore);
+            CHECK(valve1.state() == ActuatorDigitalBase::State::Active);
+
+            CHECK(ds->flushWrites());
+            CHECK(model->writes() == writesBefore + 1);
+            CHECK(model->latches() == uint8_t(~0x88));
+            CHECK(driver.stats().resets == 2);
+
+            AND_THEN("Later changes are deferred until the next flush")
+            {
+                valve1.state(ActuatorDigitalBase::State::Inactive);
+                CHECK(model->writes() == writesBefore + 1);
+                CHECK(ds->flushWrites());
+                CHECK(model->writes() == writesBefore + 2);
+                CHECK(model->latches() == uint8_t(~0x84));
+            }
+
+            AND_THEN("Ending the deferral writes the pending changes")
+            {
+                valve1.state(ActuatorDigitalBase::State::Inactive);
+                ds->deferWrites(false);
+                CHECK(model->writes() == writesBefore + 2);
+                valve2.state(ActuatorDigitalBase::State::Inactive);
+                CHECK(model->writes() == writesBefore + 3);
+            }
+        }
+
+        THEN("The end switches are sensed after the next device update")
+        {
+            valve1.state(ActuatorDigitalBase::State::Active);
+            model->externalPullDown(1, true); // is open switch of valve 1
+            ds->update();
+            valve1.update();
+            CHECK(valve1.valveState() == MotorValve::ValveState::Open);
+        }
+    }
+}
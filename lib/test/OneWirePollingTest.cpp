@@ -0,0 +1,102 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "OneWirePolling.h"
+#include <algorithm>
+
+SCENARIO("OneWire device polling policy", "[onewire]")
+{
+    WHEN("A device is polled at its interval")
+    {
+        OneWirePolling polling(2000);
+        CHECK(polling.due(0));
+
+        ticks_millis_t now = 0;
+        for (int i = 0; i < 10; i++) {
+            REQUIRE(polling.due(now));
+            polling.polled(now, true, 1500);
+            CHECK_FALSE(polling.due(now + 1999));
+            now = polling.next();
+        }
+
+        THEN("The achieved sample interval and bus time are reported")
+        {
+            CHECK(polling.samples() == 10);
+            CHECK(polling.sampleInterval() == 2000);
+            CHECK(polling.busTime() == 1500);
+            CHECK(polling.busLoad() == 750); // 1.5 ms every 2 seconds
+        }
+    }
+
+    WHEN("Polling fails")
+    {
+        OneWirePolling polling(1000);
+        ticks_millis_t now = 0;
+        polling.polled(now, true, 1000);
+
+        THEN("The interval doubles for each failure, up to the maximum backoff")
+        {
+            duration_millis_t expected = 1000;
+            for (int i = 0; i < 10; i++) {
+                now = polling.next();
+                polling.polled(now, false, 1000);
+                expected = std::min(2 * expected, OneWirePolling::maxBackoff);
+                CHECK(polling.currentInterval() == expected);
+            }
+            CHECK(polling.failures() == 10);
+
+            AND_THEN("The first successful poll restores the interval")
+            {
+                polling.polled(polling.next(), true, 1000);
+                CHECK(polling.currentInterval() == 1000);
+                CHECK(polling.failures() == 0);
+            }
+        }
+    }
+
+    WHEN("A device is polled on demand")
+    {
+        OneWirePolling polling(1000, OneWirePolling::Mode::OnDemand);
+        polling.polled(0, true, 1000);
+
+        THEN("It is polled at the idle interval while the value is not used")
+        {
+            CHECK(polling.next() == OneWirePolling::idleInterval);
+        }
+
+        THEN("It is polled at the configured interval while the value is used")
+        {
+            polling.demand();
+            CHECK(polling.next() == 1000);
+            polling.polled(1000, true, 1000);
+            CHECK(polling.next() == 1000 + OneWirePolling::idleInterval);
+        }
+
+        THEN("While idle it is checked at the configured interval, so a new demand is picked up")
+        {
+            CHECK(polling.nextCheck(0) == 1000);
+            CHECK_FALSE(polling.due(1000));
+            polling.demand();
+            CHECK(polling.due(1000));
+            CHECK(polling.nextCheck(1000) == 1000);
+        }
+    }
+}
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "DS2408.h"
+#include "DS2413.h"
+#include "DallasTemperature.h"
+#include "OneWire.h"
+#include "OneWireScanner.h"
+#include "OneWireSearch.h"
+#include "OneWireSimulatedAddress.h"
+#include "OneWireSimulator.h"
+#include "OneWireTransactions.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+SCENARIO("Incremental OneWire search", "[onewire]")
+{
+    OneWireSimulator driver;
+    OneWire ow(driver);
+
+    std::vector<std::shared_ptr<OneWireSimulatedDevice>> devices{
+        std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 1)),
+        std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 2)),
+        std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 0x81)),
+        std::make_shared<OneWireSimulatedDS2413>(makeAddress(DS2413_FAMILY_ID, 7)),
+        std::make_shared<OneWireSimulatedDS2408>(makeAddress(DS2408_FAMILY_ID, 9)),
+    };
+    for (auto& d : devices) {
+        driver.attach(d);
+    }
+
+    std::vector<OneWireAddress> expected;
+    OneWireAddress address;
+    ow.reset_search();
+    while (ow.search(address.asUint8ptr())) {
+        expected.push_back(address);
+    }
+    REQUIRE(expected.size() == devices.size());
+
+    OneWireSearch search(ow);
+    search.reset();
+    std::vector<OneWireAddress> found;
+
+    WHEN("The search is spread over many calls")
+    {
+        uint32_t calls = 0;
+        while (!search.done()) {
+            if (search.step(address, 8)) {
+                found.push_back(address);
+            }
+            ++calls;
+        }
+
+        THEN("The same devices are found in the same order as a blocking search")
+        {
+            CHECK(found == expected);
+            CHECK(search.restarts() == 0);
+            CHECK(calls >= devices.size() * 65 / 8);
+        }
+
+        AND_WHEN("The search is reset")
+        {
+            search.reset();
+            found.clear();
+            while (!search.done()) {
+                if (search.step(address, 65)) {
+                    found.push_back(address);
+                }
+            }
+
+            THEN("The devices are found again")
+            {
+                CHECK(found == expected);
+            }
+        }
+    }
+
+    WHEN("The bus is used by others in between calls")
+    {
+        DallasTemperature sensor(&ow);
+        uint32_t calls = 0;
+        while (!search.done() && calls < 10000) {
+            if (search.step(address, 10)) {
+                found.push_back(address);
+            }
+            if (++calls % 9 == 0) { // a device needs 7 uninterrupted calls
+                uint8_t scratchPad[9];
+                CHECK(sensor.readScratchPadCRC(devices[0]->address().asUint8ptr(), scratchPad));
+            }
+        }
+
+        THEN("The interrupted devices are searched again and each device is found once")
+        {
+            CHECK(search.restarts() > 0);
+            CHECK(found == expected);
+        }
+    }
+
+    WHEN("A call is limited to a number of steps with DS2482 timing")
+    {
+        driver.timing(OneWireSimulator::ds2482Timing);
+        const uint16_t maxSteps = 8;
+        const auto& t = OneWireSimulator::ds2482Timing;
+        // a step is the reset with the search command, or a triplet command with 3 bit slots
+        const duration_micros_t maxStep = std::max(t.command + t.reset + t.command + t.byte, t.command + 3 * t.bit);
+        duration_micros_t longest = 0;
+        while (!search.done()) {
+            auto start = driver.micros();
+            if (search.step(address, maxSteps)) {
+                found.push_back(address);
+            }
+            longest = std::max(longest, driver.micros() - start);
+        }
+
+        THEN("The bus time per call is bounded")
+        {
+            CHECK(found == expected);
+            CHECK(longest <= maxStep * maxSteps);
+            CHECK(longest < 4000);
+        }
+    }
+
+    WHEN("The bus has no devices")
+    {
+        for (auto& d : devices) {
+            driver.detach(d->address());
+        }
+
+        THEN("The search is done after the reset")
+        {
+            CHECK_FALSE(search.step(address, 8));
+            CHECK(search.done());
+        }
+    }
+
+    WHEN("Transactions are queued on the bus")
+    {
+        driver.timing(OneWireSimulator::ds2482Timing);
+        OneWireTransactions transactions(ow, [&driver]() { return driver.micros(); });
+        uint32_t completed = 0;
+        auto submitRead = [&]() {
+            transactions.submit(OneWireTransaction(devices[0]->address(), {READSCRATCH}, 9, nullptr, [&completed](const OneWireTransaction& t) {
+                CHECK(t.success);
+                ++completed;
+            }));
+        };
+        submitRead();
+        transactions.process(1000); // the first transaction is in progress
+
+        THEN("A device search starts after the transaction in progress and holds the bus until the device is found")
+        {
+            CHECK_FALSE(search.step(address, 8));
+            CHECK_FALSE(ow.held());
+
+            uint32_t passes = 0;
+            while (!search.done()) {
+                if (search.step(address, 8)) {
+                    found.push_back(address);
+                    CHECK_FALSE(ow.held());
+                } else if (!transactions.inProgress()) {
+                    CHECK(ow.held());
+                }
+                if (transactions.pending() == 0) {
+                    submitRead(); // a client that keeps reading
+                }
+                transactions.process(1000);
+                driver.advance(1000); // rest of the main loop
+                REQUIRE(++passes < 10000);
+            }
+            CHECK(found == expected);
+            CHECK(search.restarts() == 0);
+            CHECK(completed > 0);
+            CHECK(transactions.stats().failed == 0);
+        }
+    }
+}
+
+SCENARIO("Background scan of the OneWire bus", "[onewire]")
+{
+    OneWireSimulator driver;
+    OneWire ow(driver);
+    OneWireScanner scanner(ow);
+
+    auto sensor1 = std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 1));
+    auto sensor2 = std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 2));
+    auto sensor3 = std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 4)); // searched before the others
+    auto switch2413 = std::make_shared<OneWireSimulatedDS2413>(makeAddress(DS2413_FAMILY_ID, 7));
+    driver.attach(sensor1);
+    driver.attach(sensor2);
+
+    // one update per pass of the main loop
+    ticks_millis_t now = 0;
+    auto runScan = [&]() {
+        auto scans = scanner.completedScans();
+        while (scanner.completedScans() == scans) {
+            scanner.update(now++);
+        }
+    };
+
+    WHEN("The first scan completes, all devices are listed")
+    {
+        runScan();
+        CHECK(scanner.devices().size() == 2);
+        CHECK_FALSE(scanner.scanning());
+
+        THEN("The next scan starts after the scan interval")
+        {
+            auto next = scanner.update(now);
+            CHECK(next == now - 1 + OneWireScanner::scanInterval);
+            CHECK_FALSE(scanner.scanning());
+            CHECK(scanner.update(next) == next + 1);
+            CHECK(scanner.scanning());
+        }
+
+        THEN("A requested scan starts on the next update")
+        {
+            scanner.request();
+            CHECK(scanner.update(now) == now + 1);
+            CHECK(scanner.scanning());
+        }
+
+        THEN("A new device is listed as soon as it is found, before the scan completes")
+        {
+            driver.attach(sensor3);
+            scanner.request();
+            while (scanner.devices().size() == 2) {
+                scanner.update(now++);
+            }
+            CHECK(scanner.scanning());
+            CHECK(std::count(scanner.devices().begin(), scanner.devices().end(), sensor3->address()) == 1);
+
+            runScan();
+            CHECK(scanner.devices().size() == 3);
+        }
+
+        THEN("A removed device is dropped when the scan completes")
+        {
+            driver.detach(sensor2->address());
+            scanner.request();
+            runScan();
+            CHECK(scanner.devices() == std::vector<OneWireAddress>{sensor1->address()});
+        }
+    }
+
+    WHEN("Device objects are created, their addresses are known on the bus")
+    {
+        CHECK_FALSE(ow.hasDevice(switch2413->address()));
+        {
+            DS2413 ds(ow, switch2413->address());
+            CHECK(ow.hasDevice(switch2413->address()));
+
+            ds.setDeviceAddress(makeAddress(DS2413_FAMILY_ID, 8));
+            CHECK_FALSE(ow.hasDevice(switch2413->address()));
+            CHECK(ow.hasDevice(makeAddress(DS2413_FAMILY_ID, 8)));
+
+            DS2413 other(ow, makeAddress(DS2413_FAMILY_ID, 8));
+            CHECK(ow.hasDevice(makeAddress(DS2413_FAMILY_ID, 8)));
+        }
+        CHECK_FALSE(ow.hasDevice(makeAddress(DS2413_FAMILY_ID, 8)));
+    }
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "DS2408.h"
+#include "DS2413.h"
+#include "DallasTemperature.h"
+#include "OneWire.h"
+#include "OneWireSimulatedAddress.h"
+#include "OneWireSimulator.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+SCENARIO("Simulated OneWire bus with device models", "[onewire]")
+{
+    OneWireSimulator driver;
+    OneWire ow(driver);
+
+    auto sensor1 = std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 1));
+    auto sensor2 = std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 2));
+    auto sensor3 = std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, 0x81));
+    auto switch2413 = std::make_shared<OneWireSimulatedDS2413>(makeAddress(DS2413_FAMILY_ID, 7));
+    auto switch2408 = std::make_shared<OneWireSimulatedDS2408>(makeAddress(DS2408_FAMILY_ID, 9));
+
+    std::vector<std::shared_ptr<OneWireSimulatedDevice>> devices{sensor1, sensor2, sensor3, switch2413, switch2408};
+    for (auto& d : devices) {
+        driver.attach(d);
+    }
+
+    WHEN("The bus is searched, every device is found once")
+    {
+        std::vector<OneWireAddress> found;
+        OneWireAddress address;
+        ow.reset_search();
+        while (ow.search(address.asUint8ptr())) {
+            CHECK(OneWire::crc8(address.asUint8ptr(), 7) == address.asUint8ptr()[7]);
+            found.push_back(address);
+        }
+
+        CHECK(found.size() == devices.size());
+        for (auto& d : devices) {
+            CHECK(std::count(found.begin(), found.end(), d->address()) == 1);
+        }
+        CHECK(driver.stats().resets == devices.size());
+        CHECK(driver.stats().bitsRead == 2 * 64 * devices.size());
+    }
+
+    WHEN("A bus without devices is searched, nothing is found")
+    {
+        for (auto& d : devices) {
+            driver.detach(d->address());
+        }
+        OneWireAddress address;
+        ow.reset_search();
+        CHECK_FALSE(ow.search(address.asUint8ptr()));
+    }
+
+    WHEN("The bus has realistic timing, a search takes the time of all its bits")
+    {
+        driver.timing(OneWireSimulator::ds2482Timing);
+        OneWireAddress address;
+        ow.reset_search();
+        CHECK(ow.search(address.asUint8ptr()));
+        CHECK(driver.micros() >= OneWireSimulator::ds2482Timing.reset + 64 * 3 * OneWireSimulator::ds2482Timing.bit);
+    }
+
+    WHEN("A single device is on the bus, it answers Read ROM with its address")
+    {
+        for (auto& d : devices) {
+            if (d != switch2413) {
+                driver.detach(d->address());
+            }
+        }
+        OneWireAddress address;
+        CHECK(ow.reset());
+        ow.write(0x33);
+        ow.read_bytes(address.asUint8ptr(), 8);
+        CHECK(address == switch2413->address());
+    }
+
+    WHEN("A DS18B20 is read with DallasTemperature")
+    {
+        DallasTemperature dallas(&ow);
+        sensor2->temperatureRaw(16 * 21);
+        CHECK(dallas.initConnection(sensor2->address().asUint8ptr()));
+        dallas.requestTemperaturesByAddress(sensor2->address().asUint8ptr());
+        CHECK(dallas.getTempRaw(sensor2->address().asUint8ptr()) == 16 * 21);
+
+        THEN("A corrupted byte is detected by the CRC")
+        {
+            driver.errors(OneWireSimulator::Errors{3, 0});
+            uint8_t scratchPad[9];
+            CHECK_FALSE(dallas.readScratchPadCRC(sensor2->address().asUint8ptr(), scratchPad));
+            CHECK(driver.stats().corruptedReads > 0);
+        }
+
+        THEN("A missing presence pulse is detected")
+        {
+            driver.errors(OneWireSimulator::Errors{0, 1});
+            CHECK_FALSE(ow.reset());
+            uint8_t scratchPad[9];
+            CHECK_FALSE(dallas.readScratchPadCRC(sensor2->address().asUint8ptr(), scratchPad));
+            CHECK(driver.stats().missedPresences >= 1);
+        }
+    }
+
+    WHEN("A DS2413 is used through its IoArray interface")
+    {
+        DS2413 ds(ow, switch2413->address());
+        CHECK(ds.update());
+        CHECK(ds.connected());
+
+        THEN("Enabling a channel enables the latch of its PIO")
+        {
+            CHECK(ds.writeChannelConfig(1, IoArray::ChannelConfig::ACTIVE_HIGH));
+            CHECK(switch2413->latchEnabled(0));
+            CHECK_FALSE(switch2413->latchEnabled(1));
+
+            IoArray::State state;
+            CHECK(ds.senseChannel(1, state));
+            CHECK(state == IoArray::State::Active);
+        }
+
+        THEN("An input that is pulled down externally is sensed as active")
+        {
+            switch2413->externalPullDown(1, true);
+            ds.update();
+            IoArray::State state;
+            CHECK(ds.senseChannel(2, state));
+            CHECK(state == IoArray::State::Active);
+            CHECK(ds.senseChannel(1, state));
+            CHECK(state == IoArray::State::Inactive);
+        }
+
+        THEN("A corrupted status byte disconnects the device")
+        {
+            driver.errors(OneWireSimulator::Errors{1, 0});
+            CHECK_FALSE(ds.update());
+            CHECK_FALSE(ds.connected());
+        }
+
+        THEN("Polled on demand, sensing or writing a channel demands the next poll")
+        {
+            ds.polling().interval(1000);
+            ds.polling().mode(OneWirePolling::Mode::OnDemand);
+            ds.polling().polled(0, true, 0);
+            CHECK(ds.polling().next() == OneWirePolling::idleInterval);
+
+            IoArray::State state;
+            ds.senseChannel(1, state);
+            CHECK(ds.polling().next() == 1000);
+
+            ds.polling().polled(1000, true, 0);
+            ds.writeChannelConfig(2, IoArray::ChannelConfig::ACTIVE_HIGH);
+            CHECK(ds.polling().next() == 2000);
+        }
+    }
+
+    WHEN("A DS2408 is used through its IoArray interface")
+    {
+        DS2408 ds(ow, switch2408->address());
+        CHECK(switch2408->writes() == 1); // constructor disables all latches
+        ds.update();
+        CHECK(ds.connected());
+
+        THEN("Enabling a channel enables the latch of its PIO")
+        {
+            CHECK(ds.writeChannelConfig(3, IoArray::ChannelConfig::ACTIVE_HIGH));
+            CHECK(switch2408->latches() == uint8_t(~0x04));
+
+            ds.update();
+            IoArray::State state;
+            CHECK(ds.senseChannel(3, state));
+            CHECK(state == IoArray::State::Active);
+        }
+
+        THEN("An input that is pulled down externally is sensed as active")
+        {
+            switch2408->externalPullDown(5, true);
+            ds.update();
+            IoArray::State state;
+            CHECK(ds.senseChannel(6, state));
+            CHECK(state == IoArray::State::Active);
+            CHECK(ds.senseChannel(5, state));
+            CHECK(state == IoArray::State::Inactive);
+        }
+
+        THEN("A corrupted register read fails the CRC16 and disconnects the device")
+        {
+            driver.errors(OneWireSimulator::Errors{4, 0});
+            ds.update();
+            CHECK_FALSE(ds.connected());
+        }
+
+        THEN("Polled on demand, sensing or writing a channel demands the next poll")
+        {
+            ds.polling().interval(1000);
+            ds.polling().mode(OneWirePolling::Mode::OnDemand);
+            ds.polling().polled(0, true, 0);
+            CHECK(ds.polling().next() == OneWirePolling::idleInterval);
+
+            IoArray::State state;
+            ds.senseChannel(6, state);
+            CHECK(ds.polling().next() == 1000);
+
+            ds.polling().polled(1000, true, 0);
+            ds.writeChannelConfig(3, IoArray::ChannelConfig::ACTIVE_HIGH);
+            CHECK(ds.polling().next() == 2000);
+        }
+    }
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "DallasTemperature.h"
+#include "OneWire.h"
+#include "OneWireSimulatedAddress.h"
+#include "OneWireSimulator.h"
+#include "OneWireTransactions.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+OneWireTransaction
+readScratchPad(const OneWireAddress& address, const void* owner, OneWireTransaction::Completion onDone)
+{
+    return OneWireTransaction(address, {READSCRATCH}, 9, owner, std::move(onDone));
+}
+
+bool
+validScratchPad(const OneWireTransaction& t)
+{
+    return t.success && OneWire::crc8(t.result(), 8) == t.result()[SCRATCHPAD_CRC];
+}
+
+} // end anonymous namespace
+
+SCENARIO("Queued OneWire transactions", "[onewire]")
+{
+    constexpr uint8_t numSensors = 20;
+
+    OneWireSimulator driver;
+    OneWire ow(driver);
+    OneWireTransactions transactions(ow, [&driver]() { return driver.micros(); });
+
+    std::vector<std::shared_ptr<OneWireSimulatedDS18B20>> devices;
+    for (uint8_t i = 0; i < numSensors; i++) {
+        devices.push_back(std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, i + 1)));
+        devices.back()->temperatureRaw(16 * (20 + i));
+        driver.attach(devices.back());
+    }
+
+    // convert, so the scratchpads contain the temperature
+    ow.reset();
+    ow.skip();
+    ow.write(STARTCONVO);
+
+    WHEN("Transactions are submitted, they complete in order with the bytes read")
+    {
+        std::vector<uint8_t> completed;
+        for (uint8_t i = 0; i < 3; i++) {
+            transactions.submit(readScratchPad(makeAddress(0x28, i + 1), nullptr, [&completed, i](const OneWireTransaction& t) {
+                CHECK(validScratchPad(t));
+                CHECK(int16_t(t.result()[TEMP_LSB] | t.result()[TEMP_MSB] << 8) == 16 * (20 + i));
+                completed.push_back(i);
+            }));
+        }
+        CHECK(transactions.pending() == 3);
+        CHECK(transactions.process(1000000));
+        CHECK(completed == std::vector<uint8_t>{0, 1, 2});
+        CHECK(transactions.stats().completed == 3);
+    }
+
+    WHEN("A transaction is for a device that is not on the bus, the bytes read are all ones")
+    {
+        bool done = false;
+        transactions.submit(readScratchPad(makeAddress(0x28, 100), nullptr, [&done](const OneWireTransaction& t) {
+            CHECK(t.success);
+            CHECK_FALSE(validScratchPad(t));
+            CHECK(t.result()[0] == 0xFF);
+            done = true;
+        }));
+        transactions.process(1000000);
+        CHECK(done);
+    }
+
+    WHEN("No device answers the reset, the transaction fails")
+    {
+        for (uint8_t i = 0; i < numSensors; i++) {
+            driver.detach(makeAddress(0x28, i + 1));
+        }
+        bool done = false;
+        transactions.submit(readScratchPad(makeAddress(0x28, 1), nullptr, [&done](const OneWireTransaction& t) {
+            CHECK_FALSE(t.success);
+            done = true;
+        }));
+        transactions.process(1000000);
+        CHECK(done);
+        CHECK(transactions.stats().failed == 1);
+    }
+
+    WHEN("The bus master hangs with its busy bit set")
+    {
+        driver.timing(OneWireSimulator::ds2482Timing);
+        std::vector<bool> results;
+        for (uint8_t i = 0; i < 3; i++) {
+            transactions.submit(readScratchPad(makeAddress(0x28, i + 1), nullptr, [&results](const OneWireTransaction& t) {
+                results.push_back(t.success);
+            }));
+        }
+        transactions.process(100); // start the first transaction
+        driver.fault(OneWireSimulator::Fault::StuckBusy);
+
+        THEN("The passes do not wait for it, the first pass after the timeout fails the transaction in progress")
+        {
+            uint32_t passes = 0;
+            while (transactions.stats().driverFaults == 0) {
+                auto start = driver.micros();
+                CHECK_FALSE(transactions.process(1000000));
+                CHECK(driver.micros() - start < 200);
+                driver.advance(1000); // rest of the main loop
+                ++passes;
+                REQUIRE(passes < 100);
+            }
+            CHECK(passes > OneWireTransactions::busyTimeout / 1000);
+            CHECK(results == std::vector<bool>{false});
+            CHECK(transactions.pending() == 2);
+        }
+
+        THEN("Synchronous use of the bus does not wait forever for the transaction in progress")
+        {
+            ow.reset();
+            CHECK(results == std::vector<bool>{false});
+            CHECK(transactions.stats().driverFaults == 1);
+        }
+    }
+
+    WHEN("The bus master does not respond, the transactions fail without waiting for it")
+    {
+        driver.timing(OneWireSimulator::ds2482Timing);
+        driver.fault(OneWireSimulator::Fault::NoResponse);
+        uint32_t failed = 0;
+        for (uint8_t i = 0; i < 3; i++) {
+            transactions.submit(readScratchPad(makeAddress(0x28, i + 1), nullptr, [&failed](const OneWireTransaction& t) {
+                CHECK_FALSE(t.success);
+                ++failed;
+            }));
+        }
+        for (uint8_t pass = 0; pass < 3; pass++) {
+            auto start = driver.micros();
+            transactions.process(2000);
+            CHECK(driver.micros() - start < 200);
+        }
+        CHECK(failed == 3);
+        CHECK(transactions.stats().driverFaults == 3);
+    }
+
+    WHEN("The bus has realistic timing")
+    {
+        driver.timing(OneWireSimulator::ds2482Timing);
+        driver.resetStats();
+
+        uint32_t done = 0;
+        for (uint8_t i = 0; i < numSensors; i++) {
+            transactions.submit(readScratchPad(makeAddress(0x28, i + 1), nullptr, [&done](const OneWireTransaction& t) {
+                CHECK(validScratchPad(t));
+                ++done;
+            }));
+        }
+
+        THEN("Each pass returns when the bus master is busy and never waits for the bus")
+        {
+            constexpr duration_micros_t budget = 1000;
+            constexpr duration_micros_t step = 2 * OneWireSimulator::ds2482Timing.command; // poll + command
+            uint32_t passes = 0;
+            while (!transactions.process(budget)) {
+                driver.advance(5000); // rest of the main loop
+                ++passes;
+                REQUIRE(passes < 10000);
+            }
+            CHECK(done == numSensors);
+            // the steps without a bus operation run in the same pass as the next one, then the busy driver is polled once
+            CHECK(transactions.stats().maxPass <= 3 * step);
+            CHECK(driver.stats().waited == 0);
+            CHECK(driver.stats().resets == numSensors);
+        }
+
+        THEN("Reading the same scratchpads synchronously blocks the loop for all of the bus time")
+        {
+            DallasTemperature dallas(&ow);
+            auto start = driver.micros();
+            uint8_t scratchPad[9];
+            for (uint8_t i = 0; i < numSensors; i++) {
+                dallas.readScratchPad(makeAddress(0x28, i + 1).asUint8ptr(), scratchPad);
+            }
+            auto blocked = driver.micros() - start;
+            CHECK(blocked > numSensors * 18 * OneWireSimulator::ds2482Timing.byte);
+            CHECK(driver.stats().waited > 0);
+
+            while (!transactions.process(1000)) {
+                driver.advance(5000);
+            }
+            CHECK(transactions.stats().maxPass < blocked / 10);
+        }
+
+        THEN("A client that keeps resubmitting does not starve other clients")
+        {
+            uint32_t greedyDone = 0;
+            ticks_micros_t greedyCompletions[2] = {0, 0};
+            std::function<void(const OneWireTransaction&)> resubmit = [&](const OneWireTransaction&) {
+                greedyCompletions[greedyDone++ % 2] = driver.micros();
+                transactions.submit(readScratchPad(makeAddress(0x28, 1), &greedyDone, resubmit));
+            };
+            transactions.submit(readScratchPad(makeAddress(0x28, 1), &greedyDone, resubmit));
+
+            // process the initial queue and let the greedy client run for a while
+            for (int pass = 0; pass < 1000; pass++) {
+                transactions.process(1000);
+                driver.advance(5000); // rest of the main loop
+            }
+            CHECK(done == numSensors);
+            REQUIRE(greedyDone > 2);
+            auto transactionTime = std::max(greedyCompletions[0], greedyCompletions[1]) - std::min(greedyCompletions[0], greedyCompletions[1]);
+
+            auto submitted = driver.micros();
+            ticks_micros_t completedAt = 0;
+            transactions.submit(readScratchPad(makeAddress(0x28, 2), nullptr, [&](const OneWireTransaction& t) {
+                CHECK(validScratchPad(t));
+                completedAt = driver.micros();
+            }));
+            for (int pass = 0; pass < 1000 && completedAt == 0; pass++) {
+                transactions.process(1000);
+                driver.advance(5000);
+            }
+            REQUIRE(completedAt != 0);
+            // waits for at most the greedy transaction in progress
+            CHECK(completedAt - submitted <= 2 * transactionTime);
+
+            transactions.cancel(&greedyDone);
+            CHECK(transactions.pending() == 0);
+        }
+
+        THEN("Synchronous access first finishes the transaction in progress")
+        {
+            bool firstDone = false;
+            transactions.cancel(nullptr);
+            transactions.submit(readScratchPad(makeAddress(0x28, 1), nullptr, [&firstDone](const OneWireTransaction& t) {
+                CHECK(validScratchPad(t));
+                firstDone = true;
+            }));
+            transactions.process(3000); // partly done
+            REQUIRE_FALSE(firstDone);
+
+            DallasTemperature dallas(&ow);
+            uint8_t scratchPad[9];
+            CHECK(dallas.readScratchPadCRC(makeAddress(0x28, 2).asUint8ptr(), scratchPad));
+            CHECK(firstDone);
+            CHECK(int16_t(scratchPad[TEMP_LSB] | scratchPad[TEMP_MSB] << 8) == 16 * 21);
+        }
+
+        THEN("A cancelled transaction in progress is dropped without calling its completion")
+        {
+            transactions.cancel(nullptr);
+            int owner = 0;
+            bool called = false;
+            transactions.submit(readScratchPad(makeAddress(0x28, 1), &owner, [&called](const OneWireTransaction&) {
+                called = true;
+            }));
+            transactions.process(3000);
+            transactions.cancel(&owner);
+            CHECK(transactions.pending() == 0);
+
+            bool nextDone = false;
+            transactions.submit(readScratchPad(makeAddress(0x28, 2), nullptr, [&nextDone](const OneWireTransaction& t) {
+                CHECK(validScratchPad(t));
+                nextDone = true;
+            }));
+            while (!transactions.process(1000)) {
+                driver.advance(5000);
+            }
+            CHECK(nextDone);
+            CHECK_FALSE(called);
+        }
+    }
+}
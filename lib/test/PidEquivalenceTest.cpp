@@ -0,0 +1,409 @@
+/*
+ * Copyright 2019 BrewPi B.V./Elco Jacobs.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "ActuatorAnalogMock.h"
+#include "Pid.h"
+#include "SetpointSensorPair.h"
+#include "TempSensorMock.h"
+#include "future_std.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+
+/*
+ * The original PID implementation with cnl arithmetic.
+ * Pid::update() uses integer arithmetic and must give the exact same results.
+ */
+class ReferencePid {
+public:
+    using in_t = Pid::in_t;
+    using out_t = Pid::out_t;
+    using integral_t = Pid::integral_t;
+    using derivative_t = Pid::derivative_t;
+
+private:
+    const std::function<std::shared_ptr<SetpointSensorPair>()> m_inputPtr;
+    const std::function<std::shared_ptr<ProcessValue<out_t>>()> m_outputPtr;
+
+    in_t m_error = in_t{0};
+    out_t m_p = out_t{0};
+    out_t m_i = out_t{0};
+    out_t m_d = out_t{0};
+    integral_t m_integral = integral_t{0};
+    derivative_t m_derivative = derivative_t{0};
+
+    in_t m_kp = in_t{0};
+    uint16_t m_ti = 0;
+    uint16_t m_td = 0;
+    bool m_enabled = false;
+    bool m_active = false;
+
+    in_t m_boilPointAdjust = in_t{0};
+    out_t m_boilMinOutput = out_t{0};
+    bool m_boilModeActive = false;
+
+public:
+    ReferencePid(
+        std::function<std::shared_ptr<SetpointSensorPair>()>&& input,
+        std::function<std::shared_ptr<ProcessValue<out_t>>()>&& output)
+        : m_inputPtr(input)
+        , m_outputPtr(output)
+    {
+    }
+
+    void update();
+    void kp(const in_t& arg);
+    void ti(const uint16_t& arg);
+    void setIntegral(const out_t& newIntegratorPart);
+
+    void td(const uint16_t& arg)
+    {
+        m_td = arg;
+    }
+
+    void enabled(bool state)
+    {
+        active(state);
+        m_enabled = state;
+    }
+
+    bool active() const
+    {
+        return m_active;
+    }
+
+    void boilPointAdjust(const in_t& v)
+    {
+        m_boilPointAdjust = v;
+    }
+
+    void boilMinOutput(const out_t& v)
+    {
+        m_boilMinOutput = v;
+    }
+
+    auto error() const { return m_error; }
+    auto integral() const { return m_integral; }
+    auto p() const { return m_p; }
+    auto i() const { return m_i; }
+    auto d() const { return m_d; }
+    auto boilModeActive() const { return m_boilModeActive; }
+
+private:
+    void active(bool state)
+    {
+        if (m_enabled && m_active && !state) {
+            if (auto ptr = m_outputPtr()) {
+                ptr->setting(0);
+                ptr->settingValid(false);
+            }
+        }
+        m_active = state;
+    }
+};
+
+void
+ReferencePid::update()
+{
+    auto input = m_inputPtr();
+    auto setpoint = in_t{0};
+    if (input && input->settingValid() && input->valueValid()) {
+        if (m_enabled) {
+            active(true);
+        }
+        setpoint = input->setting();
+        m_boilModeActive = setpoint >= in_t{100} + m_boilPointAdjust;
+        m_error = input->error();
+        m_derivative = m_td ? input->derivative(m_td / 2) : 0;
+        m_integral = (m_ti != 0 && !m_boilModeActive) ? integral_t(m_integral + m_error) : integral_t(0);
+    } else {
+        if (active()) {
+            active(false);
+        }
+        m_integral = 0;
+    }
+    if (!active()) {
+        return;
+    }
+
+    // calculate PID parts.
+
+    m_p = m_kp * m_error;
+
+    if (m_ti != 0) {
+        m_i = m_integral * safe_elastic_fixed_point<4, 27>(cnl::quotient(m_kp, m_ti));
+    }
+
+    m_d = -m_kp * fp12_t(m_derivative * m_td);
+
+    auto pidResult = m_p + m_i + m_d;
+
+    out_t outputValue = pidResult;
+
+    if (m_boilModeActive) {
+        outputValue = std::max(outputValue, m_boilMinOutput);
+    }
+
+    // try to set the output to the desired setting
+    if (m_enabled) {
+
+        if (auto output = m_outputPtr()) {
+            output->settingValid(true);
+            output->setting(outputValue);
+
+            if (m_boilModeActive) {
+                return;
+            }
+
+            // get the clipped setting from the actuator for anti-windup
+            if (output->settingValid()) {
+                auto outputSetting = output->setting();
+
+                if (m_ti != 0) { // 0 has been chosen to indicate that the integrator is disabled. This also prevents divide by zero.
+                                 // update integral with anti-windup back calculation
+                                 // pidResult - output is zero when actuator is not saturated
+
+                    auto antiWindup = integral_t{0};
+                    if (m_kp != 0) { // prevent divide by zero
+                        if (pidResult != outputSetting) {
+                            // clipped to actuator min or max set in target actuator
+                            // calculate anti-windup from setting instead of actual value, so it doesn't dip under the maximum
+                            // make sure anti-windup is at least m_error when clipping to prevent further windup, with extra anti-windup to scale back integral
+                            out_t excess = cnl::quotient(pidResult - outputSetting, m_kp);
+                            out_t correction = int8_t{3} * excess; // anti windup gain is 3
+                            antiWindup = m_error + correction;
+                        } else {
+                            // Actuator could be not reaching set value due to physics or limits in its target actuator
+                            // Get the actual achieved value in actuator. This could differ due to slowness time/mutex limits
+                            if (output->valueValid()) {
+                                auto achievedValue = output->value();
+
+                                // Anti windup gain is 3
+                                out_t excess = cnl::quotient(pidResult - achievedValue, m_kp);
+                                antiWindup = int8_t(3) * excess; // anti windup gain is 3
+
+                                // Disable anti-windup if integral part dominates. But only if it counteracts p.
+                                decltype(m_i) mi_limit = int8_t{3} * m_p;
+                                if (m_p < 0 && m_i < 0 && m_i < mi_limit) {
+                                    antiWindup = integral_t{0};
+                                }
+                                if (m_p > 0 && m_i > 0 && m_i > mi_limit) {
+                                    antiWindup = integral_t{0};
+                                }
+                            }
+                        }
+                    }
+
+                    // make sure integral does not cross zero and does not increase by anti-windup
+                    integral_t newIntegral = m_integral - antiWindup;
+                    if (m_integral >= integral_t{0}) {
+                        m_integral = std::clamp(newIntegral, integral_t{0}, m_integral);
+                    } else {
+                        m_integral = std::clamp(newIntegral, m_integral, integral_t{0});
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+ReferencePid::kp(const in_t& arg)
+{
+    if (arg != 0) {
+        // scale integral history so integral action doesn't change
+        m_integral = m_integral * safe_elastic_fixed_point<15, 15>(cnl::quotient(m_kp, arg));
+    }
+    m_kp = arg;
+}
+
+void
+ReferencePid::ti(const uint16_t& arg)
+{
+    if (m_ti != 0) {
+        // scale integral history so integral action doesn't change
+        m_integral = cnl::wrap<integral_t>((int64_t(cnl::unwrap(m_integral)) * arg) / m_ti);
+    }
+    m_ti = arg;
+}
+
+void
+ReferencePid::setIntegral(const out_t& newIntegratorPart)
+{
+    if (m_kp == 0) {
+        return;
+    }
+    m_integral = m_ti * safe_elastic_fixed_point<14, 16>(cnl::quotient(newIntegratorPart, m_kp));
+}
+
+/*
+ * A PID with its own sensor, input pair and actuator, so two implementations can be driven with the same inputs
+ */
+template <class P>
+struct PidFixture {
+    std::shared_ptr<TempSensorMock> sensor = std::make_shared<TempSensorMock>(20.0);
+    std::shared_ptr<SetpointSensorPair> input = std::make_shared<SetpointSensorPair>([this]() { return sensor; });
+    std::shared_ptr<ActuatorAnalogMock> actuator = std::make_shared<ActuatorAnalogMock>();
+    P pid = P([this]() { return input; }, [this]() { return actuator; });
+
+    PidFixture()
+    {
+        input->setting(20);
+        input->settingValid(true);
+        pid.enabled(true);
+    }
+};
+
+template <class T>
+auto
+raw(const T& v)
+{
+    return int64_t(cnl::unwrap(v));
+}
+
+} // end anonymous namespace
+
+SCENARIO("The integer PID implementation gives the same results as the cnl reference implementation", "[pid]")
+{
+    std::mt19937 gen(1234);
+    auto randomFp = [&gen](double lo, double hi) {
+        return cnl::wrap<fp12_t>(std::uniform_int_distribution<int32_t>(int32_t(lo * 4096), int32_t(hi * 4096))(gen));
+    };
+    auto randomInt = [&gen](int32_t lo, int32_t hi) {
+        return std::uniform_int_distribution<int32_t>(lo, hi)(gen);
+    };
+
+    for (int run = 0; run < 100; ++run) {
+        PidFixture<ReferencePid> ref;
+        PidFixture<Pid> fast;
+        fp12_t value = 20;
+
+        auto forBoth = [&ref, &fast](auto&& f) {
+            f(ref);
+            f(fast);
+        };
+
+        for (int step = 0; step < 2000; ++step) {
+            // randomly change settings and conditions, then update both
+            if (randomInt(0, 200) == 0 || step == 0) {
+                auto kp = randomFp(-200, 200);
+                forBoth([&kp](auto& fix) { fix.pid.kp(kp); });
+            }
+            if (randomInt(0, 200) == 0 || step == 0) {
+                auto ti = uint16_t(randomInt(0, 4) ? randomInt(1, 7200) : 0);
+                forBoth([&ti](auto& fix) { fix.pid.ti(ti); });
+            }
+            if (randomInt(0, 200) == 0 || step == 0) {
+                auto td = uint16_t(randomInt(0, 4) ? randomInt(1, 1200) : 0);
+                forBoth([&td](auto& fix) { fix.pid.td(td); });
+            }
+            if (randomInt(0, 100) == 0) {
+                auto setting = randomFp(0, 110);
+                forBoth([&setting](auto& fix) { fix.input->setting(setting); });
+            }
+            if (randomInt(0, 200) == 0) {
+                auto adjust = randomFp(-5, 5);
+                auto minOutput = randomFp(0, 100);
+                forBoth([&adjust, &minOutput](auto& fix) {
+                    fix.pid.boilPointAdjust(adjust);
+                    fix.pid.boilMinOutput(minOutput);
+                });
+            }
+            if (randomInt(0, 100) == 0) {
+                auto minSetting = randomFp(-100, 0);
+                auto maxSetting = randomFp(0, 100);
+                auto maxValue = randomFp(0, 100);
+                forBoth([&](auto& fix) {
+                    fix.actuator->minSetting(minSetting);
+                    fix.actuator->maxSetting(maxSetting);
+                    fix.actuator->maxValue(maxValue);
+                });
+            }
+            if (randomInt(0, 500) == 0) {
+                auto integratorPart = randomFp(-100, 100);
+                forBoth([&integratorPart](auto& fix) { fix.pid.setIntegral(integratorPart); });
+            }
+            if (randomInt(0, 300) == 0) {
+                bool connected = randomInt(0, 1);
+                forBoth([&connected](auto& fix) { fix.sensor->connected(connected); });
+            }
+
+            // random walk of the sensor value, with occasional steps
+            value = randomInt(0, 500) == 0 ? randomFp(0, 105) : fp12_t(value + randomFp(-0.5, 0.5));
+            value = std::clamp(value, fp12_t{-10}, fp12_t{120});
+
+            forBoth([&value](auto& fix) {
+                fix.sensor->setting(value);
+                fix.input->update();
+                fix.pid.update();
+            });
+
+            INFO("run " << run << ", step " << step);
+            REQUIRE(raw(fast.pid.error()) == raw(ref.pid.error()));
+            REQUIRE(raw(fast.pid.p()) == raw(ref.pid.p()));
+            REQUIRE(raw(fast.pid.i()) == raw(ref.pid.i()));
+            REQUIRE(raw(fast.pid.d()) == raw(ref.pid.d()));
+            REQUIRE(raw(fast.pid.integral()) == raw(ref.pid.integral()));
+            REQUIRE(raw(fast.actuator->setting()) == raw(ref.actuator->setting()));
+            REQUIRE(fast.actuator->settingValid() == ref.actuator->settingValid());
+            REQUIRE(fast.pid.active() == ref.pid.active());
+            REQUIRE(fast.pid.boilModeActive() == ref.pid.boilModeActive());
+        }
+    }
+}
+
+SCENARIO("Benchmark PID update", "[pid][.benchmark]")
+{
+    constexpr int iterations = 100000;
+
+    auto timeUpdates = [](auto& fix) {
+        fix.pid.kp(10);
+        fix.pid.ti(2000);
+        fix.pid.td(200);
+        fix.input->setting(21);
+        fix.actuator->maxSetting(50); // saturate the output to include anti-windup
+
+        for (int i = 0; i < 100; ++i) {
+            fix.sensor->setting(fp12_t(20) - fp12_t(0.01) * i);
+            fix.input->update();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            fix.pid.update();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    };
+
+    PidFixture<ReferencePid> ref;
+    PidFixture<Pid> fast;
+
+    auto refTime = timeUpdates(ref);
+    auto fastTime = timeUpdates(fast);
+
+    std::cout << "Pid::update (cnl reference): " << refTime << " ns per update" << std::endl;
+    std::cout << "Pid::update (integer): " << fastTime << " ns per update" << std::endl;
+
+    CHECK(raw(fast.actuator->setting()) == raw(ref.actuator->setting()));
+}
@@ -23,7 +23,56 @@
 #include "../inc/SetpointSensorPair.h"
 #include "../inc/TempSensorMock.h"
 #include "../inc/Temperature.h"
+#include <chrono>
 #include <cstdint>
+#include <iostream>
+#include <random>
+
+namespace {
+
+// the interpolation before slopes were precomputed: a binary search and a division on every update
+bool
+referenceSetting(const std::vector<SetpointProfile::Point>& points, utc_seconds_t start, utc_seconds_t time, temp_t& result)
+{
+    struct TimeStampLessEqual {
+        bool operator()(const SetpointProfile::Point& p, const utc_seconds_t& time) const { return p.time <= time; }
+        bool operator()(const utc_seconds_t& time, const SetpointProfile::Point& p) const { return time <= p.time; }
+    };
+
+    if (points.empty() || time == 0 || start > time) {
+        return false;
+    }
+    auto elapsed = time - start;
+    auto upper = std::lower_bound(points.cbegin(), points.cend(), elapsed, TimeStampLessEqual{});
+    if (upper == points.cend()) {
+        result = points.back().temp;
+        return true;
+    }
+    if (upper == points.cbegin()) {
+        return false;
+    }
+    auto lower = upper - 1;
+    auto fraction = safe_elastic_fixed_point<1, 30>(cnl::quotient(elapsed - lower->time, upper->time - lower->time));
+    result = lower->temp + temp_t((upper->temp - lower->temp) * fraction);
+    return true;
+}
+
+// a profile like the ones generated from recipes: ramps and holds, with a step now and then
+std::vector<SetpointProfile::Point>
+makeProfile(size_t numPoints, std::mt19937& rng)
+{
+    std::vector<SetpointProfile::Point> points;
+    utc_seconds_t t = 0;
+    for (size_t i = 0; i < numPoints; i++) {
+        points.push_back({t, temp_t(double(rng() % 8000) / 100)});
+        if (rng() % 10 != 0) {
+            t += 60 + rng() % 86400;
+        }
+    }
+    return points;
+}
+
+} // end anonymous namespace
 
 SCENARIO("SetpointProfile test", "[SetpointProfile]")
 {
@@ -225,4 +274,94 @@ SCENARIO("SetpointProfile test", "[SetpointProfile]")
 
         CHECK(profile.isDriving() == true);
     }
+
+    WHEN("The time moves back, because the start time is changed")
+    {
+        profile.startTime(10);
+        profile.addPoint(SetpointProfile::Point{utc_seconds_t(1), temp_t(10)});
+        profile.addPoint(SetpointProfile::Point{utc_seconds_t(11), temp_t(20)});
+        profile.addPoint(SetpointProfile::Point{utc_seconds_t(21), temp_t(40)});
+
+        profile.update(32);
+        CHECK(sspair->setting() == Approx(40).margin(0.001));
+
+        profile.startTime(20);
+        profile.update(22);
+        CHECK(sspair->setting() == Approx(11).margin(0.001));
+
+        profile.update(5);
+        CHECK(sspair->setting() == Approx(11).margin(0.001));
+    }
+}
+
+SCENARIO("SetpointProfile with many points follows the interpolation with a binary search", "[SetpointProfile]")
+{
+    auto sensor = std::make_shared<TempSensorMock>(20.0);
+    auto sspair = std::make_shared<SetpointSensorPair>([sensor]() { return sensor; });
+    sspair->setting(99);
+    sspair->settingValid(true);
+    auto profile = SetpointProfile([sspair]() { return sspair; });
+
+    std::mt19937 rng(42);
+    auto points = makeProfile(500, rng);
+    const utc_seconds_t start = 1000;
+    profile.startTime(start);
+    profile.points(std::vector<SetpointProfile::Point>(points));
+
+    auto end = start + points.back().time + 1000;
+    utc_seconds_t time = 1;
+    while (time < end) {
+        profile.update(time);
+        temp_t expected = 0;
+        if (referenceSetting(points, start, time, expected)) {
+            // the reference truncates the fraction and the product, both can be 1 bit off
+            REQUIRE(sspair->setting() == Approx(double(expected)).margin(2.0 / 4096));
+        }
+        time += 1 + rng() % 7200;
+        if (rng() % 100 == 0) {
+            time -= std::min(time - 1, utc_seconds_t(rng() % 100000)); // jump back now and then
+        }
+    }
+}
+
+SCENARIO("Benchmark SetpointProfile update", "[SetpointProfile][.benchmark]")
+{
+    auto sensor = std::make_shared<TempSensorMock>(20.0);
+    auto sspair = std::make_shared<SetpointSensorPair>([sensor]() { return sensor; });
+    std::mt19937 rng(1);
+
+    for (size_t numPoints : {2, 20, 500}) {
+        auto points = makeProfile(numPoints, rng);
+        auto profile = SetpointProfile([sspair]() { return sspair; });
+        profile.startTime(1);
+        profile.points(std::vector<SetpointProfile::Point>(points));
+
+        const utc_seconds_t duration = points.back().time + 1;
+        const uint32_t iterations = 1000000;
+        const utc_seconds_t step = std::max(duration / iterations, utc_seconds_t(1));
+
+        auto benchmark = [&](auto update) {
+            auto start = std::chrono::steady_clock::now();
+            utc_seconds_t time = 1;
+            for (uint32_t i = 0; i < iterations; i++) {
+                update(time);
+                time += step;
+            }
+            auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+        };
+
+        auto cursor = benchmark([&](utc_seconds_t time) { profile.update(time); });
+        auto reference = benchmark([&](utc_seconds_t time) {
+            temp_t setting;
+            if (referenceSetting(points, 1, time, setting)) {
+                sspair->setting(setting);
+                sspair->settingValid(true);
+            }
+        });
+
+        std::cout << "SetpointProfile with " << numPoints << " points: "
+                  << reference << " ns per update with a binary search, "
+                  << cursor << " ns with the segment cursor" << std::endl;
+    }
 }
@@ -19,7 +19,9 @@
 
 #include "../inc/SetpointSensorPair.h"
 #include "../inc/TempSensorMock.h"
+#include <algorithm>
 #include <catch.hpp>
+#include <cmath>
 #include <memory>
 
 SCENARIO("SetpointSensorPair test")
@@ -36,3 +38,95 @@ SCENARIO("SetpointSensorPair test")
         CHECK(pair.value() == 21.0);
     }
 }
+
+SCENARIO("SetpointSensorPair derivative sources", "[derivative]")
+{
+    auto sensor = std::make_shared<TempSensorMock>(20.0);
+    // fast fluctuations on top of a slow ramp
+    sensor->fluctuations({{temp_t{0.5}, 5000}, {temp_t{0.1}, 3000}});
+
+    auto pair = SetpointSensorPair([sensor]() { return sensor; });
+    CHECK(pair.derivativeSource() == SetpointSensorPair::DerivativeSource::FILTER);
+
+    pair.derivativeSource(SetpointSensorPair::DerivativeSource::LEAST_SQUARES);
+    CHECK(pair.derivativeSource() == SetpointSensorPair::DerivativeSource::LEAST_SQUARES);
+
+    const double slope = 0.01; // degrees per second
+    const uint32_t period = 60;
+    double maxError = 0;
+
+    ticks_millis_t now = 0;
+    for (uint32_t t = 0; t < 3000; ++t) {
+        sensor->setting(temp_t(20 + slope * t));
+        sensor->update(now);
+        pair.update();
+        auto derivative = pair.derivative(period);
+        if (t > 1000) {
+            maxError = std::max(maxError, std::abs(double(derivative) - slope));
+        }
+        now += 1000;
+    }
+
+    THEN("The least squares slope of the filtered values is close to the slope of the ramp")
+    {
+        CHECK(maxError < slope * 0.05);
+    }
+
+    AND_WHEN("The derivative source is set back to the filter")
+    {
+        pair.derivativeSource(SetpointSensorPair::DerivativeSource::FILTER);
+        CHECK(pair.derivativeSource() == SetpointSensorPair::DerivativeSource::FILTER);
+        CHECK(double(pair.derivative(period)) == Approx(slope).margin(slope * 0.5));
+    }
+}
+
+SCENARIO("SetpointSensorPairs share a filter bank that is stepped by its owner", "[filterbank]")
+{
+    auto bank = std::make_shared<FilterBank>();
+    auto sensor1 = std::make_shared<TempSensorMock>(21.0);
+    auto sensor2 = std::make_shared<TempSensorMock>(30.0);
+    auto pair1 = SetpointSensorPair([sensor1]() { return sensor1; }, bank);
+    auto pair2 = SetpointSensorPair([sensor2]() { return sensor2; }, bank);
+    bank->step();
+    CHECK(pair1.value() == 21.0);
+    CHECK(pair2.value() == 30.0);
+
+    uint32_t notifications = 0;
+    auto listener = std::make_shared<ChangeNotifier::Listener>([&notifications]() { ++notifications; });
+    pair1.changes().subscribe(listener);
+
+    WHEN("The pairs are updated, reading a new value steps the bank once for all pairs")
+    {
+        uint32_t steps = 0;
+        auto stepListener = std::make_shared<ChangeNotifier::Listener>([&steps]() { ++steps; });
+        bank->stepped().subscribe(stepListener);
+
+        sensor1->setting(22.0);
+        sensor2->setting(31.0);
+        pair1.update();
+        pair2.update();
+        CHECK(steps == 0);
+        CHECK(notifications == 0);
+
+        // a PID that is updated after the pair in the same pass reads the new value
+        CHECK(pair1.value() > 21.0);
+        CHECK(pair2.value() > 30.0);
+        CHECK(steps == 1);
+        CHECK(notifications == 1);
+
+        // the step of the owner at the end of the pass has nothing left to do
+        bank->step();
+        CHECK(steps == 1);
+    }
+
+    WHEN("A pair is moved, the new pair handles the steps of the bank")
+    {
+        auto moved = std::move(pair1);
+        moved.changes().subscribe(listener);
+        sensor1->setting(23.0);
+        moved.update();
+        bank->step();
+        CHECK(moved.value() > 21.0);
+        CHECK(notifications == 1);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "../inc/SlopeEstimator.h"
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <random>
+
+SCENARIO("Least squares slope estimation", "[slope]")
+{
+    WHEN("The period fits in the maximum window")
+    {
+        SlopeEstimator s(20);
+        CHECK(s.window() == 20);
+        CHECK(s.decimation() == 1);
+
+        THEN("The slope is 0 with less than 2 samples")
+        {
+            CHECK(s.slope(0) == 0);
+            s.add(100);
+            CHECK(s.slope(0) == 0);
+        }
+
+        THEN("The slope of a ramp is exact, also after the window is full")
+        {
+            for (int32_t i = 0; i < 100; i++) {
+                s.add(1000 - 3 * i);
+                if (i > 0) {
+                    CAPTURE(i);
+                    CHECK(s.slope(8) == -3 * 256);
+                }
+            }
+            CHECK(s.count() == 20);
+        }
+    }
+
+    WHEN("The period is longer than the maximum window")
+    {
+        SlopeEstimator s(10 * SlopeEstimator::maxWindow);
+        CHECK(s.decimation() == 10);
+        CHECK(s.window() == SlopeEstimator::maxWindow);
+
+        THEN("The slope is per input sample")
+        {
+            for (int32_t i = 0; i < 1000; i++) {
+                s.add(7 * i);
+            }
+            CHECK(s.slope(4) == 7 * 16);
+        }
+    }
+
+    WHEN("Random values are added")
+    {
+        THEN("The result matches a floating point least squares fit over the stored samples, rounded to nearest")
+        {
+            std::mt19937 gen(1234);
+            std::uniform_int_distribution<int32_t> noise(-100000, 100000);
+
+            for (uint16_t period : {2, 5, 32, 33, 60, 100, 600}) {
+                CAPTURE(period);
+                SlopeEstimator s(period);
+                std::deque<double> window;
+                for (int32_t i = 0; i < 2000; i++) {
+                    int32_t v = noise(gen) + i * 50;
+                    s.add(v);
+                    if (i % s.decimation() == 0) {
+                        window.push_back(v);
+                        if (window.size() > s.window()) {
+                            window.pop_front();
+                        }
+                    }
+                    double n = window.size();
+                    double sx = 0, sy = 0, sxy = 0, sxx = 0;
+                    for (size_t j = 0; j < window.size(); j++) {
+                        sx += j;
+                        sy += window[j];
+                        sxy += j * window[j];
+                        sxx += j * j;
+                    }
+                    double expected = n < 2 ? 0 : (n * sxy - sx * sy) / (n * sxx - sx * sx) / s.decimation() * 2048;
+                    CAPTURE(i);
+                    REQUIRE(std::abs(s.slope(11) - expected) <= 0.5);
+                }
+            }
+        }
+    }
+
+    WHEN("The estimator is reconfigured")
+    {
+        SlopeEstimator s(10);
+        for (int32_t i = 0; i < 10; i++) {
+            s.add(i);
+        }
+        s.configure(50);
+        THEN("The stored samples are cleared")
+        {
+            CHECK(s.count() == 0);
+            CHECK(s.period() == 50);
+            CHECK(s.slope(0) == 0);
+        }
+    }
+}
+
+SCENARIO("Benchmark slope estimator", "[slope][.benchmark]")
+{
+    constexpr int iterations = 1000000;
+    SlopeEstimator s(600);
+    int64_t check = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < iterations; i++) {
+        s.add(i * 3);
+        check += s.slope(11);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "SlopeEstimator add + slope: " << std::chrono::duration<double, std::nano>(end - start).count() / iterations << " ns per update" << std::endl;
+    CHECK(check != 0);
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "OneWire.h"
+#include "OneWireSimulatedAddress.h"
+#include "OneWireSimulator.h"
+#include "OneWireTransactions.h"
+#include "TempSensorOneWire.h"
+#include "TempSensorOneWireBus.h"
+#include "Temperature.h"
+#include <memory>
+#include <vector>
+
+SCENARIO("Temp sensors on a simulated bus", "[onewire]")
+{
+    constexpr uint8_t numSensors = 20;
+
+    OneWireSimulator driver;
+    OneWire ow(driver);
+
+    std::vector<std::shared_ptr<OneWireSimulatedDS18B20>> devices;
+    for (uint8_t i = 0; i < numSensors; i++) {
+        devices.push_back(std::make_shared<OneWireSimulatedDS18B20>(makeAddress(0x28, i + 1)));
+        devices.back()->temperatureRaw(16 * (20 + i) + 8); // 20.5 + i
+        driver.attach(devices.back());
+    }
+
+    WHEN("Each sensor requests its own conversion")
+    {
+        std::vector<std::unique_ptr<TempSensorOneWire>> sensors;
+        for (uint8_t i = 0; i < numSensors; i++) {
+            sensors.push_back(std::make_unique<TempSensorOneWire>(ow, makeAddress(0x28, i + 1)));
+        }
+
+        // first update initializes the sensors, second update reads the first conversion
+        for (auto& s : sensors) {
+            s->update();
+        }
+        for (auto& s : sensors) {
+            s->update();
+        }
+
+        THEN("Each update costs a scratchpad read and a conversion request on the bus")
+        {
+            driver.resetStats();
+            for (auto& s : sensors) {
+                s->update();
+            }
+            CHECK(driver.stats().resets == 3 * numSensors);
+            CHECK(driver.stats().bytesWritten == 20 * numSensors);
+            CHECK(driver.stats().bytesRead == 9 * numSensors);
+
+            for (uint8_t i = 0; i < numSensors; i++) {
+                CHECK(sensors[i]->valid());
+                CHECK(sensors[i]->value() == temp_t(20.5 + i));
+            }
+        }
+    }
+
+    WHEN("The sensors share the conversions of a conversion bus")
+    {
+        OneWireTransactions transactions(ow, [&driver]() { return driver.micros(); });
+        TempSensorOneWireBus conversionBus(transactions);
+        std::vector<std::unique_ptr<TempSensorOneWire>> sensors;
+        for (uint8_t i = 0; i < numSensors; i++) {
+            sensors.push_back(std::make_unique<TempSensorOneWire>(conversionBus, makeAddress(0x28, i + 1)));
+        }
+
+        // simulates the main loop: the conversion bus is updated when it asks for it, the queue is processed every ms
+        ticks_millis_t now = 0;
+        ticks_millis_t nextUpdate = 0;
+        auto runUntil = [&](ticks_millis_t end) {
+            for (; now < end; ++now) {
+                if (now >= nextUpdate) {
+                    nextUpdate = conversionBus.update(now);
+                }
+                transactions.process(2000);
+                driver.advance(1000); // the bus runs during the rest of the pass
+            }
+        };
+
+        THEN("The conversion bus does not wait for the conversion to complete")
+        {
+            runUntil(1);
+            CHECK(devices[0]->conversions() == 1);
+            CHECK(nextUpdate == 1);
+
+            driver.resetStats();
+            runUntil(751);
+            CHECK(nextUpdate == 751);
+            CHECK(driver.stats().resets == 0);
+        }
+
+        // first sweep initializes the sensors, the second reads the first conversion
+        runUntil(2000);
+
+        THEN("The sensors read the result of the shared conversion")
+        {
+            for (uint8_t i = 0; i < numSensors; i++) {
+                sensors[i]->update();
+                CHECK(sensors[i]->valid());
+                CHECK(sensors[i]->value() == temp_t(20.5 + i));
+            }
+        }
+
+        THEN("A cycle costs a single convert command and a scratchpad read per sensor")
+        {
+            driver.resetStats();
+            uint32_t conversionsBefore = devices[0]->conversions();
+
+            runUntil(3000);
+
+            CHECK(conversionBus.conversions() == 3);
+            CHECK(devices[0]->conversions() == conversionsBefore + 1);
+            CHECK(driver.stats().resets == numSensors + 1);
+            CHECK(driver.stats().bytesWritten == 10 * numSensors + 2);
+            CHECK(driver.stats().bytesRead == 9 * numSensors);
+        }
+
+        THEN("A new temperature is available after the next conversion")
+        {
+            devices[3]->temperatureRaw(16 * 50);
+            runUntil(2751);
+            CHECK(sensors[3]->value() == temp_t(23.5));
+            runUntil(2752);
+            CHECK(sensors[3]->value() == temp_t(50));
+        }
+
+        THEN("A sensor that is removed from the bus becomes invalid after the next conversion")
+        {
+            driver.detach(makeAddress(0x28, 4));
+            runUntil(2752);
+            CHECK(sensors[3]->valid() == false);
+            CHECK(sensors[4]->valid() == true);
+        }
+
+        THEN("A sensor that is destroyed is not read anymore")
+        {
+            sensors.pop_back();
+            driver.resetStats();
+            runUntil(3000);
+            CHECK(driver.stats().resets == numSensors);
+        }
+
+        THEN("A sensor with a longer polling interval is read less often")
+        {
+            sensors[0]->polling().interval(5000);
+            auto samples0 = sensors[0]->polling().samples();
+            auto samples1 = sensors[1]->polling().samples();
+            runUntil(12000);
+            CHECK(sensors[0]->polling().samples() == samples0 + 2);
+            CHECK(sensors[1]->polling().samples() == samples1 + 10);
+            CHECK(sensors[1]->polling().sampleInterval() == 1000);
+        }
+
+        THEN("No conversion is started when no sensor is due")
+        {
+            for (auto& s : sensors) {
+                s->polling().interval(10000);
+            }
+            auto conversions = conversionBus.conversions();
+            runUntil(12000);
+            CHECK(conversionBus.conversions() == conversions + 1);
+        }
+
+        THEN("A disconnected sensor is read with backoff")
+        {
+            driver.detach(makeAddress(0x28, 4));
+            runUntil(62000);
+            CHECK_FALSE(sensors[3]->valid());
+            CHECK(sensors[3]->polling().failures() >= 4);
+            CHECK(sensors[3]->polling().failures() <= 6);
+            CHECK(sensors[3]->polling().currentInterval() > 10000);
+            CHECK(sensors[4]->polling().failures() == 0);
+        }
+
+        THEN("Scratchpads are read on the queue, the main loop never waits for the bus")
+        {
+            driver.timing(OneWireSimulator::ds2482Timing);
+            driver.resetStats();
+            runUntil(4000);
+            CHECK(driver.stats().waited == 0);
+            CHECK(transactions.stats().maxPass <= 2000 + 2 * OneWireSimulator::ds2482Timing.command);
+            for (uint8_t i = 0; i < numSensors; i++) {
+                CHECK(sensors[i]->value() == temp_t(20.5 + i));
+                CHECK(sensors[i]->polling().busTime() > 18 * OneWireSimulator::ds2482Timing.byte);
+            }
+        }
+    }
+}
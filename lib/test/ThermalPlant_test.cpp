@@ -0,0 +1,185 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "ActuatorAnalogMock.h"
+#include "Pid.h"
+#include "SetpointSensorPair.h"
+#include "TempSensorMock.h"
+#include "ThermalPlant.h"
+#include <algorithm>
+#include <cmath>
+
+SCENARIO("A thermal plant simulates the temperature of a mass driven by actuators", "[thermalplant]")
+{
+    auto sensor = std::make_shared<TempSensorMock>(20.0);
+    auto heater = std::make_shared<ActuatorAnalogMock>(0, 0, 100);
+    auto cooler = std::make_shared<ActuatorAnalogMock>(0, 0, 100);
+
+    ThermalPlant plant([&sensor]() { return sensor; }, 20);
+    plant.inputs({
+        {[&heater]() { return heater; }, 10},
+        {[&cooler]() { return cooler; }, -5},
+    });
+
+    ticks_millis_t now = 0;
+    auto run = [&plant, &now](duration_millis_t duration) {
+        auto end = now + duration;
+        for (; now < end; now += 1000) {
+            plant.update(now);
+        }
+        plant.update(now);
+    };
+
+    WHEN("No actuators are active and there is no loss, the temperature does not change")
+    {
+        run(3600000);
+        CHECK(plant.temperature() == temp_t(20));
+        CHECK(sensor->value() == temp_t(20));
+    }
+
+    WHEN("The heater is at 100% for an hour, the temperature rises by the heater gain")
+    {
+        heater->setting(100);
+        run(3600000);
+        CHECK(plant.temperature() == Approx(30).margin(0.01));
+        CHECK(sensor->value() == plant.temperature());
+    }
+
+    WHEN("The heater is at 50% for an hour, the temperature rises by half the heater gain")
+    {
+        heater->setting(50);
+        run(3600000);
+        CHECK(plant.temperature() == Approx(25).margin(0.01));
+    }
+
+    WHEN("The cooler is at 100% for an hour, the temperature drops by the cooler gain")
+    {
+        cooler->setting(100);
+        run(3600000);
+        CHECK(plant.temperature() == Approx(15).margin(0.01));
+    }
+
+    WHEN("The heater and cooler are both active, their effect is combined")
+    {
+        heater->setting(100);
+        cooler->setting(100);
+        run(3600000);
+        CHECK(plant.temperature() == Approx(25).margin(0.01));
+    }
+
+    WHEN("The plant has a dead time, the temperature only starts rising after the dead time")
+    {
+        plant.deadTime(600000);
+        CHECK(plant.deadTime() == 600000);
+
+        heater->setting(100);
+        run(599000);
+        CHECK(plant.temperature() == temp_t(20));
+
+        run(3600000);
+        CHECK(plant.temperature() == Approx(30).margin(0.01));
+    }
+
+    WHEN("The plant loses heat to ambient, it decays exponentially to the ambient temperature")
+    {
+        plant.temperature(30);
+        plant.ambient(20);
+        plant.lossRate(1);
+        run(3600000);
+        CHECK(plant.temperature() == Approx(20 + 10 * std::exp(-1.0)).margin(0.01));
+
+        run(10 * 3600000);
+        CHECK(plant.temperature() == Approx(20).margin(0.01));
+    }
+
+    WHEN("Heating and loss are in balance, the temperature is stable")
+    {
+        plant.ambient(20);
+        plant.lossRate(0.5);
+        heater->setting(25);
+        run(24 * 3600000);
+        CHECK(plant.temperature() == Approx(25).margin(0.01));
+    }
+
+    WHEN("The update interval is longer than the time step, multiple steps are done at once")
+    {
+        heater->setting(100);
+        plant.update(0);
+        auto next = plant.update(3600000);
+        CHECK(next == 3601000);
+        CHECK(plant.temperature() == Approx(30).margin(0.01));
+    }
+
+    WHEN("The plant is below zero and cooled, the negative state is handled")
+    {
+        plant.temperature(-10);
+        plant.ambient(-20);
+        plant.lossRate(1);
+        cooler->setting(100);
+        run(3600000);
+        // decays towards ambient and is cooled by 5 degrees per hour
+        CHECK(plant.temperature() < temp_t(-17));
+        CHECK(plant.temperature() > temp_t(-25));
+    }
+
+    WHEN("Several high gain inputs are summed, the heating saturates instead of overflowing")
+    {
+        auto heater2 = std::make_shared<ActuatorAnalogMock>(100, 0, 100);
+        auto heater3 = std::make_shared<ActuatorAnalogMock>(100, 0, 100);
+        heater->setting(100);
+        plant.inputs({
+            {[&heater]() { return heater; }, 500000},
+            {[&heater2]() { return heater2; }, 500000},
+            {[&heater3]() { return heater3; }, 500000},
+        });
+        run(1000);
+        // the summed heating is limited to 2^43 / fullScale raw temp_t per hour, about 5243 degrees
+        CHECK(plant.temperature() == Approx(20 + 5242.88 / 3600).margin(0.01));
+    }
+
+    WHEN("The plant is controlled by a PID, the temperature settles at the setpoint")
+    {
+        auto pair = std::make_shared<SetpointSensorPair>([&sensor]() { return sensor; });
+        pair->setting(25);
+        pair->settingValid(true);
+
+        auto pid = Pid([&pair]() { return pair; }, [&heater]() { return heater; });
+        pid.kp(10);
+        pid.ti(1800);
+        pid.td(0);
+        pid.enabled(true);
+
+        plant.ambient(20);
+        plant.lossRate(0.5);
+        plant.deadTime(60000);
+
+        temp_t maxTemp = 0;
+        for (; now < 8 * 3600000; now += 1000) {
+            plant.update(now);
+            pair->update();
+            pid.update();
+            maxTemp = std::max(maxTemp, plant.temperature());
+        }
+
+        CHECK(maxTemp < temp_t(27));
+        CHECK(plant.temperature() == Approx(25).margin(0.3));
+    }
+}
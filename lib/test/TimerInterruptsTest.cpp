@@ -0,0 +1,354 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "ActuatorDigital.h"
+#include "ActuatorDigitalConstrained.h"
+#include "ActuatorPwm.h"
+#include "MockIoArray.h"
+#include "TimerInterrupts.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void
+countTask(void* counter)
+{
+    ++*static_cast<std::atomic<uint32_t>*>(counter);
+}
+
+// context that detects being used by the timer after it was removed
+struct Guarded {
+    std::atomic<bool> alive{true};
+    std::atomic<uint32_t>* errors;
+
+    static void task(void* self)
+    {
+        auto g = static_cast<Guarded*>(self);
+        if (!g->alive.load()) {
+            ++*g->errors;
+        }
+    }
+};
+
+} // end anonymous namespace
+
+SCENARIO("Timer interrupt task table", "[timer]")
+{
+    std::atomic<uint32_t> counters[TimerInterrupts::capacity + 1] = {};
+
+    WHEN("Tasks are added, they run on each tick")
+    {
+        auto id1 = TimerInterrupts::add(countTask, &counters[0]);
+        auto id2 = TimerInterrupts::add(countTask, &counters[1]);
+        CHECK(id1 != 0);
+        CHECK(id2 != 0);
+        CHECK(id1 != id2);
+        CHECK(TimerInterrupts::count() == 2);
+
+        TimerInterrupts::tick(10);
+        CHECK(counters[0] == 10);
+        CHECK(counters[1] == 10);
+
+        THEN("A removed task does not run anymore")
+        {
+            TimerInterrupts::remove(id1);
+            CHECK(TimerInterrupts::count() == 1);
+            TimerInterrupts::tick(10);
+            CHECK(counters[0] == 10);
+            CHECK(counters[1] == 20);
+
+            AND_THEN("Its id is reused")
+            {
+                auto id3 = TimerInterrupts::add(countTask, &counters[2]);
+                CHECK(id3 == id1);
+                TimerInterrupts::remove(id3);
+            }
+        }
+
+        THEN("Removing an unknown id has no effect")
+        {
+            TimerInterrupts::remove(200);
+            CHECK(TimerInterrupts::count() == 2);
+        }
+
+        TimerInterrupts::remove(id1);
+        TimerInterrupts::remove(id2);
+        CHECK(TimerInterrupts::count() == 0);
+    }
+
+    WHEN("The table is full, add returns 0")
+    {
+        std::vector<uint8_t> ids;
+        for (uint8_t i = 0; i < TimerInterrupts::capacity; i++) {
+            ids.push_back(TimerInterrupts::add(countTask, &counters[i]));
+            CHECK(ids.back() != 0);
+        }
+        CHECK(TimerInterrupts::add(countTask, &counters[TimerInterrupts::capacity]) == 0);
+
+        TimerInterrupts::tick(1);
+        for (uint8_t i = 0; i < TimerInterrupts::capacity; i++) {
+            CHECK(counters[i] == 1);
+        }
+
+        for (auto id : ids) {
+            TimerInterrupts::remove(id);
+        }
+        CHECK(TimerInterrupts::count() == 0);
+    }
+}
+
+SCENARIO("Timer interrupt tasks run from the real time thread", "[timer]")
+{
+    TimerInterrupts::init();
+
+    WHEN("A task is added, it runs until it is removed")
+    {
+        std::atomic<uint32_t> counter{0};
+        auto id = TimerInterrupts::add(countTask, &counter);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        TimerInterrupts::remove(id);
+        auto counted = counter.load();
+        CHECK(counted > 0);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        CHECK(counter == counted);
+    }
+
+    WHEN("Tasks are added and removed while the thread runs them, a removed task is never called")
+    {
+        std::atomic<uint32_t> errors{0};
+        std::atomic<uint32_t> counter{0};
+        auto idCount = TimerInterrupts::add(countTask, &counter);
+
+        for (int i = 0; i < 2000; i++) {
+            auto g = std::make_unique<Guarded>();
+            g->errors = &errors;
+            auto id = TimerInterrupts::add(Guarded::task, g.get());
+            REQUIRE(id != 0);
+            if (i % 100 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            TimerInterrupts::remove(id);
+            g->alive.store(false);
+        }
+        TimerInterrupts::remove(idCount);
+
+        CHECK(errors == 0);
+        CHECK(counter > 0);
+        CHECK(TimerInterrupts::count() == 0);
+    }
+
+    WHEN("The main loop holds a guard, the tasks do not run until it is released")
+    {
+        std::atomic<uint32_t> counter{0};
+        auto id = TimerInterrupts::add(countTask, &counter);
+        {
+            TimerInterrupts::Guard guard;
+            auto before = counter.load();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            CHECK(counter == before);
+
+            guard.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            CHECK(counter > before);
+        }
+        TimerInterrupts::remove(id);
+    }
+
+    WHEN("The main loop holds the guard while it updates the blocks and releases it for its idle delay, the tasks keep their rate")
+    {
+        using clock = std::chrono::steady_clock;
+
+        // longest time between two runs of the task, written by the timer thread only
+        struct GapRecorder {
+            std::atomic<uint32_t> count{0};
+            std::atomic<int64_t> maxGap{0}; // us
+            clock::time_point last;
+
+            static void task(void* self)
+            {
+                auto r = static_cast<GapRecorder*>(self);
+                auto now = clock::now();
+                if (r->count.load() > 0) {
+                    auto gap = std::chrono::duration_cast<std::chrono::microseconds>(now - r->last).count();
+                    if (gap > r->maxGap.load()) {
+                        r->maxGap.store(gap);
+                    }
+                }
+                r->last = now;
+                ++r->count;
+            }
+        };
+
+        GapRecorder recorder;
+        auto id = TimerInterrupts::add(GapRecorder::task, &recorder);
+
+        // same shape as loop() on gcc: about 1 ms of work under the guard, then the 10 ms delay without it
+        auto start = clock::now();
+        for (int pass = 0; pass < 30; pass++) {
+            TimerInterrupts::Guard guard;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            guard.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        TimerInterrupts::remove(id);
+
+        // holding the guard during the delay would leave less than 10% of the ticks and gaps of 10 ms
+        CHECK(recorder.count.load() > elapsed * TimerInterrupts::frequency * 0.6);
+        CHECK(recorder.maxGap.load() < 5000);
+    }
+
+    TimerInterrupts::stop();
+}
+
+SCENARIO("Fast PWM on the timer task", "[timer][pwm]")
+{
+    using value_t = ActuatorAnalog::value_t;
+    using State = ActuatorDigitalBase::State;
+
+    auto mockIo = std::make_shared<MockIoArray>();
+    auto mock = ActuatorDigital([mockIo]() { return mockIo; }, 1);
+    auto constrained = std::make_shared<ActuatorDigitalConstrained>(mock);
+
+    WHEN("The period is shorter than a second, the PWM runs on the timer at 100 Hz")
+    {
+        ActuatorPwm pwm([constrained]() { return constrained; }, 100);
+        CHECK(pwm.period() == 10);
+        CHECK(TimerInterrupts::count() == 1);
+
+        pwm.setting(30);
+
+        THEN("Each period of 100 ticks is active for the duty setting")
+        {
+            uint32_t activeTicks = 0;
+            for (int i = 0; i < 1000; i++) {
+                TimerInterrupts::tick(1);
+                if (constrained->state() == State::Active) {
+                    ++activeTicks;
+                }
+            }
+            CHECK(activeTicks == 300);
+            CHECK(pwm.value() == value_t(30));
+        }
+
+        THEN("The regular update does not toggle the output")
+        {
+            CHECK(pwm.update(1000) == 2000);
+        }
+
+        THEN("Disabling the PWM removes the task")
+        {
+            pwm.enabled(false);
+            CHECK(TimerInterrupts::count() == 0);
+            CHECK(pwm.value() == value_t(0));
+        }
+    }
+
+    WHEN("The target block is deleted, the timer does not keep it alive")
+    {
+        auto target = std::make_shared<ActuatorDigitalConstrained>(mock);
+        std::weak_ptr<ActuatorDigitalConstrained> lookup = target;
+        ActuatorPwm pwm([&lookup]() { return lookup.lock(); }, 100);
+        pwm.setting(30);
+        TimerInterrupts::tick(100);
+        CHECK(TimerInterrupts::count() == 1);
+
+        target.reset();
+        CHECK(lookup.expired());
+        TimerInterrupts::tick(100);
+
+        THEN("The next update removes the task, it is added again when the target comes back")
+        {
+            pwm.update(1000);
+            CHECK(TimerInterrupts::count() == 0);
+            CHECK(pwm.value() == value_t(0));
+
+            target = std::make_shared<ActuatorDigitalConstrained>(mock);
+            lookup = target;
+            pwm.update(2000);
+            CHECK(TimerInterrupts::count() == 1);
+        }
+    }
+
+    CHECK(TimerInterrupts::count() == 0); // removed on destruction
+}
+
+SCENARIO("Benchmark timer thread jitter", "[timer][.benchmark]")
+{
+    constexpr uint32_t samples = 10 * TimerInterrupts::frequency; // 10 seconds
+    using clock = std::chrono::steady_clock;
+
+    struct Recorder {
+        std::vector<clock::time_point> times;
+        std::atomic<uint32_t> count{0};
+
+        static void task(void* self)
+        {
+            auto r = static_cast<Recorder*>(self);
+            auto idx = r->count.load();
+            if (idx < r->times.size()) {
+                r->times[idx] = clock::now();
+                r->count.store(idx + 1);
+            }
+        }
+    };
+
+    Recorder recorder;
+    recorder.times.resize(samples);
+
+    TimerInterrupts::init();
+    auto id = TimerInterrupts::add(Recorder::task, &recorder);
+    while (recorder.count.load() < samples) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TimerInterrupts::remove(id);
+    TimerInterrupts::stop();
+
+    const double nominal = 1e6 / TimerInterrupts::frequency; // us
+    double sum = 0;
+    double sumSquares = 0;
+    double maxDeviation = 0;
+    uint32_t late = 0;
+    for (uint32_t i = 1; i < samples; i++) {
+        double period = std::chrono::duration<double, std::micro>(recorder.times[i] - recorder.times[i - 1]).count();
+        double deviation = period - nominal;
+        sum += period;
+        sumSquares += deviation * deviation;
+        maxDeviation = std::max(maxDeviation, std::abs(deviation));
+        if (deviation > nominal / 2) {
+            ++late;
+        }
+    }
+    auto n = samples - 1;
+    std::cout << "Timer thread period: mean " << sum / n << " us"
+              << ", jitter (rms) " << std::sqrt(sumSquares / n) << " us"
+              << ", max deviation " << maxDeviation << " us"
+              << ", late by more than half a period " << late << " of " << n << std::endl;
+
+    CHECK(sum / n == Approx(nominal).epsilon(0.1));
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SimulationTicks.h"
+#include "TimerInterrupts.h"
+#include <cstdlib>
+
+constexpr duration_millis_t SimulationTicks::maxJump;
+
+SimulationTicks::SimulationTicks()
+{
+    if (const char* speed = std::getenv("BREWBLOX_SIMULATION_SPEED")) {
+        m_simulated = true;
+        m_speed = std::strtoul(speed, nullptr, 10);
+    }
+    if (const char* seed = std::getenv("BREWBLOX_SIMULATION_SEED")) {
+        m_seed = std::strtoul(seed, nullptr, 10);
+    }
+}
+
+void
+SimulationTicks::refill() const
+{
+    auto wallNow = m_wall.millis();
+    if (!m_paced) {
+        m_paced = true;
+        m_lastWall = wallNow;
+    }
+    // Only a little credit is saved up, so the simulation does not race to catch up after a slow pass.
+    // It should cover at least a few milliseconds of wall time, because sleeps are not more accurate than that.
+    uint64_t credit = m_credit + uint64_t(wallNow - m_lastWall) * m_speed;
+    uint64_t maxCredit = uint64_t(m_speed) * 10 + maxJump;
+    m_credit = duration_millis_t(credit < maxCredit ? credit : maxCredit);
+    m_lastWall = wallNow;
+}
+
+void
+SimulationTicks::advance(const duration_millis_t& duration) const
+{
+    m_virtual.delayMillis(duration);
+    TimerInterrupts::tick(duration * (TimerInterrupts::frequency / 1000));
+}
+
+void
+SimulationTicks::delayMillis(const duration_millis_t& duration) const
+{
+    if (!m_simulated) {
+        m_wall.delayMillis(duration);
+        return;
+    }
+    if (m_speed != 0) {
+        refill();
+        if (m_credit < duration) {
+            m_wall.delayMillis((duration - m_credit + m_speed - 1) / m_speed);
+            refill();
+        }
+        m_credit = m_credit > duration ? m_credit - duration : 0;
+    }
+    advance(duration);
+}
+
+void
+SimulationTicks::idleUntil(const ticks_millis_t& deadline)
+{
+    if (!m_simulated) {
+        return;
+    }
+    auto wait = int32_t(deadline - m_virtual.millis());
+    if (wait <= 0) {
+        return;
+    }
+    duration_millis_t jump = duration_millis_t(wait) < maxJump ? duration_millis_t(wait) : maxJump;
+    if (m_speed != 0) {
+        refill();
+        if (m_credit == 0) {
+            // running ahead of the speed limit, give the wall clock time to catch up
+            m_wall.delayMillis(1);
+            refill();
+        }
+        jump = jump < m_credit ? jump : m_credit;
+        m_credit -= jump;
+    }
+    advance(jump);
+}
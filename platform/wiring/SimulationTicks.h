@@ -0,0 +1,108 @@
+/*
+ * Copyright 2019 BrewPi B.V.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "MockTicks.h"
+#include "TicksTypes.h"
+#include "TicksWiring.h"
+#include <cstdint>
+
+/*
+ * Ticks implementation for the gcc build, which can run on a virtual clock instead of the wall clock.
+ *
+ * In simulation mode, time only moves when the application waits. A delay moves the virtual clock without sleeping
+ * and idleUntil() lets the clock jump ahead to the next scheduled update.
+ * The speed factor limits how fast the virtual clock runs compared to the wall clock, 0 runs as fast as possible.
+ * Without input from outside, a simulation at full speed gives the same result every time it runs.
+ *
+ * Simulation mode is enabled by setting the environment variable BREWBLOX_SIMULATION_SPEED to the speed factor.
+ * BREWBLOX_SIMULATION_SEED sets the seed for the random number generator.
+ * Timer interrupt tasks are run by the virtual clock too, 10 ticks for each virtual millisecond.
+ */
+class SimulationTicks {
+public:
+    // the virtual clock never jumps more than this, so the display and the connections are still handled regularly
+    static constexpr duration_millis_t maxJump = 1000;
+
+    SimulationTicks();
+
+    ticks_millis_t millis() const
+    {
+        return m_simulated ? m_virtual.millis() : m_wall.millis();
+    }
+
+    ticks_micros_t micros() const
+    {
+        return m_simulated ? ticks_micros_t(m_virtual.millis()) * 1000 : m_wall.micros();
+    }
+
+    utc_seconds_t utc() const
+    {
+        return m_simulated ? m_virtual.utc() : m_wall.utc();
+    }
+
+    void setUtc(const utc_seconds_t& t)
+    {
+        if (m_simulated) {
+            m_virtual.setUtc(t);
+        } else {
+            m_wall.setUtc(t);
+        }
+    }
+
+    void delayMillis(const duration_millis_t& duration) const;
+
+    // Move the virtual clock ahead to the deadline, or as far as the speed factor allows.
+    // Does nothing when not simulating.
+    void idleUntil(const ticks_millis_t& deadline);
+
+    bool simulated() const
+    {
+        return m_simulated;
+    }
+
+    uint32_t speed() const
+    {
+        return m_speed;
+    }
+
+    uint32_t seed() const
+    {
+        return m_seed;
+    }
+
+private:
+    // add the virtual time that has become available since the last call, based on the wall clock
+    void refill() const;
+
+    // move the virtual clock and run the timer interrupt tasks for the elapsed time
+    void advance(const duration_millis_t& duration) const;
+
+    TicksWiring m_wall;
+    MockTicks m_virtual;
+    bool m_simulated = false;
+    uint32_t m_speed = 0; // maximum virtual milliseconds per wall clock millisecond, 0 for no limit
+    uint32_t m_seed = 1;
+
+    // virtual time that can be used without sleeping, only used with a speed limit
+    mutable duration_millis_t m_credit = 0;
+    mutable ticks_millis_t m_lastWall = 0;
+    mutable bool m_paced = false;
+};